@@ -4,6 +4,17 @@
     alias(libs.plugins.compose.compiler)
 }
 
+// Obfuscation of the arithmetic hot path (see HotPathObfuscation): none, single or full
+fun hotPathObfuscation(default: String): String {
+    val level = (project.findProperty("hotPathObfuscation") as String?) ?: default
+    return when (level) {
+        "none" -> "0"
+        "single" -> "1"
+        "full" -> "2"
+        else -> throw GradleException("hotPathObfuscation must be none, single or full, not $level")
+    }
+}
+
 android {
     namespace = "com.android.calculator"
     compileSdk = 34
@@ -51,10 +62,12 @@ android {
             dimension = "obfuscation"
             isDefault = true  // Make standard the default flavor for Android Studio
             // Uses standard proguard-rules.pro
+            buildConfigField("int", "HOT_PATH_OBFUSCATION", hotPathObfuscation("single"))
         }
         create("aggressive") {
             dimension = "obfuscation"
             applicationIdSuffix = ".aggressive"
+            buildConfigField("int", "HOT_PATH_OBFUSCATION", hotPathObfuscation("full"))
             // Uses COMPREHENSIVE OBFUSCATION - maximum obfuscation with all techniques
             proguardFiles(
                 getDefaultProguardFile("proguard-android-optimize.txt"),
@@ -86,6 +99,11 @@ android {
     kotlinOptions {
         jvmTarget = "21"
     }
+
+    // android.os.Trace and the other framework stubs do nothing in JVM unit tests
+    testOptions {
+        unitTests.isReturnDefaultValues = true
+    }
 }
 
 dependencies {
@@ -240,6 +258,31 @@ fun ByteArray.encodeBase64(): String {
     return result.toString()
 }
 
+// Host-side batch evaluation of expressions with latency report, e.g.
+// ./gradlew :app:evaluateBatch --args="--threads 4 --repeat 10 src/test/resources/corpus/expressions.txt"
+tasks.register<JavaExec>("evaluateBatch") {
+    group = "verification"
+    description = "Evaluate expressions from a file or stdin on the host and report throughput and latency"
+
+    dependsOn("compileStandardDebugUnitTestKotlin")
+    classpath = files({ tasks.named<Test>("testStandardDebugUnitTest").get().classpath })
+    mainClass.set("com.android.calculator.tools.BatchEvaluatorKt")
+    workingDir = projectDir
+    standardInput = System.`in`
+}
+
+// Host-side cost of each obfuscation construct of the arithmetic hot path
+// ./gradlew :app:benchmarkObfuscation
+tasks.register<JavaExec>("benchmarkObfuscation") {
+    group = "verification"
+    description = "Measure the overhead of each obfuscation wrapper used on the arithmetic hot path"
+
+    dependsOn("compileStandardDebugUnitTestKotlin")
+    classpath = files({ tasks.named<Test>("testStandardDebugUnitTest").get().classpath })
+    mainClass.set("com.android.calculator.tools.ObfuscationBenchmark")
+    workingDir = projectDir
+}
+
 // Wire tasks into build flow
 tasks.named("preBuild") {
     dependsOn("extractCertFingerprint", "encryptAssets")
@@ -1,20 +1,55 @@
 package com.android.calculator
 
 import android.app.Application
+import android.content.Context
 import android.util.Log
 import androidx.appcompat.app.AppCompatDelegate.*
+import com.android.calculator.calculator.PhaseTimer
 import com.android.calculator.obfuscation.ObfuscationManager
 import com.android.calculator.obfuscation.static.ResourceObfuscator
 import com.android.calculator.obfuscation.demo.EncryptedClassLoader
+import com.android.calculator.startup.StartupScheduler
+import com.example.raspsdk.NativeLoader
+import com.example.raspsdk.RASP
 import java.io.IOException
 
 class AndroidCalculatorApp : Application() {
 
+    companion object {
+        // Startup tasks other tasks depend on
+        const val TASK_OBFUSCATION = "obfuscation"
+        const val TASK_RASP = "rasp"
+    }
+
+    override fun attachBaseContext(base: Context) {
+        super.attachBaseContext(base)
+        // Load the RASP native library while the application and its first activity are created
+        if (!BuildConfig.DEBUG) NativeLoader.preload()
+    }
+
     override fun onCreate() {
         super.onCreate()
+        StartupScheduler.start()
+
+        // if the theme is overriding the system, the first creation doesn't work properly
+        val forceDayNight = MyPreferences(this).forceDayNight
+        if (forceDayNight != MODE_NIGHT_UNSPECIFIED && forceDayNight != MODE_NIGHT_FOLLOW_SYSTEM)
+            setDefaultNightMode(forceDayNight)
+
+        if (BuildConfig.DEBUG) {
+            Log.d("Obfuscation", "Debug build detected - Skipping obfuscation initialization")
+            return
+        }
+
+        // Security and obfuscation work runs off the critical path, once the first frame is drawn
+        StartupScheduler.register(TASK_RASP, StartupScheduler.Phase.AFTER_FIRST_FRAME) {
+            // Waits for the native library if its preload is not done yet
+            RASP.init(this, enableContinuousMonitoring = true)
+            RASP.registerStatsProvider("calculator.phases") { PhaseTimer.snapshot() }
+        }
 
         // Initialize comprehensive obfuscation framework
-        if (!BuildConfig.DEBUG) {
+        StartupScheduler.register(TASK_OBFUSCATION, StartupScheduler.Phase.AFTER_FIRST_FRAME) {
             try {
                 Log.d("Obfuscation", "Initializing obfuscation framework...")
                 ObfuscationManager.initialize(this)
@@ -22,12 +57,10 @@ class AndroidCalculatorApp : Application() {
             } catch (e: Exception) {
                 Log.e("Obfuscation", "Failed to initialize obfuscation framework", e)
             }
-        } else {
-            Log.d("Obfuscation", "Debug build detected - Skipping obfuscation initialization")
         }
 
         // Demonstrate asset decryption at runtime
-        if (!BuildConfig.DEBUG) {
+        StartupScheduler.register("asset-decryption", StartupScheduler.Phase.IDLE, listOf(TASK_OBFUSCATION)) {
             try {
                 Log.d("AssetEncryption", "Demonstrating asset decryption...")
                 demonstrateAssetDecryption()
@@ -38,7 +71,7 @@ class AndroidCalculatorApp : Application() {
         }
 
         // Demonstrate runtime class decryption and loading
-        if (!BuildConfig.DEBUG) {
+        StartupScheduler.register("class-loading", StartupScheduler.Phase.IDLE, listOf(TASK_OBFUSCATION)) {
             try {
                 Log.d("RuntimeClassLoading", "Demonstrating runtime class loading...")
                 EncryptedClassLoader.demonstrateClassLoading(this)
@@ -49,7 +82,7 @@ class AndroidCalculatorApp : Application() {
         }
 
         // Demonstrate dynamic code generation for anti-tampering
-        if (!BuildConfig.DEBUG) {
+        StartupScheduler.register("dynamic-code-generation", StartupScheduler.Phase.IDLE, listOf(TASK_OBFUSCATION)) {
             try {
                 Log.d("DynamicCodeGeneration", "Demonstrating dynamic code generation...")
                 demonstrateDynamicCodeGeneration()
@@ -58,11 +91,6 @@ class AndroidCalculatorApp : Application() {
                 Log.e("DynamicCodeGeneration", "Dynamic code generation demonstration failed", e)
             }
         }
-
-        // if the theme is overriding the system, the first creation doesn't work properly
-        val forceDayNight = MyPreferences(this).forceDayNight
-        if (forceDayNight != MODE_NIGHT_UNSPECIFIED && forceDayNight != MODE_NIGHT_FOLLOW_SYSTEM)
-            setDefaultNightMode(forceDayNight)
     }
 
     /**
@@ -4,6 +4,7 @@ import android.content.Context
 import androidx.appcompat.app.AppCompatDelegate.*
 import androidx.preference.PreferenceManager
 import com.android.calculator.history.History
+import com.android.calculator.history.HistoryStore
 import com.google.gson.Gson
 
 class MyPreferences(context: Context) {
@@ -30,10 +31,15 @@ class MyPreferences(context: Context) {
         private const val KEY_AUTO_SAVE_CALCULATION_WITHOUT_EQUAL_BUTTON = "android_calculator.AUTO_SAVE_CALCULATION_WITHOUT_EQUAL_BUTTON"
         private const val KEY_NUMBERING_SYSTEM = "android_calculator.NUMBERING_SYSTEM"
         private const val KEY_SHOW_ON_LOCK_SCREEN = "android_calculator.KEY_SHOW_ON_LOCK_SCREEN"
+        private const val KEY_HISTORY_FORMAT = "android_calculator.HISTORY_FORMAT"
     }
 
     private val preferences = PreferenceManager.getDefaultSharedPreferences(context)
 
+    private val historyStore: HistoryStore by lazy {
+        HistoryStore.getInstance(context).also { migrateJsonHistory(it) }
+    }
+
     var theme = preferences.getInt(THEME, -1)
         set(value) = preferences.edit().putInt(THEME, value).apply()
     var forceDayNight = preferences.getInt(FORCE_DAY_NIGHT, MODE_NIGHT_UNSPECIFIED)
@@ -45,11 +51,9 @@ class MyPreferences(context: Context) {
         set(value) = preferences.edit().putInt(KEY_SCIENTIFIC_MODE_ENABLED_BY_DEFAULT, value).apply()
     var useRadiansByDefault = preferences.getBoolean(KEY_RADIANS_INSTEAD_OF_DEGREES_BY_DEFAULT, false)
         set(value) = preferences.edit().putBoolean(KEY_RADIANS_INSTEAD_OF_DEGREES_BY_DEFAULT, value).apply()
-    private var history = preferences.getString(KEY_HISTORY, null)
-        set(value) = preferences.edit().putString(KEY_HISTORY, value).apply()
     var preventPhoneFromSleeping = preferences.getBoolean(KEY_PREVENT_PHONE_FROM_SLEEPING, false)
         set(value) = preferences.edit().putBoolean(KEY_PREVENT_PHONE_FROM_SLEEPING, value).apply()
-    var historySize = preferences.getString(KEY_HISTORY_SIZE, "50")
+    var historySize = preferences.getString(KEY_HISTORY_SIZE, "-1")
         set(value) = preferences.edit().putString(KEY_HISTORY_SIZE, value).apply()
     var numberPrecision = preferences.getString(KEY_NUMBER_PRECISION, "10")
         set(value) = preferences.edit().putString(KEY_NUMBER_PRECISION, value).apply()
@@ -73,46 +77,70 @@ class MyPreferences(context: Context) {
     var showOnLockScreen = preferences.getBoolean(KEY_SHOW_ON_LOCK_SCREEN, true)
         set(value) = preferences.edit().putBoolean(KEY_SHOW_ON_LOCK_SCREEN, value).apply()
 
+    // Settings the stored history results were formatted with
+    var historyFormat = preferences.getString(KEY_HISTORY_FORMAT, null)
+        set(value) = preferences.edit().putString(KEY_HISTORY_FORMAT, value).apply()
 
-    fun getHistory(): MutableList<History> {
-        val gson = Gson()
-
-        val historyJson = preferences.getString(KEY_HISTORY, null)
 
-        return if (historyJson != null) {
-            try {
-                val list = gson.fromJson(historyJson, Array<History>::class.java).asList().toMutableList()
-                list
-            } catch (e: Exception) {
-                mutableListOf()
-            }
-        } else {
-            mutableListOf()
-        }
+    fun getHistory(): MutableList<History> {
+        return historyStore.getAll()
     }
 
-
+    fun getHistoryStore(): HistoryStore {
+        return historyStore
+    }
 
     fun saveHistory(history: List<History>){
-        val gson = Gson()
         val history2 = history.toMutableList()
         while (historySize!!.toInt() > 0 && history2.size > historySize!!.toInt()) {
             history2.removeAt(0)
         }
-        this.history = gson.toJson(history2) // Convert to json
+        historyStore.replaceAll(history2)
+    }
+
+    fun addHistoryElement(history: History) {
+        historyStore.append(history)
+        trimHistory()
+    }
+
+    fun getLastHistoryElement(): History? {
+        return historyStore.last()
     }
 
     fun getHistoryElementById(id: String): History? {
-        val history = getHistory()
-        return history.find { it.id == id }
+        return historyStore.get(id)
     }
 
     fun updateHistoryElementById(id: String, history: History) {
-        val historyList = getHistory()
-        val index = historyList.indexOfFirst { it.id == id }
-        if (index != -1) {
-            historyList[index] = history
-            saveHistory(historyList)
+        historyStore.update(id, history)
+    }
+
+    fun removeHistoryElementAt(position: Int) {
+        historyStore.removeAt(position)
+    }
+
+    fun trimHistory() {
+        val maxSize = historySize!!.toInt()
+        if (maxSize > 0) {
+            historyStore.trimTo(maxSize)
+        }
+    }
+
+    // Former versions stored the whole history as a single JSON string
+    private fun migrateJsonHistory(historyStore: HistoryStore) {
+        synchronized(historyStore) {
+            val historyJson = preferences.getString(KEY_HISTORY, null) ?: return
+            if (historyStore.size == 0) {
+                try {
+                    val list = Gson().fromJson(historyJson, Array<History>::class.java)
+                    if (list != null) {
+                        historyStore.replaceAll(list.asList())
+                    }
+                } catch (e: Exception) {
+                    // Keep an empty history if the former one can't be read
+                }
+            }
+            preferences.edit().remove(KEY_HISTORY).apply()
         }
     }
 }
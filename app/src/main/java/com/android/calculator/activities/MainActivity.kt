@@ -29,14 +29,18 @@ import androidx.lifecycle.lifecycleScope
 import androidx.recyclerview.widget.ItemTouchHelper
 import androidx.recyclerview.widget.LinearLayoutManager
 import androidx.recyclerview.widget.RecyclerView
+import com.android.calculator.AndroidCalculatorApp
 import com.android.calculator.MyPreferences
 import com.android.calculator.R
 import com.android.calculator.TextSizeAdjuster
 import com.android.calculator.Themes
 import com.android.calculator.calculator.Calculator
+import com.android.calculator.calculator.PhaseTimer
+import com.android.calculator.calculator.Workspace
 import com.android.calculator.calculator.division_by_0
 import com.android.calculator.calculator.domain_error
 import com.android.calculator.calculator.is_infinity
+import com.android.calculator.calculator.is_rounded
 import com.android.calculator.calculator.parser.Expression
 import com.android.calculator.calculator.parser.NumberFormatter
 import com.android.calculator.calculator.parser.NumberingSystem
@@ -47,18 +51,23 @@ import com.android.calculator.BuildConfig
 import com.android.calculator.databinding.ActivityMainBinding
 import com.android.calculator.history.History
 import com.android.calculator.history.HistoryAdapter
+import com.android.calculator.history.HistoryPagedSource
+import com.android.calculator.history.HistoryRecalculator
+import com.android.calculator.startup.StartupScheduler
 import com.android.calculator.util.ScientificMode
 import com.android.calculator.util.ScientificModeTypes
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.launch
 import kotlinx.coroutines.withContext
+import java.lang.ref.WeakReference
 import java.math.BigDecimal
-import java.math.RoundingMode
 import java.text.DecimalFormatSymbols
 import java.util.Locale
 import java.util.UUID
 // Anti-Debug SDK imports
 import com.example.raspsdk.RASP
+import com.example.raspsdk.SecurityReport
+import com.example.raspsdk.SecurityReportListener
 import com.example.raspsdk.ThreatType
 // Selective Testing imports
 import com.android.calculator.util.SelectiveTestingConfig
@@ -95,79 +104,37 @@ class MainActivity : AppCompatActivity() {
     private lateinit var binding: ActivityMainBinding
     private lateinit var historyAdapter: HistoryAdapter
     private lateinit var historyLayoutMgr: LinearLayoutManager
+    private var historyRecomputation: HistoryRecalculator.Recomputation? = null
+    private var historyRecomputationTarget: HistoryRecalculator.Format? = null
 
     override fun onCreate(savedInstanceState: Bundle?) {
         super.onCreate(savedInstanceState)
 
         // ===== COMPREHENSIVE OBFUSCATION & SECURITY INITIALIZATION =====
         if (!BuildConfig.DEBUG) {
-            try {
-                // Initialize RASP SDK (skipped in debug builds)
-                RASP.init(this, enableContinuousMonitoring = true)
-
-                // Initialize obfuscation framework (already initialized in Application class)
-                Log.d("Obfuscation", "MainActivity: Obfuscation framework available")
+            // Runs once the first frame is drawn, RASP being initialized by the application then
+            val activity = WeakReference(this)
+            StartupScheduler.register(
+                "security-check",
+                StartupScheduler.Phase.AFTER_FIRST_FRAME,
+                listOf(AndroidCalculatorApp.TASK_RASP)
+            ) {
+                activity.get()?.performStartupSecurityCheck()
+            }
 
-                // Apply runtime obfuscation to critical operations
+            // Apply runtime obfuscation to critical operations
+            val context = applicationContext
+            StartupScheduler.register(
+                "resource-obfuscation",
+                StartupScheduler.Phase.AFTER_FIRST_FRAME,
+                listOf(AndroidCalculatorApp.TASK_OBFUSCATION)
+            ) {
                 ObfuscationManager.StaticObfuscation.executeWithObfuscation {
                     Log.d("Obfuscation", "MainActivity: Runtime obfuscation active")
 
                     // Initialize resource obfuscation
-                    ObfuscationManager.ResourceObfuscation.initializeResourceObfuscation(this@MainActivity)
-                }
-
-                // Get current testing configuration
-                val testingConfig = TestingHelper.getCurrentConfig()
-                TestingHelper.logCurrentConfig()
-
-                // Perform selective security checks based on testing configuration
-                val securityReport = performSelectiveSecurityCheck(testingConfig)
-
-                // Log detailed security report
-                Log.d("RASP", "=== SELECTIVE SECURITY REPORT ===")
-                Log.d("RASP", "Testing Scenario: ${testingConfig.scenarioName}")
-                Log.d("RASP", "Debugger: ${securityReport.debuggerDetected} (${if (testingConfig.enableDebugger) "ENABLED" else "DISABLED"})")
-                Log.d("RASP", "Emulator: ${securityReport.emulatorDetected} (${if (testingConfig.enableEmulator) "ENABLED" else "DISABLED"})")
-                Log.d("RASP", "Root: ${securityReport.rootDetected} (${if (testingConfig.enableRoot) "ENABLED" else "DISABLED"})")
-                Log.d("RASP", "Tampered: ${securityReport.tamperingDetected} (${if (testingConfig.enableTampering) "ENABLED" else "DISABLED"})")
-                Log.d("RASP", "=================================")
-
-                // Check for threats only in enabled features
-                val hasEnabledThreats = checkEnabledThreats(securityReport, testingConfig)
-
-                if (hasEnabledThreats) {
-                    Log.w("RASP", "THREAT DETECTED in enabled features! Terminating application.")
-
-                    // Handle different threat types appropriately (only enabled ones)
-                    when {
-                        testingConfig.enableDebugger && securityReport.debuggerDetected -> {
-                            Log.w("RASP", "DEBUGGER DETECTED - Terminating for debugger detection")
-                            RASP.handleThreat(ThreatType.DEBUGGER)
-                        }
-                        testingConfig.enableEmulator && securityReport.emulatorDetected -> {
-                            Log.w("RASP", "EMULATOR DETECTED - Terminating for emulator detection")
-                            RASP.handleThreat(ThreatType.EMULATOR)
-                        }
-                        testingConfig.enableRoot && securityReport.rootDetected -> {
-                            Log.w("RASP", "ROOT DETECTED - Terminating for root detection")
-                            RASP.handleThreat(ThreatType.ROOT)
-                        }
-                        testingConfig.enableTampering && securityReport.tamperingDetected -> {
-                            Log.w("RASP", "TAMPERING DETECTED - Terminating for tampering detection")
-                            RASP.handleThreat(ThreatType.TAMPERING)
-                        }
-                    }
-
-                    finishAffinity()
-                    return
-                } else {
-                    Log.i("RASP", "All enabled security checks passed - App continuing normally")
+                    ObfuscationManager.ResourceObfuscation.initializeResourceObfuscation(context)
                 }
-            } catch (e: Exception) {
-                Log.e("RASP", "Anti-debug initialization failed", e)
-                // Fail securely - exit if protection can't be initialized
-                finishAffinity()
-                return
             }
         } else {
             Log.i("RASP", "Debug build detected - RASP and runtime obfuscation disabled")
@@ -199,6 +166,7 @@ class MainActivity : AppCompatActivity() {
         binding = ActivityMainBinding.inflate(layoutInflater)
         view = binding.root
         setContentView(view)
+        StartupScheduler.startAfterFirstFrame(view)
 
         // Disable the keyboard on display EditText
         binding.input.showSoftInputOnFocus = false
@@ -217,6 +185,12 @@ class MainActivity : AppCompatActivity() {
             true
         }
 
+        // Long click to view popup options for the last result and the memory
+        binding.equalsButton.setOnLongClickListener {
+            showMemoryPopupMenu(binding.equalsButton)
+            true
+        }
+
         // Set default animations and disable the fade out default animation
         // https://stackoverflow.com/questions/19943466/android-animatelayoutchanges-true-what-can-i-do-if-the-fade-out-effect-is-un
         val lt = LayoutTransition()
@@ -234,7 +208,7 @@ class MainActivity : AppCompatActivity() {
         )
         binding.historyRecylcleView.layoutManager = historyLayoutMgr
         historyAdapter = HistoryAdapter(
-            mutableListOf(),
+            HistoryPagedSource(MyPreferences(this).getHistoryStore()),
             { value ->
                 updateDisplay(window.decorView, value)
             },
@@ -672,59 +646,71 @@ class MainActivity : AppCompatActivity() {
             Expression().addParenthesis(calculation)
 
             if (calculation != "") {
-                // Apply obfuscation to calculation process
-                calculationResult = ObfuscationManager.StaticObfuscation.executeWithObfuscationReturn {
-                    // Mask user input for privacy
-                    val maskedCalculation = ObfuscationManager.DataMasking.applyAppropriateMasking(
-                        calculation, "expression", "substitution"
-                    )
-                    
-                    // Use obfuscated calculator with control flow obfuscation
-                    ObfuscationManager.StaticObfuscation.obfuscatedBranch {
-                        Calculator(MyPreferences(this@MainActivity).numberPrecision!!.toInt()).evaluate(
-                            maskedCalculation,
-                            isDegreeModeActivated
+                val (formattedResult, exactResult) = PhaseTimer.measure(PhaseTimer.Phase.RESULT) {
+                    // Apply obfuscation to calculation process
+                    calculationResult = ObfuscationManager.StaticObfuscation.executeWithObfuscationReturn {
+                        // Mask user input for privacy
+                        val maskedCalculation = ObfuscationManager.DataMasking.applyAppropriateMasking(
+                            calculation, "expression", "substitution"
                         )
+                    
+                        // Use obfuscated calculator with control flow obfuscation
+                        ObfuscationManager.StaticObfuscation.obfuscatedBranch {
+                            PhaseTimer.measure(PhaseTimer.Phase.EVALUATE) {
+                                // Reads the variables, and keeps the result as ans
+                                workspace().evaluate(maskedCalculation)
+                            }
+                        }
                     }
-                }
+                    // Only a result that terminates can be rounded again at another precision
+                    val exactResult = if (is_rounded) null else calculationResult
 
-                val resultString = calculationResult.toString()
-                
-                // Apply data masking to result formatting
-                val maskedResultString = ObfuscationManager.DataMasking.applyAppropriateMasking(
-                    resultString, "result", "redaction"
-                )
-                
-                var formattedResult = ObfuscationManager.StaticObfuscation.executeWithObfuscationReturn {
-                    NumberFormatter.format(
-                        maskedResultString.replace(".", decimalSeparatorSymbol),
-                        decimalSeparatorSymbol,
-                        groupingSeparatorSymbol,
-                        numberingSystem
+                    val resultString = calculationResult.toString()
+                    
+                    // Apply data masking to result formatting
+                    val maskedResultString = ObfuscationManager.DataMasking.applyAppropriateMasking(
+                        resultString, "result", "redaction"
                     )
+                    
+                    var formatted = ObfuscationManager.StaticObfuscation.executeWithObfuscationReturn {
+                        PhaseTimer.measure(PhaseTimer.Phase.FORMAT) {
+                            NumberFormatter.format(
+                                maskedResultString.replace(".", decimalSeparatorSymbol),
+                                decimalSeparatorSymbol,
+                                groupingSeparatorSymbol,
+                                numberingSystem
+                            )
+                        }
+                    }
+
+                    // If result is a number and it is finite
+                    if (!(division_by_0 || domain_error || syntax_error || is_infinity || require_real_number)) {
+                        // Remove zeros at the end of the results (after point)
+                        val resultSplited = resultString.split('.')
+                        if (resultSplited.size > 1) {
+                            val resultPartAfterDecimalSeparator = resultSplited[1].trimEnd('0')
+                            var resultWithoutZeros = resultSplited[0]
+                            if (resultPartAfterDecimalSeparator != "") {
+                                resultWithoutZeros =
+                                    resultSplited[0] + "." + resultPartAfterDecimalSeparator
+                            }
+                            formatted = PhaseTimer.measure(PhaseTimer.Phase.FORMAT) {
+                                NumberFormatter.format(
+                                    resultWithoutZeros.replace(
+                                        ".",
+                                        decimalSeparatorSymbol
+                                    ), decimalSeparatorSymbol, groupingSeparatorSymbol,
+                                    numberingSystem
+                                )
+                            }
+                        }
+                    }
+                    formatted to exactResult
                 }
 
                 // If result is a number and it is finite
                 if (!(division_by_0 || domain_error || syntax_error || is_infinity || require_real_number)) {
 
-                    // Remove zeros at the end of the results (after point)
-                    val resultSplited = resultString.split('.')
-                    if (resultSplited.size > 1) {
-                        val resultPartAfterDecimalSeparator = resultSplited[1].trimEnd('0')
-                        var resultWithoutZeros = resultSplited[0]
-                        if (resultPartAfterDecimalSeparator != "") {
-                            resultWithoutZeros =
-                                resultSplited[0] + "." + resultPartAfterDecimalSeparator
-                        }
-                        formattedResult = NumberFormatter.format(
-                            resultWithoutZeros.replace(
-                                ".",
-                                decimalSeparatorSymbol
-                            ), decimalSeparatorSymbol, groupingSeparatorSymbol,
-                            numberingSystem
-                        )
-                    }
-
                     // Hide the cursor before updating binding.input to avoid weird cursor movement
                     withContext(Dispatchers.Main) {
                         binding.input.isCursorVisible = false
@@ -746,44 +732,37 @@ class MainActivity : AppCompatActivity() {
                     }
 
                     if (calculation != formattedResult) {
-                        val history = MyPreferences(this@MainActivity).getHistory()
+                        val lastHistoryElement = MyPreferences(this@MainActivity).getLastHistoryElement()
 
                         isStillTheSameCalculation_autoSaveCalculationWithoutEqualOption = false
 
                         // Do not save to history if the previous entry is the same as the current one
-                        if (history.isEmpty() || history[history.size - 1].calculation != calculation) {
+                        if (lastHistoryElement == null || lastHistoryElement.calculation != calculation) {
                             // Store time
                             val currentTime = System.currentTimeMillis().toString()
 
                             // Save to history
-                            val historyElementId = UUID.randomUUID().toString()
-                            history.add(
-                                History(
-                                    calculation = calculation,
-                                    result = formattedResult,
-                                    time = currentTime,
-                                    id = historyElementId // Generate a random id
-                                )
+                            val historyElement = History(
+                                calculation = calculation,
+                                result = formattedResult,
+                                time = currentTime,
+                                id = UUID.randomUUID().toString(), // Generate a random id
+                                exact = exactResult,
+                                format = currentHistoryFormat().encode(),
+                                isDegreeModeActivated = isDegreeModeActivated
                             )
 
-                            MyPreferences(this@MainActivity).saveHistory(history)
+                            MyPreferences(this@MainActivity).addHistoryElement(historyElement)
 
-                            lastHistoryElementId = historyElementId
+                            lastHistoryElementId = historyElement.id
 
                             // Update history variables in the UI
                             withContext(Dispatchers.Main) {
-                                historyAdapter.appendOneHistoryElement(
-                                    History(
-                                        calculation = calculation,
-                                        result = formattedResult,
-                                        time = currentTime,
-                                        id = UUID.randomUUID().toString() // Generate a random id
-                                    )
-                                )
+                                historyAdapter.appendOneHistoryElement(historyElement)
 
                                 // Remove former results if > historySize preference
                                 val historySize = MyPreferences(this@MainActivity).historySize!!.toInt()
-                                while (historySize != -1 && historyAdapter.itemCount >= historySize && historyAdapter.itemCount > 0) {
+                                while (historySize > 0 && historyAdapter.itemCount > historySize) {
                                     historyAdapter.removeFirstHistoryElement()
                                 }
                                 checkEmptyHistoryForNoHistoryLabel()
@@ -929,7 +908,7 @@ class MainActivity : AppCompatActivity() {
                     newValue, "input", "substitution"
                 )
                 
-                NumberFormatter.format(maskedNewValue, decimalSeparatorSymbol, groupingSeparatorSymbol, numberingSystem)
+                PhaseTimer.measure(PhaseTimer.Phase.FORMAT) { NumberFormatter.format(maskedNewValue, decimalSeparatorSymbol, groupingSeparatorSymbol, numberingSystem) }
             }
             var cursorOffset = newValueFormatted.length - newValue.length - rightSideCommas
             if (cursorOffset < 0) cursorOffset = 0
@@ -954,7 +933,7 @@ class MainActivity : AppCompatActivity() {
                 expression, "input", "substitution"
             )
             
-            NumberFormatter.format(maskedExpression, decimalSeparatorSymbol, groupingSeparatorSymbol, numberingSystem)
+            PhaseTimer.measure(PhaseTimer.Phase.FORMAT) { NumberFormatter.format(maskedExpression, decimalSeparatorSymbol, groupingSeparatorSymbol, numberingSystem) }
         }
         
         val cursorPosition = binding.input.selectionStart
@@ -978,6 +957,8 @@ class MainActivity : AppCompatActivity() {
         val fromPrefs = MyPreferences(this).numberingSystem
         numberingSystem = fromPrefs.toNumberingSystem()
 
+        recomputeHistoryIfFormatChanged()
+
         // Update the theme
         val themes = Themes(this)
         if (currentTheme != themes.getTheme()) {
@@ -1018,17 +999,13 @@ class MainActivity : AppCompatActivity() {
         view.keepScreenOn = MyPreferences(this).preventPhoneFromSleeping
 
         // Remove former results if > historySize preference
-        // Remove from the RecycleView
+        // Removed from the history store off the UI thread, then from the RecycleView
         val historySize = MyPreferences(this@MainActivity).historySize!!.toInt()
-        while (historySize != -1 && historyAdapter.itemCount >= historySize && historyAdapter.itemCount > 0) {
-            historyAdapter.removeFirstHistoryElement()
-        }
-        // Remove from the preference store data
-        val history = MyPreferences(this@MainActivity).getHistory()
-        while (historySize > 0 && history.size > historySize) {
-            history.removeAt(0)
+        if (historySize > 0) {
+            historyAdapter.trimHistory(historySize) {
+                runOnUiThread { historyAdapter.clearHistory() }
+            }
         }
-        MyPreferences(this@MainActivity).saveHistory(history)
 
         // Disable history if setting enabled
         if (historySize == 0) {
@@ -1060,15 +1037,98 @@ class MainActivity : AppCompatActivity() {
     }
 
     // ===== SELECTIVE TESTING HELPER METHODS =====
-    
+
     /**
-     * Perform selective security checks based on testing configuration
+     * Perform the selective security checks of the startup, off the main thread: the preliminary
+     * verdict at once, then the full report when it arrives. Terminate the application on a
+     * threat in enabled features.
      */
-    private fun performSelectiveSecurityCheck(config: SelectiveTestingConfig.TestingConfig): com.example.raspsdk.SecurityReport {
-        val fullReport = RASP.performSecurityCheck()
-        
-        // Return modified report based on testing configuration
-        return com.example.raspsdk.SecurityReport(
+    private fun performStartupSecurityCheck() {
+        try {
+            // Get current testing configuration
+            val testingConfig = TestingHelper.getCurrentConfig()
+            TestingHelper.logCurrentConfig()
+
+            val verdict = RASP.performStartupCheck(object : SecurityReportListener {
+                override fun onSecurityReport(report: SecurityReport) {
+                    handleSecurityReport(selectiveReport(report, testingConfig), testingConfig, "SELECTIVE SECURITY REPORT")
+                }
+
+                override fun onSecurityCheckFailed(error: Exception) {
+                    // Fail securely - exit if the checks can't be completed
+                    runOnUiThread { finishAffinity() }
+                }
+            })
+            Log.d("RASP", "Startup verdict in ${verdict.elapsedNanos / 1000} µs (complete: ${verdict.isComplete})")
+
+            // Only what the cheap checks found, the full report completes it
+            val preliminaryReport = SecurityReport(
+                debuggerDetected = verdict.debuggerDetected,
+                rootDetected = verdict.rootDetected == true,
+                emulatorDetected = false,
+                tamperingDetected = false,
+                hooksDetected = verdict.hooksDetected,
+                suspiciousBehavior = false,
+                timestamp = System.currentTimeMillis()
+            )
+            handleSecurityReport(selectiveReport(preliminaryReport, testingConfig), testingConfig, "PRELIMINARY SECURITY VERDICT")
+        } catch (e: Exception) {
+            Log.e("RASP", "Anti-debug initialization failed", e)
+            // Fail securely - exit if protection can't be initialized
+            runOnUiThread { finishAffinity() }
+        }
+    }
+
+    /**
+     * Log a security report, and terminate the application on a threat in enabled features
+     */
+    private fun handleSecurityReport(securityReport: SecurityReport, testingConfig: SelectiveTestingConfig.TestingConfig, title: String) {
+        // Log detailed security report
+        Log.d("RASP", "=== $title ===")
+        Log.d("RASP", "Testing Scenario: ${testingConfig.scenarioName}")
+        Log.d("RASP", "Debugger: ${securityReport.debuggerDetected} (${if (testingConfig.enableDebugger) "ENABLED" else "DISABLED"})")
+        Log.d("RASP", "Emulator: ${securityReport.emulatorDetected} (${if (testingConfig.enableEmulator) "ENABLED" else "DISABLED"})")
+        Log.d("RASP", "Root: ${securityReport.rootDetected} (${if (testingConfig.enableRoot) "ENABLED" else "DISABLED"})")
+        Log.d("RASP", "Tampered: ${securityReport.tamperingDetected} (${if (testingConfig.enableTampering) "ENABLED" else "DISABLED"})")
+        Log.d("RASP", "=================================")
+
+        // Check for threats only in enabled features
+        if (!checkEnabledThreats(securityReport, testingConfig)) {
+            Log.i("RASP", "All enabled security checks passed - App continuing normally")
+            return
+        }
+        Log.w("RASP", "THREAT DETECTED in enabled features! Terminating application.")
+
+        runOnUiThread {
+            // Handle different threat types appropriately (only enabled ones)
+            when {
+                testingConfig.enableDebugger && securityReport.debuggerDetected -> {
+                    Log.w("RASP", "DEBUGGER DETECTED - Terminating for debugger detection")
+                    RASP.handleThreat(ThreatType.DEBUGGER)
+                }
+                testingConfig.enableEmulator && securityReport.emulatorDetected -> {
+                    Log.w("RASP", "EMULATOR DETECTED - Terminating for emulator detection")
+                    RASP.handleThreat(ThreatType.EMULATOR)
+                }
+                testingConfig.enableRoot && securityReport.rootDetected -> {
+                    Log.w("RASP", "ROOT DETECTED - Terminating for root detection")
+                    RASP.handleThreat(ThreatType.ROOT)
+                }
+                testingConfig.enableTampering && securityReport.tamperingDetected -> {
+                    Log.w("RASP", "TAMPERING DETECTED - Terminating for tampering detection")
+                    RASP.handleThreat(ThreatType.TAMPERING)
+                }
+            }
+
+            finishAffinity()
+        }
+    }
+
+    /**
+     * Keep only the results of the features enabled in the testing configuration
+     */
+    private fun selectiveReport(fullReport: SecurityReport, config: SelectiveTestingConfig.TestingConfig): SecurityReport {
+        return SecurityReport(
             debuggerDetected = if (config.enableDebugger) fullReport.debuggerDetected else false,
             rootDetected = if (config.enableRoot) fullReport.rootDetected else false,
             emulatorDetected = if (config.enableEmulator) fullReport.emulatorDetected else false,
@@ -1078,7 +1138,7 @@ class MainActivity : AppCompatActivity() {
             timestamp = fullReport.timestamp
         )
     }
-    
+
     /**
      * Check if any enabled features detected threats
      */
@@ -1189,6 +1249,44 @@ class MainActivity : AppCompatActivity() {
         popupMenu.show()
     }
 
+    // ans and m are variables of the workspace, so a calculation reading them follows their changes
+    private fun showMemoryPopupMenu(equalsButton: View) {
+        val popupMenu = PopupMenu(this, equalsButton)
+        popupMenu.menuInflater.inflate(R.menu.popup_menu_memory, popupMenu.menu)
+        popupMenu.setOnMenuItemClickListener { menuItem: MenuItem ->
+            when (menuItem.itemId) {
+                R.id.option_ans -> {
+                    updateDisplay(view, Workspace.ANS)
+                    true
+                }
+                R.id.option_memory_add -> {
+                    displayedValue()?.let { workspace().memoryAdd(it) }
+                    true
+                }
+                R.id.option_memory_subtract -> {
+                    displayedValue()?.let { workspace().memorySubtract(it) }
+                    true
+                }
+                R.id.option_memory_recall -> {
+                    updateDisplay(view, Workspace.MEMORY)
+                    true
+                }
+                R.id.option_memory_clear -> {
+                    workspace().memoryClear()
+                    true
+                }
+                else -> false
+            }
+        }
+        popupMenu.show()
+    }
+
+    // The result shown, or the calculation once it has been replaced by its result; null if it is not a number
+    private fun displayedValue(): BigDecimal? {
+        val text = binding.resultDisplay.text.toString().ifEmpty { binding.input.text.toString() }
+        return Expression().getCleanExpression(text, decimalSeparatorSymbol, groupingSeparatorSymbol).toBigDecimalOrNull()
+    }
+
     private fun setSwipeTouchHelperForRecyclerView() {
         val callBack = object :
             ItemTouchHelper.SimpleCallback(0, ItemTouchHelper.LEFT or ItemTouchHelper.RIGHT) {
@@ -1207,7 +1305,6 @@ class MainActivity : AppCompatActivity() {
                 val position = viewHolder.bindingAdapterPosition
                 historyAdapter.removeHistoryElement(position)
                 checkEmptyHistoryForNoHistoryLabel()
-                deleteElementFromHistory(position)
             }
         }
 
@@ -1215,14 +1312,6 @@ class MainActivity : AppCompatActivity() {
         itemTouchHelper.attachToRecyclerView(binding.historyRecylcleView)
     }
 
-    private fun deleteElementFromHistory(position: Int) {
-        lifecycleScope.launch(Dispatchers.Default) {
-            val history = MyPreferences(this@MainActivity).getHistory()
-            history.removeAt(position)
-            MyPreferences(this@MainActivity).saveHistory(history)
-        }
-    }
-
     fun openAppMenu(view: View) {
         val popup = PopupMenu(this, view)
         val inflater = popup.menuInflater
@@ -1330,7 +1419,7 @@ class MainActivity : AppCompatActivity() {
                     leftValue, "input", "substitution"
                 )
                 
-                NumberFormatter.format(maskedLeftValue, decimalSeparatorSymbol, groupingSeparatorSymbol, numberingSystem)
+                PhaseTimer.measure(PhaseTimer.Phase.FORMAT) { NumberFormatter.format(maskedLeftValue, decimalSeparatorSymbol, groupingSeparatorSymbol, numberingSystem) }
             }
             val rightValue = formerValue.subSequence(cursorPosition, formerValue.length).toString()
 
@@ -1342,7 +1431,7 @@ class MainActivity : AppCompatActivity() {
                     newValue, "input", "substitution"
                 )
                 
-                NumberFormatter.format(maskedNewValue, decimalSeparatorSymbol, groupingSeparatorSymbol, numberingSystem)
+                PhaseTimer.measure(PhaseTimer.Phase.FORMAT) { NumberFormatter.format(maskedNewValue, decimalSeparatorSymbol, groupingSeparatorSymbol, numberingSystem) }
             }
 
             withContext(Dispatchers.Main) {
@@ -1363,28 +1452,66 @@ class MainActivity : AppCompatActivity() {
         }
     }
 
-    private fun roundResult(result: BigDecimal): BigDecimal {
-        val numberPrecision = MyPreferences(this).numberPrecision!!.toInt()
-        var newResult = result.setScale(numberPrecision, RoundingMode.HALF_EVEN)
-        if (MyPreferences(this).writeNumberIntoScientificNotation && (newResult >= BigDecimal(9999) || newResult <= BigDecimal(
-                0.1
-            ))
-        ) {
-            val scientificString = String.format(Locale.US, "%.4g", result)
-            newResult = BigDecimal(scientificString)
+    // Format of the results as they are displayed now
+    private fun currentHistoryFormat(): HistoryRecalculator.Format {
+        val preferences = MyPreferences(this)
+        return HistoryRecalculator.Format(
+            preferences.numberPrecision!!.toInt(),
+            preferences.writeNumberIntoScientificNotation,
+            numberingSystem,
+            decimalSeparatorSymbol,
+            groupingSeparatorSymbol
+        )
+    }
+
+    // Stored results follow the precision, numbering system and separators they were computed with
+    private fun recomputeHistoryIfFormatChanged() {
+        val preferences = MyPreferences(this)
+        val format = currentHistoryFormat()
+        val previousFormat = HistoryRecalculator.Format.decode(preferences.historyFormat)
+        if (previousFormat == null) {
+            preferences.historyFormat = format.encode()
+            return
         }
+        // A recomputation still running has to be brought back to this format too
+        if (previousFormat == format && historyRecomputation?.isDone != false) return
+
+        historyRecomputation?.cancel()
+        historyRecomputationTarget = format
+        val firstVisible = historyLayoutMgr.findFirstVisibleItemPosition()
+        val lastVisible = historyLayoutMgr.findLastVisibleItemPosition()
+        val visible = if (firstVisible == RecyclerView.NO_POSITION) IntRange.EMPTY else firstVisible..lastVisible
+        // The elements that do not record their format are still in the previous one until the
+        // recomputation is finished, which is only when the new format can be saved
+        historyRecomputation = HistoryRecalculator(preferences.getHistoryStore()).recompute(
+            previousFormat,
+            format,
+            visible,
+            onWritten = { positions ->
+                runOnUiThread { historyAdapter.updateHistoryRange(positions) }
+            },
+            onFinished = {
+                runOnUiThread {
+                    // Unless cancelled after its last chunk was already written back
+                    if (historyRecomputationTarget == format) preferences.historyFormat = format.encode()
+                }
+            }
+        )
+    }
 
-        // Fix how is displayed 0 with BigDecimal
-        val tempResult = newResult.toString().replace("E-", "").replace("E", "")
-        val allCharsEqualToZero = tempResult.all { it == '0' }
-        if (
-            allCharsEqualToZero
-            || newResult.toString().startsWith("0E")
-        ) {
-            return BigDecimal.ZERO
+    // Variables, ans and memory, evaluated with the current settings
+    private fun workspace(): Workspace {
+        return Workspace.getInstance().also {
+            it.updateSettings(MyPreferences(this).numberPrecision!!.toInt(), isDegreeModeActivated)
         }
+    }
 
-        return newResult
+    private fun roundResult(result: BigDecimal): BigDecimal {
+        return Calculator.roundResult(
+            result,
+            MyPreferences(this).numberPrecision!!.toInt(),
+            MyPreferences(this).writeNumberIntoScientificNotation
+        )
     }
 
     private fun enableOrDisableScientistMode() {
@@ -1431,84 +1558,100 @@ class MainActivity : AppCompatActivity() {
             val calculation = binding.input.text.toString()
 
             if (calculation != "") {
-                division_by_0 = false
-                domain_error = false
-                syntax_error = false
-                is_infinity = false
-                require_real_number = false
-
-                // Apply obfuscation to calculation process
-                calculationResult = ObfuscationManager.StaticObfuscation.executeWithObfuscationReturn {
-                    // Mask user input for privacy
-                    val maskedCalculation = ObfuscationManager.DataMasking.applyAppropriateMasking(
-                        calculation, "expression", "substitution"
-                    )
-                    
-                    // Use obfuscated expression parsing
-                    val calculationTmp = ObfuscationManager.StaticObfuscation.executeWithObfuscationReturn {
-                        Expression().getCleanExpression(
-                            maskedCalculation,
-                            decimalSeparatorSymbol,
-                            groupingSeparatorSymbol
-                        )
-                    }
-                    
-                    // Use obfuscated calculator with control flow obfuscation
-                    ObfuscationManager.StaticObfuscation.obfuscatedBranch {
-                        Calculator(MyPreferences(this@MainActivity).numberPrecision!!.toInt()).evaluate(
-                            calculationTmp,
-                            isDegreeModeActivated
+                val (formattedResult, exactResult) = PhaseTimer.measure(PhaseTimer.Phase.RESULT) {
+                    division_by_0 = false
+                    domain_error = false
+                    syntax_error = false
+                    is_infinity = false
+                    require_real_number = false
+
+                    // Apply obfuscation to calculation process
+                    calculationResult = ObfuscationManager.StaticObfuscation.executeWithObfuscationReturn {
+                        // Mask user input for privacy
+                        val maskedCalculation = ObfuscationManager.DataMasking.applyAppropriateMasking(
+                            calculation, "expression", "substitution"
                         )
+                        
+                        // Use obfuscated expression parsing
+                        val calculationTmp = ObfuscationManager.StaticObfuscation.executeWithObfuscationReturn {
+                            PhaseTimer.measure(PhaseTimer.Phase.CLEAN_EXPRESSION) {
+                                Expression().getCleanExpression(
+                                    maskedCalculation,
+                                    decimalSeparatorSymbol,
+                                    groupingSeparatorSymbol
+                                )
+                            }
+                        }
+                        
+                        // Use obfuscated calculator with control flow obfuscation
+                        ObfuscationManager.StaticObfuscation.obfuscatedBranch {
+                            PhaseTimer.measure(PhaseTimer.Phase.EVALUATE) {
+                                // Only a preview: ans is kept once the result is validated
+                                workspace().evaluate(calculationTmp, keepAsAns = false)
+                            }
+                        }
                     }
-                }
-
-                // If result is a number and it is finite
-                if (!(division_by_0 || domain_error || syntax_error || is_infinity || require_real_number)) {
-
-                    // Round
-                    calculationResult = roundResult(calculationResult)
-                    
-                    // Apply data masking to result formatting
-                    val resultString = calculationResult.toString()
-                    val maskedResultString = ObfuscationManager.DataMasking.applyAppropriateMasking(
-                        resultString, "result", "redaction"
-                    )
-                    
-                    var formattedResult = ObfuscationManager.StaticObfuscation.executeWithObfuscationReturn {
-                        NumberFormatter.format(
-                            maskedResultString.replace(".", decimalSeparatorSymbol),
-                            decimalSeparatorSymbol,
-                            groupingSeparatorSymbol,
-                            numberingSystem
+                    // Only a result that terminates can be rounded again at another precision
+                    val exactResult = if (is_rounded) null else calculationResult
+
+                    // If result is a number and it is finite
+                    if (!(division_by_0 || domain_error || syntax_error || is_infinity || require_real_number)) {
+                        // Round
+                        calculationResult = roundResult(calculationResult)
+                        
+                        // Apply data masking to result formatting
+                        val resultString = calculationResult.toString()
+                        val maskedResultString = ObfuscationManager.DataMasking.applyAppropriateMasking(
+                            resultString, "result", "redaction"
                         )
-                    }
-
-                    // Remove zeros at the end of the results (after point)
-                    if (!MyPreferences(this@MainActivity).writeNumberIntoScientificNotation || !(calculationResult >= BigDecimal(
-                            9999
-                        ) || calculationResult <= BigDecimal(0.1))
-                    ) {
-                        val resultSplited = calculationResult.toString().split('.')
-                        if (resultSplited.size > 1) {
-                            val resultPartAfterDecimalSeparator = resultSplited[1].trimEnd('0')
-                            var resultWithoutZeros = resultSplited[0]
-                            if (resultPartAfterDecimalSeparator != "") {
-                                resultWithoutZeros =
-                                    resultSplited[0] + "." + resultPartAfterDecimalSeparator
-                            }
-                            formattedResult = ObfuscationManager.StaticObfuscation.executeWithObfuscationReturn {
+                        
+                        var formatted = ObfuscationManager.StaticObfuscation.executeWithObfuscationReturn {
+                            PhaseTimer.measure(PhaseTimer.Phase.FORMAT) {
                                 NumberFormatter.format(
-                                    resultWithoutZeros.replace(
-                                        ".",
-                                        decimalSeparatorSymbol
-                                    ), decimalSeparatorSymbol,
+                                    maskedResultString.replace(".", decimalSeparatorSymbol),
+                                    decimalSeparatorSymbol,
                                     groupingSeparatorSymbol,
                                     numberingSystem
                                 )
                             }
                         }
+
+                        // Remove zeros at the end of the results (after point)
+                        if (!MyPreferences(this@MainActivity).writeNumberIntoScientificNotation || !(calculationResult >= BigDecimal(
+                                9999
+                            ) || calculationResult <= BigDecimal(0.1))
+                        ) {
+                            val resultSplited = calculationResult.toString().split('.')
+                            if (resultSplited.size > 1) {
+                                val resultPartAfterDecimalSeparator = resultSplited[1].trimEnd('0')
+                                var resultWithoutZeros = resultSplited[0]
+                                if (resultPartAfterDecimalSeparator != "") {
+                                    resultWithoutZeros =
+                                        resultSplited[0] + "." + resultPartAfterDecimalSeparator
+                                }
+                                formatted = ObfuscationManager.StaticObfuscation.executeWithObfuscationReturn {
+                                    PhaseTimer.measure(PhaseTimer.Phase.FORMAT) {
+                                        NumberFormatter.format(
+                                            resultWithoutZeros.replace(
+                                                ".",
+                                                decimalSeparatorSymbol
+                                            ), decimalSeparatorSymbol,
+                                            groupingSeparatorSymbol,
+                                            numberingSystem
+                                        )
+                                    }
+                                }
+                            }
+                        }
+
+                        formatted to exactResult
+                    } else {
+                        null to exactResult
                     }
+                }
 
+                // If result is a number and it is finite
+                if (formattedResult != null) {
                     withContext(Dispatchers.Main) {
                         if (formattedResult != calculation) {
                             binding.resultDisplay.text = formattedResult
@@ -1520,8 +1663,6 @@ class MainActivity : AppCompatActivity() {
                     // Save to history if the option autoSaveCalculationWithoutEqualButton is enabled
                     if (MyPreferences(this@MainActivity).autoSaveCalculationWithoutEqualButton) {
                         if (calculation != formattedResult) {
-                            val history = MyPreferences(this@MainActivity).getHistory()
-
                             if (isStillTheSameCalculation_autoSaveCalculationWithoutEqualOption) {
                                 // If it's the same calculation as the previous one
                                 // Get previous calculation and update it
@@ -1532,6 +1673,9 @@ class MainActivity : AppCompatActivity() {
                                     previousHistoryElement.calculation = calculation
                                     previousHistoryElement.result = formattedResult
                                     previousHistoryElement.time = System.currentTimeMillis().toString()
+                                    previousHistoryElement.exact = exactResult
+                                    previousHistoryElement.format = currentHistoryFormat().encode()
+                                    previousHistoryElement.isDegreeModeActivated = isDegreeModeActivated
                                     MyPreferences(this@MainActivity).updateHistoryElementById(lastHistoryElementId, previousHistoryElement)
                                     withContext(Dispatchers.Main) {
                                         historyAdapter.updateHistoryElement(previousHistoryElement)
@@ -1544,35 +1688,28 @@ class MainActivity : AppCompatActivity() {
                                 val currentTime = System.currentTimeMillis().toString()
 
                                 // Save to history
-                                val historyElementId = UUID.randomUUID().toString()
-                                history.add(
-                                    History(
-                                        calculation = calculation,
-                                        result = formattedResult,
-                                        time = currentTime,
-                                        id = historyElementId
-                                    )
+                                val historyElement = History(
+                                    calculation = calculation,
+                                    result = formattedResult,
+                                    time = currentTime,
+                                    id = UUID.randomUUID().toString(), // Generate a random id
+                                    exact = exactResult,
+                                    format = currentHistoryFormat().encode(),
+                                    isDegreeModeActivated = isDegreeModeActivated
                                 )
 
-                                lastHistoryElementId = historyElementId
+                                lastHistoryElementId = historyElement.id
                                 isStillTheSameCalculation_autoSaveCalculationWithoutEqualOption = true
 
-                                MyPreferences(this@MainActivity).saveHistory(history)
+                                MyPreferences(this@MainActivity).addHistoryElement(historyElement)
 
                                 // Update history variables in the UI
                                 withContext(Dispatchers.Main) {
-                                    historyAdapter.appendOneHistoryElement(
-                                        History(
-                                            calculation = calculation,
-                                            result = formattedResult,
-                                            time = currentTime,
-                                            id = UUID.randomUUID().toString() // Generate a random id
-                                        )
-                                    )
+                                    historyAdapter.appendOneHistoryElement(historyElement)
 
                                     // Remove former results if > historySize preference
                                     val historySize = MyPreferences(this@MainActivity).historySize!!.toInt()
-                                    while (historySize != -1 && historyAdapter.itemCount >= historySize && historyAdapter.itemCount > 0) {
+                                    while (historySize > 0 && historyAdapter.itemCount > historySize) {
                                         historyAdapter.removeFirstHistoryElement()
                                     }
                                     checkEmptyHistoryForNoHistoryLabel()
@@ -1584,15 +1721,17 @@ class MainActivity : AppCompatActivity() {
                         }
                     }
 
-                } else withContext(Dispatchers.Main) {
-                    if (is_infinity && !division_by_0 && !domain_error && !require_real_number) {
-                        if (calculationResult < BigDecimal.ZERO) binding.resultDisplay.text = "-" + getString(
-                            R.string.infinity
-                        )
-                        else binding.resultDisplay.text = getString(R.string.value_too_large)
-                    } else {
-                        withContext(Dispatchers.Main) {
-                            binding.resultDisplay.text = ""
+                } else {
+                    withContext(Dispatchers.Main) {
+                        if (is_infinity && !division_by_0 && !domain_error && !require_real_number) {
+                            if (calculationResult < BigDecimal.ZERO) binding.resultDisplay.text = "-" + getString(
+                                R.string.infinity
+                            )
+                            else binding.resultDisplay.text = getString(R.string.value_too_large)
+                        } else {
+                            withContext(Dispatchers.Main) {
+                                binding.resultDisplay.text = ""
+                            }
                         }
                     }
                 }
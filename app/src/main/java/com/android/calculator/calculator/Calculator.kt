@@ -6,6 +6,7 @@ import java.math.BigDecimal
 import java.math.BigInteger
 import java.math.MathContext
 import java.math.RoundingMode
+import java.util.Locale
 import kotlin.math.PI
 import kotlin.math.abs
 import kotlin.math.acos
@@ -18,29 +19,103 @@ import kotlin.math.log10
 import kotlin.math.log2
 import kotlin.math.pow
 import kotlin.math.round
+import kotlin.math.roundToInt
 import kotlin.math.sin
 import kotlin.math.sqrt
 import kotlin.math.tan
+import com.android.calculator.calculator.compiler.Fractions
+import com.android.calculator.calculator.compiler.MathFunction
+import com.android.calculator.calculator.compiler.MatrixFunction
+import com.android.calculator.calculator.compiler.ProgramCache
+import com.android.calculator.calculator.compiler.StatisticFunction
+import com.android.calculator.calculator.matrix.Matrix
+import com.android.calculator.calculator.matrix.MatrixCalculator
+import com.android.calculator.calculator.statistics.Statistics
+import com.android.calculator.obfuscation.HotPathObfuscation
 import com.android.calculator.obfuscation.ObfuscationManager
 
-var division_by_0 = false
-var domain_error = false
-var syntax_error = false
-var is_infinity = false
-var require_real_number = false
+var division_by_0: Boolean
+    get() = CalculatorErrors.current().divisionBy0
+    set(value) { CalculatorErrors.current().divisionBy0 = value }
+var domain_error: Boolean
+    get() = CalculatorErrors.current().domainError
+    set(value) { CalculatorErrors.current().domainError = value }
+var syntax_error: Boolean
+    get() = CalculatorErrors.current().syntaxError
+    set(value) { CalculatorErrors.current().syntaxError = value }
+var is_infinity: Boolean
+    get() = CalculatorErrors.current().isInfinity
+    set(value) { CalculatorErrors.current().isInfinity = value }
+var require_real_number: Boolean
+    get() = CalculatorErrors.current().requireRealNumber
+    set(value) { CalculatorErrors.current().requireRealNumber = value }
+var is_rounded: Boolean
+    get() = CalculatorErrors.current().isRounded
+    set(value) { CalculatorErrors.current().isRounded = value }
 
 class Calculator(
         private val numberPrecisionDecimal: Int
     ) {
 
-    // Obfuscated string constants for sensitive operations
-    private val obfuscatedErrorMessages = mapOf(
-        "division_by_zero" to ObfuscationManager.StaticObfuscation.obfuscateString("Division by zero", "error"),
-        "domain_error" to ObfuscationManager.StaticObfuscation.obfuscateString("Domain error", "error"),
-        "syntax_error" to ObfuscationManager.StaticObfuscation.obfuscateString("Syntax error", "error"),
-        "infinity" to ObfuscationManager.StaticObfuscation.obfuscateString("Infinity", "error"),
-        "real_number_required" to ObfuscationManager.StaticObfuscation.obfuscateString("Real number required", "error")
-    )
+    companion object {
+        // Lanczos approximation of the gamma function, with g = 7 and 9 coefficients
+        private const val LANCZOS_G = 7.0
+        private val LANCZOS_COEFFICIENTS = doubleArrayOf(
+            676.5203681218851, -1259.1392167224028, 771.3234287776531, -176.6150291621406,
+            12.507343278686905, -0.13857109526572012, 9.984369578019572e-6, 1.5056327351493116e-7
+        )
+
+        internal fun gamma(x: Double): Double {
+            val z = x - 1.0
+
+            var a = 0.9999999999998099
+            for (i in LANCZOS_COEFFICIENTS.indices) {
+                a += LANCZOS_COEFFICIENTS[i] / (z + i + 1)
+            }
+
+            val t = z + LANCZOS_G + 0.5
+            val sqrtTwoPi = sqrt(2.0 * PI)
+            val firstPart = sqrtTwoPi * t.pow(z + 0.5) * exp(-t)
+            return firstPart * a
+        }
+
+        fun roundResult(result: BigDecimal, numberPrecision: Int, writeNumberIntoScientificNotation: Boolean): BigDecimal {
+            var newResult = result.setScale(numberPrecision, RoundingMode.HALF_EVEN)
+            if (writeNumberIntoScientificNotation && (newResult >= BigDecimal(9999) || newResult <= BigDecimal(
+                    0.1
+                ))
+            ) {
+                val scientificString = String.format(Locale.US, "%.4g", result)
+                newResult = BigDecimal(scientificString)
+            }
+
+            // Fix how is displayed 0 with BigDecimal
+            val tempResult = newResult.toString().replace("E-", "").replace("E", "")
+            val allCharsEqualToZero = tempResult.all { it == '0' }
+            if (
+                allCharsEqualToZero
+                || newResult.toString().startsWith("0E")
+            ) {
+                return BigDecimal.ZERO
+            }
+
+            return newResult
+        }
+    }
+
+    // Determinants of the matrices written in an expression, with the same precision
+    private val matrixCalculator by lazy { MatrixCalculator(numberPrecisionDecimal) }
+
+    // Obfuscated string constants for sensitive operations, only encrypted when first needed
+    private val obfuscatedErrorMessages by lazy {
+        mapOf(
+            "division_by_zero" to ObfuscationManager.StaticObfuscation.obfuscateString("Division by zero", "error"),
+            "domain_error" to ObfuscationManager.StaticObfuscation.obfuscateString("Domain error", "error"),
+            "syntax_error" to ObfuscationManager.StaticObfuscation.obfuscateString("Syntax error", "error"),
+            "infinity" to ObfuscationManager.StaticObfuscation.obfuscateString("Infinity", "error"),
+            "real_number_required" to ObfuscationManager.StaticObfuscation.obfuscateString("Real number required", "error")
+        )
+    }
     
     // Dynamic class loading for runtime obfuscation
     private fun loadDynamicCalculationClass(): Class<*>? {
@@ -65,17 +140,17 @@ class Calculator(
 
     fun factorial(number: BigDecimal): BigDecimal {
         // Apply control flow obfuscation to hide calculation logic
-        return ObfuscationManager.StaticObfuscation.executeWithObfuscationReturn {
-            ObfuscationManager.StaticObfuscation.obfuscatedBranch {
+        return HotPathObfuscation.guarded {
+            HotPathObfuscation.branch {
                 // Obfuscated factorial calculation with control flow flattening
-                val result = ObfuscationManager.StaticObfuscation.conditionalExecution(
+                val result = HotPathObfuscation.conditional(
                     condition = number >= BigDecimal(3000),
                     trueAction = {
                         is_infinity = true
                         BigDecimal.ZERO
                     },
                     falseAction = {
-                        ObfuscationManager.StaticObfuscation.conditionalExecution(
+                        HotPathObfuscation.conditional(
                             condition = number < BigDecimal.ZERO,
                             trueAction = {
                                 domain_error = true
@@ -83,7 +158,7 @@ class Calculator(
                             },
                             falseAction = {
                                 val decimalPartOfNumber = number.toDouble() - number.toInt()
-                                ObfuscationManager.StaticObfuscation.conditionalExecution(
+                                HotPathObfuscation.conditional(
                                     condition = decimalPartOfNumber == 0.0,
                                     trueAction = {
                                         var factorial = BigInteger("1")
@@ -106,34 +181,14 @@ class Calculator(
     }
 
     private fun gammaLanczos(x: BigDecimal): BigDecimal {
-        // Apply obfuscation to hide mathematical constants and calculations
-        return ObfuscationManager.StaticObfuscation.executeWithObfuscationReturn {
-            // Obfuscated Lanczos approximation parameters
-            val obfuscatedConstants = ObfuscationManager.StaticObfuscation.obfuscateString("676.5203681218851,-1259.1392167224028,771.3234287776531,-176.6150291621406,12.507343278686905,-0.13857109526572012,9.984369578019572e-6,1.5056327351493116e-7", "gamma")
-            val p = obfuscatedConstants.split(",").map { it.toDouble() }.toTypedArray()
-            
-            // Mask sensitive mathematical values
-            val maskedG = ObfuscationManager.DataMasking.maskNumericValue(7.0, "gamma_g")
-            val g = maskedG.toDouble()
-            val z = x.toDouble() - 1.0
-
-            var a = 0.9999999999998099
-            for (i in p.indices) {
-                a += p[i] / (z + i + 1)
-            }
-
-            val t = z + g + 0.5
-            val sqrtTwoPi = sqrt(2.0 * PI)
-            val firstPart = sqrtTwoPi * t.pow(z + 0.5) * exp(-t)
-            val result = firstPart * a
-
-            BigDecimal(result, MathContext.DECIMAL64)
+        return HotPathObfuscation.guarded {
+            BigDecimal(gamma(x.toDouble()), MathContext.DECIMAL64)
         }
     }
 
-    private fun exponentiation(x: BigDecimal, parseFactor: BigDecimal): BigDecimal {
+    internal fun exponentiation(x: BigDecimal, parseFactor: BigDecimal): BigDecimal {
         // Obfuscated exponentiation calculation
-        return ObfuscationManager.StaticObfuscation.executeWithObfuscationReturn {
+        return HotPathObfuscation.guarded {
             var value = x
             val intPart = parseFactor.toInt()
             val decimalPart = parseFactor.subtract(BigDecimal(intPart))
@@ -176,10 +231,10 @@ class Calculator(
                                 )
                             )
 
-                        value = try {
+                        value = if (Fractions.isTerminating(BigDecimal.ONE, value)) {
                             BigDecimal.ONE.divide(value)
-                        } catch (e: ArithmeticException) {
-                            // if the result is a non-terminating decimal expansion
+                        } else {
+                            is_rounded = true
                             BigDecimal.ONE.divide(value, numberPrecisionDecimal, RoundingMode.HALF_DOWN)
                         }
                     }
@@ -204,269 +259,233 @@ class Calculator(
         return x1
     }
 
-    fun evaluate(equation: String, isDegreeModeActivated: Boolean): BigDecimal {
-        println("Equation BigDecimal : $equation")
-        return object : Any() {
-            var pos = -1
-            var ch = 0
-            fun nextChar() {
-                ch = if (++pos < equation.length) equation[pos].code else -1
-            }
+    fun evaluate(
+        equation: String,
+        isDegreeModeActivated: Boolean,
+        values: Map<String, BigDecimal> = emptyMap()
+    ): BigDecimal {
+        is_rounded = false
+        return ProgramCache.get(equation).execute(this, isDegreeModeActivated, values)
+    }
+
+    // Operations of a compiled expression, raising the error flags of this thread
+
+    internal fun divide(x: BigDecimal, fractionDenominator: BigDecimal): BigDecimal {
+        // The Double value is the result of sin(2π) in Radian mode after conversions (0)
+        // This catches the error/crash during zero division in issue #499
+        if (fractionDenominator.toFloat() == 0f || fractionDenominator.toDouble() == -2.4492935982947064E-16) {
+            division_by_0 = true
+            return BigDecimal.ZERO
+        }
+        // Exact when the decimal expansion is finite, rounded to the precision otherwise
+        return if (Fractions.isTerminating(x, fractionDenominator)) {
+            x.divide(fractionDenominator)
+        } else {
+            is_rounded = true
+            x.divide(fractionDenominator, numberPrecisionDecimal, RoundingMode.HALF_DOWN)
+        }
+    }
 
-            fun eat(charToEat: Int): Boolean {
-                while (ch == ' '.code) nextChar()
-                if (ch == charToEat) {
-                    nextChar()
-                    return true
+    internal fun modulo(x: BigDecimal, fractionDenominator: BigDecimal): BigDecimal {
+        if (fractionDenominator == BigDecimal.ZERO) {
+            division_by_0 = true
+            return BigDecimal.ZERO
+        }
+        return x.rem(fractionDenominator)
+    }
+
+    // x^2 without the generic exponentiation, with the same result
+    internal fun square(x: BigDecimal): BigDecimal {
+        if (x == BigDecimal.ZERO) {
+            syntax_error = false
+            return BigDecimal.ZERO
+        }
+        var value = x.multiply(x)
+        // To fix sqrt(2)^2 = 2
+        val decimal = value.toInt()
+        val fractional = value.toDouble() - decimal
+        if (fractional > 0 && fractional < 1.0E-30) {
+            value = decimal.toBigDecimal()
+        }
+        return value
+    }
+
+    // Statistics of a list literal, exact in decimals like the rest of the evaluation
+    internal fun statistic(function: Int, values: List<BigDecimal>): BigDecimal {
+        if ((function == StatisticFunction.VARIANCE || function == StatisticFunction.STANDARD_DEVIATION) && values.size < 2) {
+            domain_error = true
+            return BigDecimal.ZERO
+        }
+        return when (function) {
+            StatisticFunction.SUM -> Statistics.exactSum(values)
+            StatisticFunction.MEAN -> Statistics.exactMean(values, numberPrecisionDecimal)
+            StatisticFunction.MEDIAN -> Statistics.exactMedian(values)
+            StatisticFunction.VARIANCE -> Statistics.exactVariance(values, numberPrecisionDecimal)
+            StatisticFunction.STANDARD_DEVIATION -> Statistics.exactStandardDeviation(values, numberPrecisionDecimal)
+            else -> throw IllegalArgumentException("Unknown statistic $function")
+        }
+    }
+
+    // Function of the square matrix whose entries are [values], row by row
+    internal fun matrixFunction(function: Int, values: List<BigDecimal>): BigDecimal {
+        val size = sqrt(values.size.toDouble()).roundToInt()
+        if (size * size != values.size) {
+            syntax_error = true
+            return BigDecimal.ZERO
+        }
+        val matrix = Matrix.of(values.chunked(size))
+        return when (function) {
+            MatrixFunction.DETERMINANT -> matrixCalculator.determinant(matrix) ?: BigDecimal.ZERO
+            else -> throw IllegalArgumentException("Unknown matrix function $function")
+        }
+    }
+
+    internal fun function(function: Int, argument: BigDecimal, isDegreeModeActivated: Boolean): BigDecimal {
+        var x = argument
+        when (function) {
+            MathFunction.SQRT -> {
+                if (x >= BigDecimal.ZERO) {
+                    // Set the precision for the square root calculation
+                    val integerPartLength = x.toString().length
+                    val maxPrecision = (integerPartLength + 50).coerceAtMost(1000) // Maximum precision is 1000
+                    val precision = MathContext(maxPrecision, RoundingMode.HALF_DOWN)
+                    x = if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.TIRAMISU) { // Use default BigDecimal sqrt function (API 33)
+                        x.sqrt(precision)
+                    } else { // Use Newton's method for square root calculation with Android versions prior to API 33
+                        bigDecimalSqrtFormerAndroidVersion(x, precision)
+                    }
+                } else {
+                    require_real_number = true
                 }
-                return false
-            }
 
-            fun parse(): BigDecimal {
-                nextChar()
-                val x = parseExpression()
-                if (pos < equation.length) println("Unexpected: \"" + ch.toChar() + "\" in expression: " + equation)
-                return x
             }
-
-            fun parseExpression(): BigDecimal {
-                var x = parseTerm()
-                while (true) {
-                    if (eat('+'.code)) x = x.add(parseTerm()) // addition
-                    else if (eat('-'.code)) x = x.subtract(parseTerm()) // subtraction
-                    else return x
+            MathFunction.FACTORIAL -> {
+                x = factorial(x)
+            }
+            MathFunction.LN -> {
+                if (x > Double.MAX_VALUE.toBigDecimal()) {
+                    is_infinity = true
+                    x = BigDecimal.ZERO
+                } else if (x <= BigDecimal.ZERO) {
+                    domain_error = true
+                } else {
+                    x = BigDecimal(ln(x.toDouble()))
                 }
             }
-
-            fun parseTerm(): BigDecimal {
-                var x = parseFactor()
-                while (true) {
-                    if (eat('*'.code)) x = x.multiply(parseFactor()) // Multiplication
-                    else if (eat('#'.code)) { // Modulo
-                        val fractionDenominator = parseFactor()
-                        if (fractionDenominator == BigDecimal.ZERO) {
-                            division_by_0 = true
-                            x = BigDecimal.ZERO
-                        } else {
-                            x = x.rem(fractionDenominator)
-                        }
+            MathFunction.LOG_TWO -> {
+                if (x > Double.MAX_VALUE.toBigDecimal()) {
+                    is_infinity = true
+                    x = BigDecimal.ZERO
+                } else if (x <= BigDecimal.ZERO) {
+                    domain_error = true
+                } else {
+                    x = BigDecimal(log2(x.toDouble()))
+                }
+            }
+            MathFunction.LOG_TEN -> {
+                if (x > Double.MAX_VALUE.toBigDecimal()) {
+                    is_infinity = true
+                    x = BigDecimal.ZERO
+                } else if (x <= BigDecimal.ZERO) {
+                    domain_error = true
+                } else {
+                    x = BigDecimal(log10(x.toDouble()))
+                }
+            }
+            MathFunction.EXP -> {
+                x = exponentiation(BigDecimal(Math.E), x)
+            }
+            MathFunction.SIN -> {
+                if (x > Double.MAX_VALUE.toBigDecimal()) {
+                    is_infinity = true
+                    x = BigDecimal.ZERO
+                } else if (isDegreeModeActivated) {
+                    x = sin(Math.toRadians(x.toDouble())).toBigDecimal()
+                    // https://stackoverflow.com/questions/29516222/how-to-get-exact-value-of-trigonometric-functions-in-java
+                } else {
+                    x = sin(x.toDouble()).toBigDecimal()
+                }
+                if (x > BigDecimal.ZERO && x < BigDecimal(1.0E-14)) {
+                    x = round(x.toDouble()).toBigDecimal()
+                }
+            }
+            MathFunction.COS -> {
+                if (x > Double.MAX_VALUE.toBigDecimal()) {
+                    is_infinity = true
+                    x = BigDecimal.ZERO
+                } else if (isDegreeModeActivated) {
+                    x = cos(Math.toRadians(x.toDouble())).toBigDecimal()
+                } else {
+                    x = cos(x.toDouble()).toBigDecimal()
+                }
+                if (x > BigDecimal.ZERO && x < BigDecimal(1.0E-14)) {
+                    x = round(x.toDouble()).toBigDecimal()
+                }
+            }
+            MathFunction.TAN -> {
+                if (x > Double.MAX_VALUE.toBigDecimal()) {
+                    is_infinity = true
+                    x = BigDecimal.ZERO
+                } else if (Math.toDegrees(x.toDouble()) == 90.0) {
+                    // Tangent is defined for R\{(2k+1)π/2, with k ∈ Z}
+                    domain_error = true
+                    x = BigDecimal.ZERO
+                } else {
+                    x = if (isDegreeModeActivated) {
+                        tan(Math.toRadians(x.toDouble())).toBigDecimal()
+                    } else {
+                        tan(x.toDouble()).toBigDecimal()
                     }
-                    else if (eat('/'.code)) { // Division
-                        val fractionDenominator = parseFactor()
-                        // The Double value is the result of sin(2π) in Radian mode after conversions (0)
-                        // This catches the error/crash during zero division in issue #499
-                        if (fractionDenominator.toFloat() == 0f || fractionDenominator.toDouble() == -2.4492935982947064E-16) {
-                            division_by_0 = true
-                            x = BigDecimal.ZERO
-                        } else {
-                            try {
-                                x = x.divide(fractionDenominator)
-                            } catch (e: ArithmeticException) { // if the result is a non-terminating decimal expansion
-                                x = x.divide(fractionDenominator, numberPrecisionDecimal, RoundingMode.HALF_DOWN)
-                                println(x)
-                            }
-                        }
+                    if (x > BigDecimal.ZERO && x < BigDecimal(1.0E-14)) {
+                        x = round(x.toDouble()).toBigDecimal()
                     }
-                    else return x
                 }
             }
-
-            fun parseFactor(): BigDecimal {
-                if (eat('+'.code)) return parseFactor().plus() // unary plus
-                if (eat('-'.code)) return parseFactor().unaryMinus() // unary minus
-                var x: BigDecimal
-                val startPos = pos
-                if (eat('('.code)) { // parentheses
-                    x = parseExpression()
-                    if (!eat(')'.code)) {
-                        println("Missing ')'")
-                        x = BigDecimal.ZERO
-                        syntax_error = true
-                    }
-                } else if (ch >= '0'.code && ch <= '9'.code || ch == '.'.code) { // numbers
-                    while (ch >= '0'.code && ch <= '9'.code || ch == '.'.code) nextChar()
-                    val string = equation.substring(startPos, pos)
-                    if (string.count { it == '.' } > 1) {
-                        x = BigDecimal.ZERO
-                        syntax_error = true
+            MathFunction.ARCSIN -> {
+                if (abs(x.toDouble()) > 1) {
+                    x = BigDecimal.ZERO
+                    domain_error = true
+                } else {
+                    x = if (isDegreeModeActivated) {
+                        (asin(x.toDouble()) * 180 / Math.PI).toBigDecimal()
                     } else {
-                        if ((string.length == 1) && (string[0] == '.')) {
-                            x = BigDecimal.ZERO
-                            syntax_error = true
-                        } else {
-                            x = BigDecimal(string)
-                        }
+                        asin(x.toDouble()).toBigDecimal()
+                    }
+                    if (x > BigDecimal.ZERO && x < BigDecimal(1.0E-14)) {
+                        x = round(x.toDouble()).toBigDecimal()
                     }
-                } else if (eat('e'.code)) {
-                    x = BigDecimal(Math.E)
-                } else if (eat('π'.code)) {
-                    x = BigDecimal(PI)
-                } else if (ch >= 'a'.code && ch <= 'z'.code) { // functions
-                    while (ch >= 'a'.code && ch <= 'z'.code) nextChar()
-                    val func: String = equation.substring(startPos, pos)
-                    if (eat('('.code)) {
-                        x = parseExpression()
-                        if (!eat(')'.code)) x = parseFactor()
+                }
+            }
+            MathFunction.ARCCOS -> {
+                if (abs(x.toDouble()) > 1) {
+                    x = BigDecimal.ZERO
+                    domain_error = true
+                } else {
+                    x = if (isDegreeModeActivated) {
+                        (acos(x.toDouble())*180/Math.PI).toBigDecimal()
                     } else {
-                        x = parseFactor()
+                        acos(x.toDouble()).toBigDecimal()
                     }
-                    println(x)
-                    when (func) {
-                        "sqrt" -> {
-                            if (x >= BigDecimal.ZERO) {
-                                // Set the precision for the square root calculation
-                                val integerPartLength = x.toString().length
-                                val maxPrecision = (integerPartLength + 50).coerceAtMost(1000) // Maximum precision is 1000
-                                val precision = MathContext(maxPrecision, RoundingMode.HALF_DOWN)
-                                x = if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.TIRAMISU) { // Use default BigDecimal sqrt function (API 33)
-                                    x.sqrt(precision)
-                                } else { // Use Newton's method for square root calculation with Android versions prior to API 33
-                                    bigDecimalSqrtFormerAndroidVersion(x, precision)
-                                }
-                            } else {
-                                require_real_number = true
-                            }
-
-                        }
-                        "factorial" -> {
-                            x = factorial(x)
-                        }
-                        "ln" -> {
-                            if (x > Double.MAX_VALUE.toBigDecimal()) {
-                                is_infinity = true
-                                x = BigDecimal.ZERO
-                            } else if (x <= BigDecimal.ZERO) {
-                                domain_error = true
-                            } else {
-                                x = BigDecimal(ln(x.toDouble()))
-                            }
-                        }
-                        "logtwo" -> {
-                            if (x > Double.MAX_VALUE.toBigDecimal()) {
-                                is_infinity = true
-                                x = BigDecimal.ZERO
-                            } else if (x <= BigDecimal.ZERO) {
-                                domain_error = true
-                            } else {
-                                x = BigDecimal(log2(x.toDouble()))
-                            }
-                        }
-                        "logten" -> {
-                            if (x > Double.MAX_VALUE.toBigDecimal()) {
-                                is_infinity = true
-                                x = BigDecimal.ZERO
-                            } else if (x <= BigDecimal.ZERO) {
-                                domain_error = true
-                            } else {
-                                x = BigDecimal(log10(x.toDouble()))
-                            }
-                        }
-                        "xp" -> {
-                            x = exponentiation(BigDecimal(Math.E), x)
-                        }
-                        "sin" -> {
-                            if (x > Double.MAX_VALUE.toBigDecimal()) {
-                                is_infinity = true
-                                x = BigDecimal.ZERO
-                            } else if (isDegreeModeActivated) {
-                                x = sin(Math.toRadians(x.toDouble())).toBigDecimal()
-                                // https://stackoverflow.com/questions/29516222/how-to-get-exact-value-of-trigonometric-functions-in-java
-                            } else {
-                                x = sin(x.toDouble()).toBigDecimal()
-                            }
-                            if (x > BigDecimal.ZERO && x < BigDecimal(1.0E-14)) {
-                                x = round(x.toDouble()).toBigDecimal()
-                            }
-                        }
-                        "cos" -> {
-                            if (x > Double.MAX_VALUE.toBigDecimal()) {
-                                is_infinity = true
-                                x = BigDecimal.ZERO
-                            } else if (isDegreeModeActivated) {
-                                x = cos(Math.toRadians(x.toDouble())).toBigDecimal()
-                            } else {
-                                x = cos(x.toDouble()).toBigDecimal()
-                            }
-                            if (x > BigDecimal.ZERO && x < BigDecimal(1.0E-14)) {
-                                x = round(x.toDouble()).toBigDecimal()
-                            }
-                        }
-                        "tan" -> {
-                            if (x > Double.MAX_VALUE.toBigDecimal()) {
-                                is_infinity = true
-                                x = BigDecimal.ZERO
-                            } else if (Math.toDegrees(x.toDouble()) == 90.0) {
-                                // Tangent is defined for R\{(2k+1)π/2, with k ∈ Z}
-                                domain_error = true
-                                x = BigDecimal.ZERO
-                            } else {
-                                x = if (isDegreeModeActivated) {
-                                    tan(Math.toRadians(x.toDouble())).toBigDecimal()
-                                } else {
-                                    tan(x.toDouble()).toBigDecimal()
-                                }
-                                if (x > BigDecimal.ZERO && x < BigDecimal(1.0E-14)) {
-                                    x = round(x.toDouble()).toBigDecimal()
-                                }
-                            }
-                        }
-                        "arcsi" -> {
-                            if (abs(x.toDouble()) > 1) {
-                                x = BigDecimal.ZERO
-                                domain_error = true
-                            } else {
-                                x = if (isDegreeModeActivated) {
-                                    (asin(x.toDouble()) * 180 / Math.PI).toBigDecimal()
-                                } else {
-                                    asin(x.toDouble()).toBigDecimal()
-                                }
-                                if (x > BigDecimal.ZERO && x < BigDecimal(1.0E-14)) {
-                                    x = round(x.toDouble()).toBigDecimal()
-                                }
-                            }
-                        }
-                        "arcco" -> {
-                            if (abs(x.toDouble()) > 1) {
-                                x = BigDecimal.ZERO
-                                domain_error = true
-                            } else {
-                                x = if (isDegreeModeActivated) {
-                                    (acos(x.toDouble())*180/Math.PI).toBigDecimal()
-                                } else {
-                                    acos(x.toDouble()).toBigDecimal()
-                                }
-                                if (x > BigDecimal.ZERO && x < BigDecimal(1.0E-14)) {
-                                    x = round(x.toDouble()).toBigDecimal()
-                                }
-                            }
-
-                        }
-                        "arcta" -> {
-                            if (x > Double.MAX_VALUE.toBigDecimal()) {
-                                is_infinity = true
-                                x = BigDecimal.ZERO
-                            } else if  (isDegreeModeActivated) {
-                                x = (atan(x.toDouble()) * 180 / Math.PI).toBigDecimal()
-                            } else {
-                                x =atan(x.toDouble()).toBigDecimal()
-                            }
-                            if (x > BigDecimal.ZERO && x < BigDecimal(1.0E-14)) {
-                                x = round(x.toDouble()).toBigDecimal()
-                            }
-                        }
-                        else -> {
-                            syntax_error = true
-                        }
+                    if (x > BigDecimal.ZERO && x < BigDecimal(1.0E-14)) {
+                        x = round(x.toDouble()).toBigDecimal()
                     }
-                } else {
+                }
+
+            }
+            MathFunction.ARCTAN -> {
+                if (x > Double.MAX_VALUE.toBigDecimal()) {
+                    is_infinity = true
                     x = BigDecimal.ZERO
-                    syntax_error = true
+                } else if  (isDegreeModeActivated) {
+                    x = (atan(x.toDouble()) * 180 / Math.PI).toBigDecimal()
+                } else {
+                    x =atan(x.toDouble()).toBigDecimal()
                 }
-                if (eat('^'.code)) {
-                    x = exponentiation(x, parseFactor())
+                if (x > BigDecimal.ZERO && x < BigDecimal(1.0E-14)) {
+                    x = round(x.toDouble()).toBigDecimal()
                 }
-                return x
             }
-        }.parse()
+        }
+        return x
     }
 }
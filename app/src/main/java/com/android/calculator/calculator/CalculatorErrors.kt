@@ -0,0 +1,40 @@
+package com.android.calculator.calculator
+
+/**
+ * Error flags raised while cleaning up and evaluating an expression, and whether the evaluation
+ * had to round a value to the precision.
+ *
+ * The calculator screen resets and reads the flags back across threads, so they are shared by
+ * default. [isolated] gives the calling thread its own set of flags for the duration of a block,
+ * which is what makes it safe to run several evaluations at the same time.
+ */
+class CalculatorErrors {
+    var divisionBy0 = false
+    var domainError = false
+    var syntaxError = false
+    var isInfinity = false
+    var requireRealNumber = false
+    // Not an error: the result depends on the precision it was evaluated at
+    var isRounded = false
+
+    val hasError: Boolean
+        get() = divisionBy0 || domainError || syntaxError || isInfinity || requireRealNumber
+
+    companion object {
+        private val shared = CalculatorErrors()
+        private val local = ThreadLocal<CalculatorErrors?>()
+
+        fun current(): CalculatorErrors = local.get() ?: shared
+
+        fun <T> isolated(block: (CalculatorErrors) -> T): T {
+            val previous = local.get()
+            val errors = CalculatorErrors()
+            local.set(errors)
+            try {
+                return block(errors)
+            } finally {
+                local.set(previous)
+            }
+        }
+    }
+}
@@ -0,0 +1,37 @@
+package com.android.calculator.calculator
+
+import java.util.concurrent.ExecutorService
+import java.util.concurrent.LinkedBlockingQueue
+import java.util.concurrent.ThreadFactory
+import java.util.concurrent.ThreadPoolExecutor
+import java.util.concurrent.TimeUnit
+import java.util.concurrent.atomic.AtomicInteger
+
+/**
+ * Thread pool shared by the parallel work of the calculator: the history recomputation, the
+ * variables of the workspace and the numeric and matrix engines. The app then has a single pool
+ * of one thread per processor but the main one, whatever parts of it are in use.
+ *
+ * Work submitted from a thread of the pool runs on that thread instead: a task waiting for
+ * tasks queued behind it on the same pool could otherwise wait for ever once every thread does.
+ */
+object CalculatorExecutor {
+
+    private class Worker(runnable: Runnable, name: String) : Thread(runnable, name)
+
+    private class Pool(threadCount: Int, threadFactory: ThreadFactory) : ThreadPoolExecutor(
+        threadCount, threadCount, 0L, TimeUnit.MILLISECONDS, LinkedBlockingQueue(), threadFactory
+    ) {
+        override fun execute(command: Runnable) {
+            if (Thread.currentThread() is Worker) command.run() else super.execute(command)
+        }
+    }
+
+    val shared: ExecutorService by lazy {
+        val threadCount = (Runtime.getRuntime().availableProcessors() - 1).coerceAtLeast(1)
+        val threadNumber = AtomicInteger()
+        Pool(threadCount) { runnable ->
+            Worker(runnable, "calculator-${threadNumber.incrementAndGet()}").apply { isDaemon = true }
+        }
+    }
+}
@@ -0,0 +1,189 @@
+package com.android.calculator.calculator
+
+import android.os.Trace
+import java.util.concurrent.CopyOnWriteArrayList
+import java.util.concurrent.atomic.AtomicLongArray
+
+/**
+ * Always-on timers splitting the time from a keystroke to its displayed result into phases.
+ *
+ * Phases nest: each one records its own time only, without the phases running inside it, so that
+ * the time spent in the obfuscation wrappers is not counted again in what they wrap. The code a
+ * wrapper runs goes through [passThrough], so that it is counted in the phase around the wrapper
+ * and not in the wrapper. [Phase.RESULT] wraps the whole computation of a result and records it in
+ * full.
+ *
+ * Durations go to log2 histograms of microseconds. The histograms are kept per time window in a
+ * ring of [WINDOW_COUNT] windows, so that [snapshot] describes the last few minutes and not the
+ * whole life of the process. Each thread records into histograms of its own, merged on read.
+ */
+object PhaseTimer {
+
+    enum class Phase(val key: String, val traced: Boolean, val inclusive: Boolean = false) {
+        RESULT("result", true, inclusive = true),
+        CLEAN_EXPRESSION("clean_expression", true),
+        EVALUATE("evaluate", true),
+        FORMAT("format", true),
+        // Entered for every wrapper call, far too often to be worth a trace section
+        OBFUSCATION("obfuscation", false)
+    }
+
+    private const val WINDOW_MILLIS = 30_000L
+    private const val WINDOW_COUNT = 10
+    // Bucket i holds durations below 2^i µs, the last one everything above 2^(BUCKET_COUNT - 2) µs
+    private const val BUCKET_COUNT = 24
+    private const val MAX_DEPTH = 32
+
+    private val phases = Phase.values()
+
+    // Histograms of one thread, only written by it and merged by [snapshot]: recording a duration
+    // takes no lock, and the threads computing results never contend with each other
+    private class Recorder {
+        val histograms = AtomicLongArray(WINDOW_COUNT * phases.size * BUCKET_COUNT)
+        val totals = AtomicLongArray(WINDOW_COUNT * phases.size)
+        val maxima = AtomicLongArray(WINDOW_COUNT * phases.size)
+        val windowEpochs = AtomicLongArray(WINDOW_COUNT).also { epochs ->
+            for (window in 0 until WINDOW_COUNT) epochs.set(window, -1)
+        }
+
+        fun record(phase: Phase, nanos: Long) {
+            val epoch = System.currentTimeMillis() / WINDOW_MILLIS
+            val window = (epoch % WINDOW_COUNT).toInt()
+            if (windowEpochs.get(window) != epoch) {
+                val first = window * phases.size
+                for (i in first * BUCKET_COUNT until (first + phases.size) * BUCKET_COUNT) histograms.lazySet(i, 0)
+                for (i in first until first + phases.size) {
+                    totals.lazySet(i, 0)
+                    maxima.lazySet(i, 0)
+                }
+                windowEpochs.set(window, epoch)
+            }
+            val micros = nanos / 1000
+            val bucket = (64 - java.lang.Long.numberOfLeadingZeros(micros)).coerceAtMost(BUCKET_COUNT - 1)
+            val index = window * phases.size + phase.ordinal
+            histograms.lazySet(index * BUCKET_COUNT + bucket, histograms.get(index * BUCKET_COUNT + bucket) + 1)
+            totals.lazySet(index, totals.get(index) + micros)
+            if (micros > maxima.get(index)) maxima.lazySet(index, micros)
+        }
+    }
+
+    private val recorders = CopyOnWriteArrayList<Recorder>()
+
+    // Phases running on this thread: time spent in the phases nested in each level, and time of
+    // the blocks passed through it to the level below
+    private class Frames {
+        val childNanos = LongArray(MAX_DEPTH)
+        val passedNanos = LongArray(MAX_DEPTH)
+        var depth = -1
+        val recorder = Recorder().also { recorders.add(it) }
+    }
+
+    private val frames = ThreadLocal.withInitial { Frames() }
+
+    inline fun <T> measure(phase: Phase, block: () -> T): T {
+        val start = enter(phase)
+        try {
+            return block()
+        } finally {
+            exit(phase, start)
+        }
+    }
+
+    /**
+     * Run [block] inside the phase measured around it as if that phase was not there: the time of
+     * the block is not counted in the phase, but in the one enclosing it. This is how a wrapper
+     * only records its own overhead and not the code it wraps.
+     */
+    inline fun <T> passThrough(block: () -> T): T {
+        val start = enterPassThrough()
+        try {
+            return block()
+        } finally {
+            exitPassThrough(start)
+        }
+    }
+
+    fun enter(phase: Phase): Long {
+        if (phase.traced) Trace.beginSection("Calculator.${phase.key}")
+        push(frames.get()!!)
+        return System.nanoTime()
+    }
+
+    fun exit(phase: Phase, start: Long) {
+        val elapsed = System.nanoTime() - start
+        val frames = frames.get()!!
+        val depth = frames.depth--
+        val childNanos = if (depth in 0 until MAX_DEPTH) frames.childNanos[depth] else 0
+        val passedNanos = if (depth in 0 until MAX_DEPTH) frames.passedNanos[depth] else 0
+        if (depth in 1..MAX_DEPTH) frames.childNanos[depth - 1] += elapsed - passedNanos
+        frames.recorder.record(phase, if (phase.inclusive) elapsed else (elapsed - childNanos).coerceAtLeast(0))
+        if (phase.traced) Trace.endSection()
+    }
+
+    fun enterPassThrough(): Long {
+        push(frames.get()!!)
+        return System.nanoTime()
+    }
+
+    fun exitPassThrough(start: Long) {
+        val elapsed = System.nanoTime() - start
+        val frames = frames.get()!!
+        val depth = frames.depth--
+        val childNanos = if (depth in 0 until MAX_DEPTH) frames.childNanos[depth] else 0
+        if (depth in 1..MAX_DEPTH) {
+            frames.childNanos[depth - 1] += elapsed
+            // Phases nested in the block are already recorded, and counted by the level above
+            frames.passedNanos[depth - 1] += elapsed - childNanos
+        }
+    }
+
+    private fun push(frames: Frames) {
+        if (++frames.depth < MAX_DEPTH) {
+            frames.childNanos[frames.depth] = 0
+            frames.passedNanos[frames.depth] = 0
+        }
+    }
+
+    /**
+     * Per phase: count, total, p50, p99 and maximum in microseconds over the live windows.
+     * Percentiles are the upper bound of their histogram bucket.
+     */
+    fun snapshot(): Map<String, Map<String, Long>> {
+        val oldestEpoch = System.currentTimeMillis() / WINDOW_MILLIS - WINDOW_COUNT + 1
+        val snapshot = LinkedHashMap<String, Map<String, Long>>()
+        for (phase in phases) {
+            val merged = LongArray(BUCKET_COUNT)
+            var total = 0L
+            var max = 0L
+            for (recorder in recorders) {
+                for (window in 0 until WINDOW_COUNT) {
+                    if (recorder.windowEpochs.get(window) < oldestEpoch) continue
+                    val index = window * phases.size + phase.ordinal
+                    for (bucket in 0 until BUCKET_COUNT) merged[bucket] += recorder.histograms.get(index * BUCKET_COUNT + bucket)
+                    total += recorder.totals.get(index)
+                    max = maxOf(max, recorder.maxima.get(index))
+                }
+            }
+            val count = merged.sum()
+            snapshot[phase.key] = mapOf(
+                "count" to count,
+                "total_us" to total,
+                "p50_us" to percentile(merged, count, 0.50, max),
+                "p99_us" to percentile(merged, count, 0.99, max),
+                "max_us" to max
+            )
+        }
+        return snapshot
+    }
+
+    private fun percentile(histogram: LongArray, count: Long, fraction: Double, max: Long): Long {
+        if (count == 0L) return 0
+        val rank = Math.ceil(fraction * count).toLong()
+        var seen = 0L
+        for (bucket in histogram.indices) {
+            seen += histogram[bucket]
+            if (seen >= rank) return minOf(1L shl bucket, max)
+        }
+        return max
+    }
+}
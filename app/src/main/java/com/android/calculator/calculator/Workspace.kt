@@ -0,0 +1,232 @@
+package com.android.calculator.calculator
+
+import com.android.calculator.calculator.compiler.MathFunction
+import com.android.calculator.calculator.compiler.MatrixFunction
+import com.android.calculator.calculator.compiler.Program
+import com.android.calculator.calculator.compiler.ProgramCache
+import com.android.calculator.calculator.compiler.StatisticFunction
+import java.math.BigDecimal
+import java.util.concurrent.Callable
+import java.util.concurrent.ExecutorService
+
+/**
+ * Values kept from one calculation to the next: `ans`, the memory, and the variables defined by
+ * the user, either as a value or as an expression of other variables.
+ *
+ * A variable defined by an expression keeps its compiled program and its last value. When a
+ * variable changes, only the variables that depend on it, directly or not, are evaluated again,
+ * in topological order: one level at a time, the variables of a level not depending on one
+ * another and being evaluated in parallel on [executor].
+ */
+class Workspace(
+    private var numberPrecisionDecimal: Int,
+    private var isDegreeModeActivated: Boolean,
+    private val executor: ExecutorService = CalculatorExecutor.shared
+) {
+
+    companion object {
+        const val ANS = "ans"
+        const val MEMORY = "m"
+
+        @Volatile
+        private var instance: Workspace? = null
+
+        /**
+         * The workspace of the calculator screen, kept for the life of the process so that `ans`
+         * and the variables outlive the activity. Its settings are those of the last
+         * [updateSettings].
+         */
+        fun getInstance(): Workspace {
+            return instance ?: synchronized(this) {
+                instance ?: Workspace(10, true).also { instance = it }
+            }
+        }
+
+        /**
+         * Whether [name] is read as a variable in a clean expression: lowercase letters, not
+         * starting with the constant e, and not the name of a function
+         */
+        fun isValidName(name: String): Boolean {
+            if (name.isEmpty() || name.any { it !in 'a'..'z' } || name[0] == 'e') return false
+            val chars = name.toCharArray()
+            return MathFunction.of(chars, 0, chars.size) < 0 &&
+                StatisticFunction.of(chars, 0, chars.size) < 0 &&
+                MatrixFunction.of(chars, 0, chars.size) < 0
+        }
+    }
+
+    private class Variable(
+        // null for a variable holding a value
+        val program: Program?,
+        // null when the expression has an error
+        var value: BigDecimal?
+    )
+
+    private val variables = HashMap<String, Variable>()
+    // Variables defined by an expression reading each name, whether that name is defined or not
+    private val dependents = HashMap<String, MutableSet<String>>()
+    private val lock = Any()
+
+    /** The value of [name], null if it is not defined or if its expression has an error */
+    fun value(name: String): BigDecimal? = synchronized(lock) { variables[name]?.value }
+
+    /** The values of all the variables that have one, by name */
+    fun values(): Map<String, BigDecimal> = synchronized(lock) { snapshot() }
+
+    fun setValue(name: String, value: BigDecimal) {
+        require(isValidName(name)) { "Invalid variable name: $name" }
+        synchronized(lock) {
+            replace(name, Variable(null, value))
+            recompute(dependentsOf(name))
+        }
+    }
+
+    /**
+     * Define [name] as the value of [expression], a clean expression of other variables.
+     * Returns false, and changes nothing, if [expression] depends on [name] itself.
+     */
+    fun define(name: String, expression: String): Boolean {
+        require(isValidName(name)) { "Invalid variable name: $name" }
+        val program = ProgramCache.get(expression)
+        synchronized(lock) {
+            if (reads(program, name)) return false
+            replace(name, Variable(program, null))
+            recompute(dependentsOf(name) + name)
+        }
+        return true
+    }
+
+    fun remove(name: String) {
+        synchronized(lock) {
+            replace(name, null)
+            recompute(dependentsOf(name))
+        }
+    }
+
+    fun memoryAdd(value: BigDecimal) {
+        synchronized(lock) {
+            setValue(MEMORY, (variables[MEMORY]?.value ?: BigDecimal.ZERO).add(value))
+        }
+    }
+
+    fun memorySubtract(value: BigDecimal) {
+        synchronized(lock) {
+            setValue(MEMORY, (variables[MEMORY]?.value ?: BigDecimal.ZERO).subtract(value))
+        }
+    }
+
+    fun memoryClear() = remove(MEMORY)
+
+    /**
+     * Evaluate [expression] with the current variables, raising the error flags of this thread,
+     * and keep its result as [ANS] when there is no error and [keepAsAns] is set.
+     */
+    fun evaluate(expression: String, keepAsAns: Boolean = true): BigDecimal {
+        val numberPrecisionDecimal: Int
+        val isDegreeModeActivated: Boolean
+        val values: Map<String, BigDecimal>
+        synchronized(lock) {
+            numberPrecisionDecimal = this.numberPrecisionDecimal
+            isDegreeModeActivated = this.isDegreeModeActivated
+            values = snapshot()
+        }
+        val result = Calculator(numberPrecisionDecimal).evaluate(expression, isDegreeModeActivated, values)
+        if (keepAsAns && !CalculatorErrors.current().hasError) setValue(ANS, result)
+        return result
+    }
+
+    /** Change the settings the variables are evaluated with, and evaluate them all again */
+    fun updateSettings(numberPrecisionDecimal: Int, isDegreeModeActivated: Boolean) {
+        synchronized(lock) {
+            if (numberPrecisionDecimal == this.numberPrecisionDecimal && isDegreeModeActivated == this.isDegreeModeActivated) {
+                return
+            }
+            this.numberPrecisionDecimal = numberPrecisionDecimal
+            this.isDegreeModeActivated = isDegreeModeActivated
+            recompute(variables.keys.toSet())
+        }
+    }
+
+    private fun replace(name: String, variable: Variable?) {
+        variables[name]?.program?.let { program ->
+            for (dependency in program.variableNames) dependents[dependency]?.remove(name)
+        }
+        variable?.program?.let { program ->
+            for (dependency in program.variableNames) dependents.getOrPut(dependency) { HashSet() }.add(name)
+        }
+        if (variable == null) variables.remove(name) else variables[name] = variable
+    }
+
+    // Whether program reads name, directly or through other variables
+    private fun reads(program: Program, name: String): Boolean {
+        val visited = HashSet<String>()
+        val stack = ArrayList(program.variableNames)
+        while (stack.isNotEmpty()) {
+            val dependency = stack.removeAt(stack.size - 1)
+            if (dependency == name) return true
+            if (!visited.add(dependency)) continue
+            variables[dependency]?.program?.let { stack.addAll(it.variableNames) }
+        }
+        return false
+    }
+
+    // Variables depending on name, directly or not
+    private fun dependentsOf(name: String): Set<String> {
+        val found = HashSet<String>()
+        val stack = arrayListOf(name)
+        while (stack.isNotEmpty()) {
+            for (dependent in dependents[stack.removeAt(stack.size - 1)].orEmpty()) {
+                if (found.add(dependent)) stack.add(dependent)
+            }
+        }
+        return found
+    }
+
+    private fun snapshot(): Map<String, BigDecimal> {
+        val values = HashMap<String, BigDecimal>(variables.size)
+        for ((name, variable) in variables) variable.value?.let { values[name] = it }
+        return values
+    }
+
+    // Evaluate again the variables of names defined by an expression, those they read first
+    private fun recompute(names: Set<String>) {
+        // Number of variables to evaluate again that each one still waits for
+        val waiting = HashMap<String, Int>()
+        for (name in names) {
+            val program = variables[name]?.program ?: continue
+            waiting[name] = program.variableNames.count { it in names && variables[it]?.program != null }
+        }
+
+        var level = waiting.filterValues { it == 0 }.keys.toList()
+        while (level.isNotEmpty()) {
+            evaluateLevel(level)
+            val next = ArrayList<String>()
+            for (name in level) {
+                for (dependent in dependents[name].orEmpty()) {
+                    val count = waiting[dependent] ?: continue
+                    waiting[dependent] = count - 1
+                    if (count == 1) next.add(dependent)
+                }
+            }
+            level = next
+        }
+    }
+
+    private fun evaluateLevel(level: List<String>) {
+        val values = snapshot()
+        val numberPrecisionDecimal = numberPrecisionDecimal
+        val isDegreeModeActivated = isDegreeModeActivated
+        val tasks = level.map { name ->
+            val program = variables[name]!!.program!!
+            Callable {
+                val calculator = Calculator(numberPrecisionDecimal)
+                CalculatorErrors.isolated { errors ->
+                    program.execute(calculator, isDegreeModeActivated, values).takeUnless { errors.hasError }
+                }
+            }
+        }
+        // A single variable is not worth a thread switch
+        val results = if (tasks.size == 1) listOf(tasks[0].call()) else executor.invokeAll(tasks).map { it.get() }
+        for (i in level.indices) variables[level[i]]!!.value = results[i]
+    }
+}
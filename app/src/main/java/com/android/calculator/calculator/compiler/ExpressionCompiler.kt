@@ -0,0 +1,439 @@
+package com.android.calculator.calculator.compiler
+
+import com.android.calculator.calculator.Calculator
+import com.android.calculator.calculator.CalculatorErrors
+import java.math.BigDecimal
+import kotlin.math.PI
+
+/**
+ * Compiles a clean expression, as given to [Calculator.evaluate], to a [Program].
+ *
+ * The grammar and its error handling are the ones of the former recursive evaluator, parsed
+ * without recursion in a time linear in the length of the input. While emitting, the compiler:
+ * - folds the operations whose operands are constants, when their result does not depend on the
+ *   settings of the calculator and raises no error,
+ * - reuses the register of an identical operation already emitted, so that a repeated
+ *   subexpression is only computed once,
+ * - turns `x^2` into a single multiplication.
+ */
+internal class ExpressionCompiler private constructor(equation: String) {
+
+    companion object {
+        /**
+         * Compile [equation]. A name that is not the one of a function, and is not followed by a
+         * parenthesis, is a variable whose value is given to [Program.execute].
+         */
+        fun compile(equation: String): Program {
+            return ExpressionCompiler(equation).compile()
+        }
+
+        private val TWO = BigDecimal(2)
+        private val MAX_EXPONENT = BigDecimal(10000)
+        private val E = BigDecimal(Math.E)
+        private val PI_VALUE = BigDecimal(PI)
+
+        // Kinds of the operator stack entries besides the opcodes of the operations
+        private const val OPEN_PARENTHESIS = 16
+        private const val OPEN_FUNCTION = 17
+        private const val PREFIX_FUNCTION = 18
+        private const val OPEN_LIST = 19
+        private const val OPEN_MATRIX = 20
+        private const val KIND_BITS = 5
+
+        private const val ADDITIVE = 1
+        private const val MULTIPLICATIVE = 2
+
+        // Folding only goes through operations that do not read the precision
+        private val folder = Calculator(0)
+    }
+
+    private data class Instruction(val opcode: Int, val a: Int, val b: Int)
+
+    // The whole input is read from one array, and numbers are parsed where they are
+    private val chars = equation.toCharArray()
+    private var pos = -1
+    private var ch = 0
+
+    // Operators waiting for their right operand or for a closing parenthesis, innermost on top
+    private val operators = IntStack()
+    // Registers of the elements of the lists being parsed, and where each list starts among them
+    private val listElements = IntStack()
+    private val listStarts = IntStack()
+
+    private val instructions = ArrayList<Instruction>()
+    private val constants = ArrayList<BigDecimal>()
+    private val constantIndexes = HashMap<BigDecimal, Int>()
+    private val variables = ArrayList<String>()
+    private val variableIndexes = HashMap<String, Int>()
+    // Registers of the elements of each list
+    private val lists = ArrayList<IntArray>()
+    // Constant value of each register, null if it is only known when executing
+    private val registerValues = ArrayList<BigDecimal?>()
+    // Register of each instruction already emitted, for common subexpressions
+    private val emitted = HashMap<Instruction, Int>()
+    // First register that may be reused, past the last syntax error
+    private var reusableFrom = 0
+
+    private fun compile(): Program {
+        nextChar()
+        // Anything left after the expression is ignored
+        return link(parse())
+    }
+
+    private fun nextChar() {
+        ch = if (++pos < chars.size) chars[pos].code else -1
+    }
+
+    private fun skipSpaces() {
+        while (ch == ' '.code) nextChar()
+    }
+
+    private fun eat(charToEat: Int): Boolean {
+        skipSpaces()
+        if (ch == charToEat) {
+            nextChar()
+            return true
+        }
+        return false
+    }
+
+    /*
+     * Operator precedence parsing of the grammar of the former recursive evaluator:
+     *
+     *   expression = term (('+' | '-') term)*
+     *   term       = factor (('*' | '#' | '/') factor)*
+     *   factor     = ('+' | '-') factor | primary ('^' factor)?
+     *   primary    = '(' expression ')' | number | 'e' | 'π' | variable
+     *              | function '(' expression ')' | function factor
+     *              | statistic '(' expression (';' expression)* ')'
+     *              | matrix '(' expression (';' expression)* ')'
+     *
+     * Pending operators live on an explicit stack instead of the call stack, so that the depth
+     * of nesting is only bounded by memory, and instructions are emitted in the same order.
+     */
+    private fun parse(): Int {
+        var x = parseOperand()
+        while (true) {
+            if (eat('^'.code)) {
+                operators.push(entry(Program.POWER, x))
+                x = parseOperand()
+                continue
+            }
+            x = reduceFactor(x)
+
+            skipSpaces()
+            val opcode = when (ch) {
+                '+'.code -> Program.ADD
+                '-'.code -> Program.SUBTRACT
+                '*'.code -> Program.MULTIPLY
+                '#'.code -> Program.MODULO
+                '/'.code -> Program.DIVIDE
+                else -> -1
+            }
+            if (opcode >= 0) {
+                nextChar()
+                x = reduceBinary(x, precedence(opcode))
+                operators.push(entry(opcode, x))
+                x = parseOperand()
+                continue
+            }
+
+            // End of an expression: of the whole input, or of a parenthesis
+            x = reduceBinary(x, ADDITIVE)
+            if (operators.isEmpty()) return x
+            val open = operators.pop()
+            if (kind(open) == OPEN_LIST || kind(open) == OPEN_MATRIX) {
+                listElements.push(x)
+                if (eat(';'.code)) { // next element
+                    operators.push(open)
+                    x = parseOperand()
+                    continue
+                }
+                val elements = listElements.popFrom(listStarts.pop())
+                val opcode = if (kind(open) == OPEN_LIST) Program.STATISTIC else Program.MATRIX
+                x = if (eat(')'.code)) listFunction(opcode, argument(open), elements) else syntaxError()
+            } else if (kind(open) == OPEN_PARENTHESIS) {
+                if (!eat(')'.code)) x = syntaxError()
+            } else if (eat(')'.code)) {
+                x = function(argument(open), x)
+            } else {
+                // The former evaluator took the factor that follows as argument instead
+                operators.push(entry(PREFIX_FUNCTION, argument(open)))
+                x = parseOperand()
+            }
+        }
+    }
+
+    // Push the prefixes and openings in front of a primary, and return the register of the primary
+    private fun parseOperand(): Int {
+        while (true) {
+            if (eat('+'.code)) continue // unary plus
+            if (eat('-'.code)) { // unary minus
+                operators.push(entry(Program.NEGATE, 0))
+                continue
+            }
+            if (eat('('.code)) { // parentheses
+                operators.push(entry(OPEN_PARENTHESIS, 0))
+                continue
+            }
+            if (ch >= '0'.code && ch <= '9'.code || ch == '.'.code) return parseNumber()
+            if (eat('e'.code)) return constant(E)
+            if (eat('π'.code)) return constant(PI_VALUE)
+            if (ch < 'a'.code || ch > 'z'.code) return syntaxError()
+
+            // functions, lists and variables
+            val start = pos
+            while (ch >= 'a'.code && ch <= 'z'.code) nextChar()
+            val statistic = StatisticFunction.of(chars, start, pos)
+            if (statistic >= 0 && eat('('.code)) {
+                operators.push(entry(OPEN_LIST, statistic))
+                listStarts.push(listElements.size)
+                continue
+            }
+            val matrix = MatrixFunction.of(chars, start, pos)
+            if (matrix >= 0 && eat('('.code)) {
+                operators.push(entry(OPEN_MATRIX, matrix))
+                listStarts.push(listElements.size)
+                continue
+            }
+            val function = MathFunction.of(chars, start, pos)
+            skipSpaces()
+            if (function < 0 && ch != '('.code) return variable(String(chars, start, pos - start))
+            operators.push(entry(if (eat('('.code)) OPEN_FUNCTION else PREFIX_FUNCTION, function))
+        }
+    }
+
+    private fun parseNumber(): Int {
+        val start = pos
+        var separators = 0
+        while (ch >= '0'.code && ch <= '9'.code || ch == '.'.code) {
+            if (ch == '.'.code) separators++
+            nextChar()
+        }
+        if (separators > 1 || (pos - start == 1 && separators == 1)) return syntaxError()
+        return constant(BigDecimal(chars, start, pos - start))
+    }
+
+    // Apply the operators that take a factor, now that the one on their right is complete
+    private fun reduceFactor(factor: Int): Int {
+        var x = factor
+        while (!operators.isEmpty()) {
+            val operator = operators.peek()
+            x = when (kind(operator)) {
+                Program.NEGATE -> emit(Program.NEGATE, x)
+                Program.POWER -> power(argument(operator), x)
+                PREFIX_FUNCTION -> function(argument(operator), x)
+                else -> return x
+            }
+            operators.pop()
+        }
+        return x
+    }
+
+    // Apply the binary operators on top of the stack that take precedence over the next one
+    private fun reduceBinary(right: Int, minPrecedence: Int): Int {
+        var x = right
+        while (!operators.isEmpty()) {
+            val operator = operators.peek()
+            val opcode = kind(operator)
+            if (opcode < Program.ADD || opcode > Program.MODULO || precedence(opcode) < minPrecedence) break
+            operators.pop()
+            x = emit(opcode, argument(operator), x)
+        }
+        return x
+    }
+
+    private fun precedence(opcode: Int): Int {
+        return if (opcode == Program.ADD || opcode == Program.SUBTRACT) ADDITIVE else MULTIPLICATIVE
+    }
+
+    private fun entry(kind: Int, argument: Int): Int = (argument shl KIND_BITS) or kind
+
+    private fun kind(entry: Int): Int = entry and ((1 shl KIND_BITS) - 1)
+
+    // Left operand, or code of the function, which is -1 for an unknown one
+    private fun argument(entry: Int): Int = entry shr KIND_BITS
+
+    private fun function(function: Int, argument: Int): Int {
+        if (function >= 0) return emit(Program.FUNCTION, argument, function)
+        // An unknown function leaves its argument as it is
+        syntaxError()
+        return argument
+    }
+
+    private fun listFunction(opcode: Int, function: Int, elements: IntArray): Int {
+        // Neither folded nor shared: the elements are not operands of the instruction
+        lists.add(elements)
+        return append(Instruction(opcode, lists.size - 1, function), null)
+    }
+
+    private fun power(x: Int, exponent: Int): Int {
+        // Only an integer 2 takes the same path as a multiplication in the exponentiation
+        val value = registerValues[exponent]
+        if (value != null && value.scale() == 0 && value.compareTo(TWO) == 0) {
+            return emit(Program.SQUARE, x)
+        }
+        return emit(Program.POWER, x, exponent)
+    }
+
+    private fun constant(value: BigDecimal): Int {
+        val index = constantIndexes.getOrPut(value) {
+            constants.add(value)
+            constants.size - 1
+        }
+        return append(Instruction(Program.CONSTANT, index, 0), value)
+    }
+
+    private fun variable(name: String): Int {
+        val index = variableIndexes.getOrPut(name) {
+            variables.add(name)
+            variables.size - 1
+        }
+        return append(Instruction(Program.VARIABLE, index, 0), null)
+    }
+
+    private fun syntaxError(): Int {
+        // Raising the flag again after an exponentiation has cleared it must not be skipped, so
+        // nothing emitted before is reused after
+        reusableFrom = instructions.size + 1
+        return append(Instruction(Program.SYNTAX_ERROR, 0, 0), null)
+    }
+
+    private fun emit(opcode: Int, a: Int, b: Int = 0): Int {
+        fold(opcode, a, b)?.let { return constant(it) }
+        val instruction = Instruction(opcode, a, b)
+        reusable(instruction)?.let { return it }
+        val register = append(instruction, null)
+        emitted[instruction] = register
+        return register
+    }
+
+    private fun append(instruction: Instruction, value: BigDecimal?): Int {
+        if (instruction.opcode == Program.CONSTANT || instruction.opcode == Program.VARIABLE) {
+            reusable(instruction)?.let { return it }
+            emitted[instruction] = instructions.size
+        }
+        instructions.add(instruction)
+        registerValues.add(value)
+        return instructions.size - 1
+    }
+
+    private fun reusable(instruction: Instruction): Int? {
+        return emitted[instruction]?.takeIf { it >= reusableFrom }
+    }
+
+    // The value of an operation on constants, if it can be computed once for all
+    private fun fold(opcode: Int, a: Int, b: Int): BigDecimal? {
+        val x = registerValues[a] ?: return null
+        val isUnary = opcode == Program.NEGATE || opcode == Program.SQUARE || opcode == Program.FUNCTION
+        val y = if (isUnary) BigDecimal.ZERO else registerValues[b] ?: return null
+        return try {
+            CalculatorErrors.isolated { errors ->
+                val value = when (opcode) {
+                    Program.NEGATE -> x.negate()
+                    Program.ADD -> x.add(y)
+                    Program.SUBTRACT -> x.subtract(y)
+                    Program.MULTIPLY -> x.multiply(y)
+                    // Only exact divisions: the rounded ones depend on the precision
+                    Program.DIVIDE -> if (isDivisionByZero(y) || !Fractions.isTerminating(x, y)) null else x.divide(y)
+                    Program.MODULO -> folder.modulo(x, y)
+                    // 0^y clears the syntax error flag and negative exponents read the precision
+                    Program.POWER -> {
+                        if (x == BigDecimal.ZERO || y <= BigDecimal.ZERO || y > MAX_EXPONENT) null
+                        else folder.exponentiation(x, y)
+                    }
+                    Program.SQUARE -> if (x == BigDecimal.ZERO) null else folder.square(x)
+                    Program.FUNCTION -> if (MathFunction.isConstant(b)) folder.function(b, x, true) else null
+                    else -> null
+                }
+                value.takeUnless { errors.hasError }
+            }
+        } catch (e: ArithmeticException) {
+            // An error left to the execution to raise
+            null
+        } catch (e: NumberFormatException) {
+            null
+        }
+    }
+
+    // Same test as Calculator.divide
+    private fun isDivisionByZero(denominator: BigDecimal): Boolean {
+        return denominator.toFloat() == 0f || denominator.toDouble() == -2.4492935982947064E-16
+    }
+
+    // Keep the instructions the result depends on, and all those that may raise an error flag
+    private fun link(result: Int): Program {
+        val live = BooleanArray(instructions.size)
+        live[result] = true
+        for (register in instructions.indices.reversed()) {
+            val instruction = instructions[register]
+            if (instruction.opcode != Program.CONSTANT) live[register] = true
+            if (!live[register]) continue
+            when (instruction.opcode) {
+                Program.CONSTANT, Program.SYNTAX_ERROR, Program.VARIABLE -> {}
+                Program.NEGATE, Program.SQUARE, Program.FUNCTION -> live[instruction.a] = true
+                Program.STATISTIC, Program.MATRIX -> for (element in lists[instruction.a]) live[element] = true
+                else -> {
+                    live[instruction.a] = true
+                    live[instruction.b] = true
+                }
+            }
+        }
+
+        val renumbered = IntArray(instructions.size)
+        val code = IntArray(live.count { it } * Program.STRIDE)
+        var pc = 0
+        for (register in instructions.indices) {
+            if (!live[register]) continue
+            renumbered[register] = pc / Program.STRIDE
+            val instruction = instructions[register]
+            code[pc] = instruction.opcode
+            when (instruction.opcode) {
+                Program.CONSTANT, Program.VARIABLE -> code[pc + 1] = instruction.a
+                Program.SYNTAX_ERROR -> {}
+                Program.NEGATE, Program.SQUARE -> code[pc + 1] = renumbered[instruction.a]
+                Program.FUNCTION -> {
+                    code[pc + 1] = renumbered[instruction.a]
+                    code[pc + 2] = instruction.b
+                }
+                Program.STATISTIC, Program.MATRIX -> {
+                    val elements = lists[instruction.a]
+                    for (i in elements.indices) elements[i] = renumbered[elements[i]]
+                    code[pc + 1] = instruction.a
+                    code[pc + 2] = instruction.b
+                }
+                else -> {
+                    code[pc + 1] = renumbered[instruction.a]
+                    code[pc + 2] = renumbered[instruction.b]
+                }
+            }
+            pc += Program.STRIDE
+        }
+        return Program(code, constants.toTypedArray(), variables.toTypedArray(), lists.toTypedArray(), renumbered[result])
+    }
+}
+
+// A stack of ints that grows as needed, without boxing
+private class IntStack {
+    private var values = IntArray(16)
+    var size = 0
+        private set
+
+    fun isEmpty(): Boolean = size == 0
+
+    fun push(value: Int) {
+        if (size == values.size) values = values.copyOf(size * 2)
+        values[size++] = value
+    }
+
+    fun peek(): Int = values[size - 1]
+
+    fun pop(): Int = values[--size]
+
+    /** Remove the values from [start] on, and return them in order */
+    fun popFrom(start: Int): IntArray {
+        val popped = values.copyOfRange(start, size)
+        size = start
+        return popped
+    }
+}
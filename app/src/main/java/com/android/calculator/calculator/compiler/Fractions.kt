@@ -0,0 +1,146 @@
+package com.android.calculator.calculator.compiler
+
+import com.android.calculator.calculator.Calculator
+import java.math.BigDecimal
+import java.math.BigInteger
+import kotlin.math.abs
+
+/**
+ * Exact fractions of the registers of a [Program], while their terms stay small.
+ *
+ * A register is exact as long as its numerator and denominator, kept reduced with a binary GCD,
+ * both fit in [LIMIT]: the product of two terms then fits in a Long, and no operation can
+ * overflow. A register that leaves that range, or that comes from an operation other than the
+ * four basic ones, is only computed in decimals, as every register was before.
+ */
+internal class Fractions(size: Int) {
+
+    companion object {
+        private const val LIMIT = Int.MAX_VALUE.toLong()
+        private const val MAX_SCALE = 18
+        private val POWERS_OF_TEN = LongArray(MAX_SCALE + 1).also { powers ->
+            powers[0] = 1
+            for (i in 1..MAX_SCALE) powers[i] = powers[i - 1] * 10
+        }
+        private val FIVE = BigInteger.valueOf(5)
+
+        /**
+         * Whether [x] / [denominator] has a finite decimal expansion, so that BigDecimal.divide
+         * can give it exactly. A zero denominator is left to the division to report.
+         */
+        fun isTerminating(x: BigDecimal, denominator: BigDecimal): Boolean {
+            if (denominator.signum() == 0) return true
+            // The quotient is ux / ud * 10^k: it is finite when the part of ud prime to 10 divides ux
+            var rest = denominator.unscaledValue().abs()
+            rest = rest.shiftRight(rest.lowestSetBit)
+            while (true) {
+                val quotientAndRemainder = rest.divideAndRemainder(FIVE)
+                if (quotientAndRemainder[1].signum() != 0) break
+                rest = quotientAndRemainder[0]
+            }
+            return rest == BigInteger.ONE || x.unscaledValue().mod(rest).signum() == 0
+        }
+
+        // Binary GCD of two non negative numbers
+        private fun gcd(x: Long, y: Long): Long {
+            if (x == 0L) return y
+            if (y == 0L) return x
+            val shift = (x or y).countTrailingZeroBits()
+            var a = x shr x.countTrailingZeroBits()
+            var b = y
+            do {
+                b = b shr b.countTrailingZeroBits()
+                if (a > b) {
+                    val swapped = a
+                    a = b
+                    b = swapped
+                }
+                b -= a
+            } while (b != 0L)
+            return a shl shift
+        }
+    }
+
+    private val numerators = LongArray(size)
+    // Always positive for an exact register, 0 for the others
+    private val denominators = LongArray(size)
+
+    fun isExact(register: Int): Boolean = denominators[register] != 0L
+
+    fun isZero(register: Int): Boolean = isExact(register) && numerators[register] == 0L
+
+    fun set(register: Int, value: BigDecimal): Boolean {
+        val unscaled = value.unscaledValue()
+        if (unscaled.bitLength() >= Long.SIZE_BITS - 1) return false
+        val scale = value.scale()
+        if (scale >= 0) {
+            return scale <= MAX_SCALE && store(register, unscaled.toLong(), POWERS_OF_TEN[scale])
+        }
+        if (-scale > MAX_SCALE) return false
+        val power = POWERS_OF_TEN[-scale]
+        val numerator = unscaled.toLong()
+        return abs(numerator) <= LIMIT / power && store(register, numerator * power, 1)
+    }
+
+    fun copy(register: Int, from: Fractions, index: Int): Boolean {
+        if (!from.isExact(index)) return false
+        numerators[register] = from.numerators[index]
+        denominators[register] = from.denominators[index]
+        return true
+    }
+
+    fun negate(register: Int, a: Int): Boolean {
+        if (!isExact(a)) return false
+        numerators[register] = -numerators[a]
+        denominators[register] = denominators[a]
+        return true
+    }
+
+    fun add(register: Int, a: Int, b: Int): Boolean {
+        if (!isExact(a) || !isExact(b)) return false
+        return store(
+            register,
+            numerators[a] * denominators[b] + numerators[b] * denominators[a],
+            denominators[a] * denominators[b]
+        )
+    }
+
+    fun subtract(register: Int, a: Int, b: Int): Boolean {
+        if (!isExact(a) || !isExact(b)) return false
+        return store(
+            register,
+            numerators[a] * denominators[b] - numerators[b] * denominators[a],
+            denominators[a] * denominators[b]
+        )
+    }
+
+    fun multiply(register: Int, a: Int, b: Int): Boolean {
+        if (!isExact(a) || !isExact(b)) return false
+        return store(register, numerators[a] * numerators[b], denominators[a] * denominators[b])
+    }
+
+    /** Leaves a division by zero to the decimal path, which raises the error */
+    fun divide(register: Int, a: Int, b: Int): Boolean {
+        if (!isExact(a) || !isExact(b) || numerators[b] == 0L) return false
+        val numerator = numerators[a] * denominators[b]
+        val denominator = denominators[a] * numerators[b]
+        return if (denominator < 0) store(register, -numerator, -denominator) else store(register, numerator, denominator)
+    }
+
+    /** The value of an exact register, rounded as a division of [calculator] when it does not terminate */
+    fun toBigDecimal(register: Int, calculator: Calculator): BigDecimal {
+        val numerator = BigDecimal.valueOf(numerators[register])
+        if (denominators[register] == 1L) return numerator
+        return calculator.divide(numerator, BigDecimal.valueOf(denominators[register]))
+    }
+
+    private fun store(register: Int, numerator: Long, denominator: Long): Boolean {
+        val divisor = gcd(abs(numerator), denominator)
+        val reducedNumerator = numerator / divisor
+        val reducedDenominator = denominator / divisor
+        if (abs(reducedNumerator) > LIMIT || reducedDenominator > LIMIT) return false
+        numerators[register] = reducedNumerator
+        denominators[register] = reducedDenominator
+        return true
+    }
+}
@@ -0,0 +1,42 @@
+package com.android.calculator.calculator.compiler
+
+/**
+ * Functions of a clean expression, by the name [com.android.calculator.calculator.parser.Expression]
+ * gives them, and their code in a [Program].
+ */
+internal object MathFunction {
+    const val SQRT = 0
+    const val FACTORIAL = 1
+    const val LN = 2
+    const val LOG_TWO = 3
+    const val LOG_TEN = 4
+    const val EXP = 5
+    const val SIN = 6
+    const val COS = 7
+    const val TAN = 8
+    const val ARCSIN = 9
+    const val ARCCOS = 10
+    const val ARCTAN = 11
+
+    private val NAMES = arrayOf(
+        "sqrt", "factorial", "ln", "logtwo", "logten", "xp", "sin", "cos", "tan", "arcsi", "arcco", "arcta"
+    )
+
+    /** The code of the function whose name is in [chars] from [start] until [end], or -1 if there is none */
+    fun of(chars: CharArray, start: Int, end: Int): Int {
+        for (code in NAMES.indices) {
+            val name = NAMES[code]
+            if (name.length != end - start) continue
+            var i = 0
+            while (i < name.length && name[i] == chars[start + i]) i++
+            if (i == name.length) return code
+        }
+        return -1
+    }
+
+    /**
+     * Whether the function of [code] only depends on its argument, and not on the angle mode or
+     * the precision of the calculator, so that it can be computed once at compile time.
+     */
+    fun isConstant(code: Int): Boolean = code <= LOG_TEN
+}
@@ -0,0 +1,23 @@
+package com.android.calculator.calculator.compiler
+
+/**
+ * Functions of a square matrix, written with its entries row by row as `det(4;7;2;6)` in a clean
+ * expression, and their code in a [Program].
+ */
+internal object MatrixFunction {
+    const val DETERMINANT = 0
+
+    private val NAMES = arrayOf("det")
+
+    /** The code of the function whose name is in [chars] from [start] until [end], or -1 if there is none */
+    fun of(chars: CharArray, start: Int, end: Int): Int {
+        for (code in NAMES.indices) {
+            val name = NAMES[code]
+            if (name.length != end - start) continue
+            var i = 0
+            while (i < name.length && name[i] == chars[start + i]) i++
+            if (i == name.length) return code
+        }
+        return -1
+    }
+}
@@ -0,0 +1,150 @@
+package com.android.calculator.calculator.compiler
+
+import com.android.calculator.calculator.Calculator
+import com.android.calculator.calculator.syntax_error
+import java.math.BigDecimal
+
+/**
+ * A clean expression compiled by [ExpressionCompiler].
+ *
+ * Every instruction writes its own register, in order, from the registers of its operands, so
+ * that a value computed once can be read by any later instruction. Nothing in a program depends
+ * on the precision or the angle mode: they are given to [execute], and the same program can be
+ * run again with other settings.
+ */
+class Program internal constructor(
+    // STRIDE ints per instruction: the opcode then its operands
+    internal val code: IntArray,
+    internal val constants: Array<BigDecimal>,
+    // Names of the variables, by index
+    internal val variables: Array<String>,
+    // Registers of the elements of each list
+    internal val lists: Array<IntArray>,
+    internal val result: Int
+) {
+
+    internal companion object {
+        const val CONSTANT = 0          // a: index in constants
+        const val SYNTAX_ERROR = 1      // raises the syntax error flag, gives 0
+        const val NEGATE = 2            // a
+        const val ADD = 3               // a + b
+        const val SUBTRACT = 4          // a - b
+        const val MULTIPLY = 5          // a * b
+        const val DIVIDE = 6            // a / b
+        const val MODULO = 7            // a # b
+        const val POWER = 8             // a ^ b
+        const val SQUARE = 9            // a ^ 2
+        const val FUNCTION = 10         // function b of a
+        const val VARIABLE = 11         // a: index in variables
+        const val STATISTIC = 12        // function b of the elements of list a
+        const val MATRIX = 13           // function b of the square matrix whose entries are list a, row by row
+
+        const val OPERAND_COUNT = 2
+        const val STRIDE = OPERAND_COUNT + 1
+    }
+
+    val instructionCount: Int
+        get() = code.size / STRIDE
+
+    // Constants that are exact fractions, converted once
+    private val constantFractions by lazy {
+        Fractions(constants.size).also { fractions ->
+            for (i in constants.indices) fractions.set(i, constants[i])
+        }
+    }
+
+    /** Names of the variables the program reads */
+    val variableNames: List<String>
+        get() = variables.asList()
+
+    /**
+     * The value of the program, with the [values] of its variables by name; reading a variable
+     * that has no value raises the syntax error flag.
+     *
+     * The four basic operations are computed on exact fractions while they stay small, so that
+     * 1/3*3 is 1, and a fraction is only turned into a decimal, rounded to the precision of
+     * [calculator], when another operation or the result needs it.
+     */
+    fun execute(
+        calculator: Calculator,
+        isDegreeModeActivated: Boolean,
+        values: Map<String, BigDecimal> = emptyMap()
+    ): BigDecimal {
+        val registers = arrayOfNulls<BigDecimal>(instructionCount)
+        val fractions = Fractions(instructionCount)
+        var isUndefined = false
+
+        fun value(register: Int): BigDecimal {
+            return registers[register] ?: fractions.toBigDecimal(register, calculator).also { registers[register] = it }
+        }
+
+        var pc = 0
+        for (register in registers.indices) {
+            val a = code[pc + 1]
+            val b = code[pc + 2]
+            when (code[pc]) {
+                CONSTANT -> {
+                    fractions.copy(register, constantFractions, a)
+                    registers[register] = constants[a]
+                }
+                SYNTAX_ERROR -> {
+                    syntax_error = true
+                    registers[register] = BigDecimal.ZERO
+                }
+                NEGATE -> if (!fractions.negate(register, a)) registers[register] = value(a).negate()
+                ADD -> if (!fractions.add(register, a, b)) registers[register] = value(a).add(value(b))
+                SUBTRACT -> if (!fractions.subtract(register, a, b)) registers[register] = value(a).subtract(value(b))
+                MULTIPLY -> if (!fractions.multiply(register, a, b)) registers[register] = value(a).multiply(value(b))
+                DIVIDE -> if (!fractions.divide(register, a, b)) registers[register] = calculator.divide(value(a), value(b))
+                MODULO -> registers[register] = calculator.modulo(value(a), value(b))
+                POWER -> registers[register] = calculator.exponentiation(value(a), value(b))
+                // 0^2 clears the syntax error flag, as any power of 0
+                SQUARE -> if (fractions.isZero(a) || !fractions.multiply(register, a, a)) {
+                    registers[register] = calculator.square(value(a))
+                }
+                FUNCTION -> registers[register] = calculator.function(b, value(a), isDegreeModeActivated)
+                STATISTIC -> registers[register] = calculator.statistic(b, lists[a].map { value(it) })
+                MATRIX -> registers[register] = calculator.matrixFunction(b, lists[a].map { value(it) })
+                VARIABLE -> {
+                    val value = values[variables[a]]
+                    if (value == null) isUndefined = true else fractions.set(register, value)
+                    registers[register] = value ?: BigDecimal.ZERO
+                }
+                else -> throw IllegalStateException("Unknown opcode ${code[pc]}")
+            }
+            pc += STRIDE
+        }
+        // Raised last, so that a power of 0 cannot clear it as it clears a syntax error
+        if (isUndefined) syntax_error = true
+        return value(result)
+    }
+
+    override fun toString(): String {
+        return buildString {
+            for (register in 0 until instructionCount) {
+                val pc = register * STRIDE
+                append('r').append(register).append(" = ")
+                val a = code[pc + 1]
+                val b = code[pc + 2]
+                when (code[pc]) {
+                    CONSTANT -> append(constants[a].toPlainString())
+                    SYNTAX_ERROR -> append("syntax error")
+                    NEGATE -> append("-r").append(a)
+                    ADD -> append('r').append(a).append(" + r").append(b)
+                    SUBTRACT -> append('r').append(a).append(" - r").append(b)
+                    MULTIPLY -> append('r').append(a).append(" * r").append(b)
+                    DIVIDE -> append('r').append(a).append(" / r").append(b)
+                    MODULO -> append('r').append(a).append(" # r").append(b)
+                    POWER -> append('r').append(a).append(" ^ r").append(b)
+                    SQUARE -> append('r').append(a).append(" ^ 2")
+                    FUNCTION -> append("f").append(b).append("(r").append(a).append(')')
+                    VARIABLE -> append(variables[a])
+                    STATISTIC -> lists[a].joinTo(this, "; ", "s$b(", ")") { "r$it" }
+                    MATRIX -> lists[a].joinTo(this, "; ", "m$b(", ")") { "r$it" }
+                }
+                append('\n')
+            }
+            append("result r").append(result)
+        }
+    }
+}
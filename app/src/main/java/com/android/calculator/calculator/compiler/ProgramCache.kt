@@ -0,0 +1,35 @@
+package com.android.calculator.calculator.compiler
+
+/**
+ * Recently compiled expressions.
+ *
+ * The result display evaluates the whole input again on every key, and the history evaluates the
+ * same calculations again when the precision or the angle mode changes: both only pay for the
+ * arithmetic once an expression is compiled.
+ */
+internal object ProgramCache {
+
+    private const val CAPACITY = 128
+
+    // Pasted expressions are not worth keeping in memory
+    private const val MAX_CACHED_LENGTH = 4096
+
+    private val programs = object : LinkedHashMap<String, Program>(CAPACITY, 0.75f, true) {
+        override fun removeEldestEntry(eldest: MutableMap.MutableEntry<String, Program>?): Boolean {
+            return size > CAPACITY
+        }
+    }
+
+    fun get(equation: String): Program {
+        if (equation.length > MAX_CACHED_LENGTH) return ExpressionCompiler.compile(equation)
+        synchronized(programs) {
+            programs[equation]?.let { return it }
+        }
+        // Compiled outside of the lock: at worst two threads compile the same expression
+        val program = ExpressionCompiler.compile(equation)
+        synchronized(programs) {
+            programs[equation] = program
+        }
+        return program
+    }
+}
@@ -0,0 +1,27 @@
+package com.android.calculator.calculator.compiler
+
+/**
+ * Functions of a list of values, written `mean(1;2;3)` in a clean expression, and their code in
+ * a [Program].
+ */
+internal object StatisticFunction {
+    const val SUM = 0
+    const val MEAN = 1
+    const val MEDIAN = 2
+    const val VARIANCE = 3
+    const val STANDARD_DEVIATION = 4
+
+    private val NAMES = arrayOf("sum", "mean", "median", "variance", "stdev")
+
+    /** The code of the function whose name is in [chars] from [start] until [end], or -1 if there is none */
+    fun of(chars: CharArray, start: Int, end: Int): Int {
+        for (code in NAMES.indices) {
+            val name = NAMES[code]
+            if (name.length != end - start) continue
+            var i = 0
+            while (i < name.length && name[i] == chars[start + i]) i++
+            if (i == name.length) return code
+        }
+        return -1
+    }
+}
@@ -0,0 +1,87 @@
+package com.android.calculator.calculator.matrix
+
+import java.math.BigDecimal
+import java.math.BigInteger
+
+/**
+ * Kernels of the exact operations on small matrices of decimals.
+ *
+ * Elimination is fraction free (Bareiss): the rows are first scaled to integers, and every step
+ * then divides exactly by the previous pivot, so that the entries stay integers no larger than
+ * determinants of the matrix. Solving only divides at the very end, once per entry.
+ */
+internal object ExactKernels {
+
+    class Elimination(
+        // Determinant of the scaled matrix, zero if it is singular
+        val determinant: BigInteger,
+        // Right hand sides multiplied by the determinant of the scaled matrix
+        val solutions: Array<BigInteger>,
+        // Power of ten the rows of the matrix were multiplied by, in total
+        val scale: Int
+    )
+
+    fun multiply(a: Array<BigDecimal>, b: Array<BigDecimal>, n: Int, m: Int, p: Int): Array<BigDecimal> {
+        return Array(n * p) { index ->
+            val i = index / p
+            val j = index % p
+            var sum = BigDecimal.ZERO
+            for (k in 0 until m) sum = sum.add(a[i * m + k].multiply(b[k * p + j]))
+            sum
+        }
+    }
+
+    /**
+     * Gauss–Jordan elimination of the n × n matrix [a] together with the n × r matrix [b]: the
+     * solutions are those of a x = b, times the determinant
+     */
+    fun eliminate(a: Array<BigDecimal>, b: Array<BigDecimal>, n: Int, r: Int): Elimination {
+        val width = n + r
+        // Both sides of a row are scaled together, which does not change the solutions
+        val scales = IntArray(n) { i ->
+            var scale = 0
+            for (j in 0 until n) scale = maxOf(scale, a[i * n + j].scale())
+            for (j in 0 until r) scale = maxOf(scale, b[i * r + j].scale())
+            scale
+        }
+        val rows = Array(n) { i ->
+            Array(width) { j ->
+                val value = if (j < n) a[i * n + j] else b[i * r + j - n]
+                value.setScale(scales[i]).unscaledValue()
+            }
+        }
+        val scale = scales.sum()
+
+        var negative = false
+        var previous = BigInteger.ONE
+        for (k in 0 until n) {
+            val pivot = (k until n).firstOrNull { rows[it][k].signum() != 0 }
+                ?: return Elimination(BigInteger.ZERO, emptyArray(), scale)
+            if (pivot != k) {
+                val swapped = rows[k]
+                rows[k] = rows[pivot]
+                rows[pivot] = swapped
+                negative = !negative
+            }
+            val pivotRow = rows[k]
+            for (i in 0 until n) {
+                if (i == k) continue
+                val row = rows[i]
+                val factor = row[k]
+                for (j in 0 until width) {
+                    if (j == k) continue
+                    row[j] = pivotRow[k].multiply(row[j]).subtract(factor.multiply(pivotRow[j])).divide(previous)
+                }
+                row[k] = BigInteger.ZERO
+            }
+            previous = pivotRow[k]
+        }
+        // The diagonal now holds the determinant on every row, and the right hand sides as many times the solutions
+        val determinant = if (negative) previous.negate() else previous
+        val solutions = Array(n * r) { index ->
+            val solution = rows[index / r][n + index % r]
+            if (negative) solution.negate() else solution
+        }
+        return Elimination(determinant, solutions, scale)
+    }
+}
@@ -0,0 +1,72 @@
+package com.android.calculator.calculator.matrix
+
+import com.android.calculator.calculator.statistics.Dataset
+import java.math.BigDecimal
+
+/**
+ * A matrix of numbers, stored by rows in doubles.
+ *
+ * A small matrix also keeps its entries as decimals, as they were written or as computed exactly
+ * by [MatrixCalculator], so that its operations give exact results.
+ */
+class Matrix internal constructor(
+    val rows: Int,
+    val columns: Int,
+    internal val values: DoubleArray,
+    // null when the entries are only known in doubles
+    internal val exact: Array<BigDecimal>?
+) {
+
+    companion object {
+        /** The matrix of the rows of [text], written as the columns of a [Dataset], or null if it is not one */
+        fun parse(text: String, decimalSeparator: Char = '.'): Matrix? {
+            val dataset = Dataset.parse(text, decimalSeparator) ?: return null
+            val rows = dataset.rowCount
+            val columns = dataset.columnCount
+            val values = DoubleArray(rows * columns)
+            for (column in 0 until columns) {
+                val data = dataset.column(column)
+                for (row in 0 until rows) values[row * columns + column] = data[row]
+            }
+            if (maxOf(rows, columns) > MatrixCalculator.EXACT_MAX_SIZE) return Matrix(rows, columns, values, null)
+            val exact = arrayOfNulls<BigDecimal>(rows * columns)
+            for (column in 0 until columns) {
+                for ((row, value) in dataset.exactColumn(column).withIndex()) exact[row * columns + column] = value
+            }
+            @Suppress("UNCHECKED_CAST")
+            return Matrix(rows, columns, values, exact as Array<BigDecimal>)
+        }
+
+        fun of(rows: List<List<BigDecimal>>): Matrix {
+            require(rows.isNotEmpty() && rows.all { it.size == rows[0].size && it.isNotEmpty() }) { "Not a matrix" }
+            val exact = rows.flatten().toTypedArray()
+            val values = DoubleArray(exact.size) { exact[it].toDouble() }
+            return Matrix(rows.size, rows[0].size, values, exact.takeIf { maxOf(rows.size, rows[0].size) <= MatrixCalculator.EXACT_MAX_SIZE })
+        }
+
+        fun identity(size: Int): Matrix {
+            val values = DoubleArray(size * size)
+            for (i in 0 until size) values[i * size + i] = 1.0
+            val exact = if (size <= MatrixCalculator.EXACT_MAX_SIZE) {
+                Array(size * size) { if (it % (size + 1) == 0) BigDecimal.ONE else BigDecimal.ZERO }
+            } else {
+                null
+            }
+            return Matrix(size, size, values, exact)
+        }
+    }
+
+    val isSquare: Boolean
+        get() = rows == columns
+
+    operator fun get(row: Int, column: Int): Double = values[row * columns + column]
+
+    /** The entry as a decimal: exact if it is known exactly, the decimal of its double otherwise */
+    fun decimal(row: Int, column: Int): BigDecimal {
+        return exact?.get(row * columns + column) ?: BigDecimal.valueOf(values[row * columns + column])
+    }
+
+    override fun toString(): String {
+        return (0 until rows).joinToString("\n") { row -> (0 until columns).joinToString("\t") { decimal(row, it).toPlainString() } }
+    }
+}
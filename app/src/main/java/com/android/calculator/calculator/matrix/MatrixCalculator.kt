@@ -0,0 +1,129 @@
+package com.android.calculator.calculator.matrix
+
+import com.android.calculator.calculator.CalculatorExecutor
+import com.android.calculator.calculator.domain_error
+import com.android.calculator.calculator.is_infinity
+import com.android.calculator.calculator.syntax_error
+import java.math.BigDecimal
+import java.math.RoundingMode
+import java.util.concurrent.ExecutorService
+import kotlin.math.abs
+
+/**
+ * Matrix operations of the calculator: product, determinant, inverse and solving a system.
+ *
+ * Operations on matrices of at most [EXACT_MAX_SIZE] rows and columns whose entries are known
+ * exactly are done exactly in decimals, rounding only the divisions that do not terminate to
+ * [numberPrecisionDecimal] digits. Larger ones are done in doubles by [MatrixKernels], split
+ * across [executor] when they are large enough.
+ *
+ * Like [com.android.calculator.calculator.Calculator], the errors are reported by the error flags
+ * of the thread, and an operation with an error returns null.
+ */
+class MatrixCalculator(
+    private val numberPrecisionDecimal: Int,
+    private val executor: ExecutorService = CalculatorExecutor.shared
+) {
+
+    companion object {
+        const val EXACT_MAX_SIZE = 12
+        private const val EPSILON = 2.220446049250313E-16
+    }
+
+    fun multiply(a: Matrix, b: Matrix): Matrix? {
+        if (a.columns != b.rows) {
+            syntax_error = true
+            return null
+        }
+        if (a.exact != null && b.exact != null) {
+            val exact = ExactKernels.multiply(a.exact, b.exact, a.rows, a.columns, b.columns)
+            return Matrix(a.rows, b.columns, DoubleArray(exact.size) { exact[it].toDouble() }, exact)
+        }
+        val values = DoubleArray(a.rows * b.columns)
+        MatrixKernels.multiplyAdd(
+            1.0,
+            a.values, 0, a.columns,
+            b.values, 0, b.columns,
+            values, 0, b.columns,
+            a.rows, a.columns, b.columns,
+            executor
+        )
+        return finite(Matrix(a.rows, b.columns, values, null))
+    }
+
+    fun determinant(a: Matrix): BigDecimal? {
+        if (!a.isSquare) {
+            syntax_error = true
+            return null
+        }
+        if (a.exact != null) {
+            val elimination = ExactKernels.eliminate(a.exact, emptyArray(), a.rows, 0)
+            return BigDecimal(elimination.determinant, elimination.scale).stripTrailingZeros()
+        }
+        val lu = a.values.copyOf()
+        var determinant = MatrixKernels.factor(lu, a.rows, IntArray(a.rows), executor).toDouble()
+        for (i in 0 until a.rows) determinant *= lu[i * a.rows + i]
+        if (!determinant.isFinite()) {
+            is_infinity = true
+            return null
+        }
+        return BigDecimal.valueOf(determinant)
+    }
+
+    fun inverse(a: Matrix): Matrix? {
+        if (!a.isSquare) {
+            syntax_error = true
+            return null
+        }
+        return solve(a, Matrix.identity(a.rows))
+    }
+
+    /** The matrix x such that a x = b, for a square matrix a that is not singular */
+    fun solve(a: Matrix, b: Matrix): Matrix? {
+        if (!a.isSquare || a.rows != b.rows) {
+            syntax_error = true
+            return null
+        }
+        val n = a.rows
+        val r = b.columns
+        if (a.exact != null && b.exact != null) {
+            val elimination = ExactKernels.eliminate(a.exact, b.exact, n, r)
+            if (elimination.determinant.signum() == 0) {
+                domain_error = true
+                return null
+            }
+            val determinant = BigDecimal(elimination.determinant)
+            val exact = Array(n * r) { divide(BigDecimal(elimination.solutions[it]), determinant) }
+            return Matrix(n, r, DoubleArray(exact.size) { exact[it].toDouble() }, exact)
+        }
+
+        val lu = a.values.copyOf()
+        val pivots = IntArray(n)
+        MatrixKernels.factor(lu, n, pivots, executor)
+        // Singular as far as doubles can tell: a pivot lost in the rounding of the others
+        var largest = 0.0
+        for (value in a.values) largest = maxOf(largest, abs(value))
+        for (i in 0 until n) {
+            if (abs(lu[i * n + i]) <= n * EPSILON * largest) {
+                domain_error = true
+                return null
+            }
+        }
+        val values = b.values.copyOf()
+        MatrixKernels.solve(lu, n, pivots, values, r)
+        return finite(Matrix(n, r, values, null))
+    }
+
+    // Exact when the quotient terminates, rounded to the precision of the calculator otherwise
+    private fun divide(x: BigDecimal, y: BigDecimal): BigDecimal {
+        if (x.signum() == 0) return BigDecimal.ZERO
+        val quotient = x.divide(y, maxOf(numberPrecisionDecimal, x.scale()), RoundingMode.HALF_EVEN)
+        return quotient.stripTrailingZeros()
+    }
+
+    private fun finite(matrix: Matrix): Matrix? {
+        if (matrix.values.all { it.isFinite() }) return matrix
+        is_infinity = true
+        return null
+    }
+}
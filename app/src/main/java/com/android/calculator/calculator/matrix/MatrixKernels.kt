@@ -0,0 +1,216 @@
+package com.android.calculator.calculator.matrix
+
+import java.util.concurrent.Callable
+import java.util.concurrent.ExecutorService
+import kotlin.math.abs
+import kotlin.math.min
+
+/**
+ * Kernels of the double matrix operations, on matrices stored by rows in arrays.
+ *
+ * The products are computed by blocks of [BLOCK] × [BLOCK] entries, three of which (a block of
+ * each operand and of the result) fit together in a 32 KB L1 cache, and within a block by tiles of
+ * 4 × 4 entries of the result, kept in local variables for the compiler to hold them in registers
+ * across the whole inner loop. LU factorization is done by panels of [BLOCK] columns, so that most
+ * of its work is the update of the trailing matrix by such a product.
+ */
+internal object MatrixKernels {
+
+    const val BLOCK = 32
+    private const val TILE = 4
+    // Rows of result below which a product is not split across threads
+    private const val MIN_PARALLEL_ROWS = 128
+
+    /**
+     * c += sign × a × b for an n × m matrix a and an m × p matrix b, each given by the array
+     * holding it, the index of its first entry and the distance between two of its rows
+     */
+    fun multiplyAdd(
+        sign: Double,
+        a: DoubleArray, aOffset: Int, aStride: Int,
+        b: DoubleArray, bOffset: Int, bStride: Int,
+        c: DoubleArray, cOffset: Int, cStride: Int,
+        n: Int, m: Int, p: Int,
+        executor: ExecutorService?
+    ) {
+        if (executor == null || n < MIN_PARALLEL_ROWS) {
+            multiplyAddRows(sign, a, aOffset, aStride, b, bOffset, bStride, c, cOffset, cStride, 0, n, m, p)
+            return
+        }
+        // Whole blocks of rows for each task, one task per processor
+        val threads = minOf(Runtime.getRuntime().availableProcessors(), n / BLOCK).coerceAtLeast(1)
+        val rowsPerTask = (n / threads + BLOCK - 1) / BLOCK * BLOCK
+        val tasks = (0 until n step rowsPerTask).map { from ->
+            Callable {
+                multiplyAddRows(sign, a, aOffset, aStride, b, bOffset, bStride, c, cOffset, cStride, from, min(n, from + rowsPerTask), m, p)
+            }
+        }
+        executor.invokeAll(tasks).forEach { it.get() }
+    }
+
+    private fun multiplyAddRows(
+        sign: Double,
+        a: DoubleArray, aOffset: Int, aStride: Int,
+        b: DoubleArray, bOffset: Int, bStride: Int,
+        c: DoubleArray, cOffset: Int, cStride: Int,
+        rowFrom: Int, rowTo: Int, m: Int, p: Int
+    ) {
+        for (k0 in 0 until m step BLOCK) {
+            val k1 = min(m, k0 + BLOCK)
+            for (j0 in 0 until p step BLOCK) {
+                val j1 = min(p, j0 + BLOCK)
+                for (i0 in rowFrom until rowTo step BLOCK) {
+                    val i1 = min(rowTo, i0 + BLOCK)
+                    var i = i0
+                    while (i + TILE <= i1) {
+                        var j = j0
+                        while (j + TILE <= j1) {
+                            tile(sign, a, aOffset + i * aStride, aStride, b, bOffset + j, bStride, c, cOffset + i * cStride + j, cStride, k0, k1)
+                            j += TILE
+                        }
+                        // Columns left over at the right of the block
+                        for (row in i until i + TILE) edge(sign, a, aOffset + row * aStride, b, bOffset, bStride, c, cOffset + row * cStride, k0, k1, j, j1)
+                        i += TILE
+                    }
+                    // Rows left over at the bottom of the block
+                    for (row in i until i1) edge(sign, a, aOffset + row * aStride, b, bOffset, bStride, c, cOffset + row * cStride, k0, k1, j0, j1)
+                }
+            }
+        }
+    }
+
+    // A 4 × 4 tile of c, over the rows k0 until k1 of b
+    private fun tile(
+        sign: Double,
+        a: DoubleArray, a0: Int, aStride: Int,
+        b: DoubleArray, b0: Int, bStride: Int,
+        c: DoubleArray, c0: Int, cStride: Int,
+        k0: Int, k1: Int
+    ) {
+        var c00 = 0.0; var c01 = 0.0; var c02 = 0.0; var c03 = 0.0
+        var c10 = 0.0; var c11 = 0.0; var c12 = 0.0; var c13 = 0.0
+        var c20 = 0.0; var c21 = 0.0; var c22 = 0.0; var c23 = 0.0
+        var c30 = 0.0; var c31 = 0.0; var c32 = 0.0; var c33 = 0.0
+        val a1 = a0 + aStride
+        val a2 = a1 + aStride
+        val a3 = a2 + aStride
+        for (k in k0 until k1) {
+            val bk = b0 + k * bStride
+            val b0k = b[bk]
+            val b1k = b[bk + 1]
+            val b2k = b[bk + 2]
+            val b3k = b[bk + 3]
+            val a0k = a[a0 + k]
+            c00 += a0k * b0k; c01 += a0k * b1k; c02 += a0k * b2k; c03 += a0k * b3k
+            val a1k = a[a1 + k]
+            c10 += a1k * b0k; c11 += a1k * b1k; c12 += a1k * b2k; c13 += a1k * b3k
+            val a2k = a[a2 + k]
+            c20 += a2k * b0k; c21 += a2k * b1k; c22 += a2k * b2k; c23 += a2k * b3k
+            val a3k = a[a3 + k]
+            c30 += a3k * b0k; c31 += a3k * b1k; c32 += a3k * b2k; c33 += a3k * b3k
+        }
+        var ci = c0
+        c[ci] += sign * c00; c[ci + 1] += sign * c01; c[ci + 2] += sign * c02; c[ci + 3] += sign * c03
+        ci += cStride
+        c[ci] += sign * c10; c[ci + 1] += sign * c11; c[ci + 2] += sign * c12; c[ci + 3] += sign * c13
+        ci += cStride
+        c[ci] += sign * c20; c[ci + 1] += sign * c21; c[ci + 2] += sign * c22; c[ci + 3] += sign * c23
+        ci += cStride
+        c[ci] += sign * c30; c[ci + 1] += sign * c31; c[ci + 2] += sign * c32; c[ci + 3] += sign * c33
+    }
+
+    // The columns j0 until j1 of one row of c, over the rows k0 until k1 of b
+    private fun edge(
+        sign: Double,
+        a: DoubleArray, aRow: Int,
+        b: DoubleArray, bOffset: Int, bStride: Int,
+        c: DoubleArray, cRow: Int,
+        k0: Int, k1: Int, j0: Int, j1: Int
+    ) {
+        for (k in k0 until k1) {
+            val aik = sign * a[aRow + k]
+            val bk = bOffset + k * bStride
+            for (j in j0 until j1) c[cRow + j] += aik * b[bk + j]
+        }
+    }
+
+    /**
+     * Factor the n × n matrix [lu] in place into L U with partial pivoting: the rows swapped at
+     * step k are written to [pivots], L below the diagonal, with ones on it, and U above.
+     * Returns the sign of the permutation.
+     */
+    fun factor(lu: DoubleArray, n: Int, pivots: IntArray, executor: ExecutorService?): Int {
+        var sign = 1
+        for (k0 in 0 until n step BLOCK) {
+            val k1 = min(n, k0 + BLOCK)
+            // The panel of columns k0 until k1, unblocked
+            for (k in k0 until k1) {
+                var pivot = k
+                for (i in k + 1 until n) if (abs(lu[i * n + k]) > abs(lu[pivot * n + k])) pivot = i
+                pivots[k] = pivot
+                if (pivot != k) {
+                    sign = -sign
+                    for (j in 0 until n) {
+                        val swapped = lu[k * n + j]
+                        lu[k * n + j] = lu[pivot * n + j]
+                        lu[pivot * n + j] = swapped
+                    }
+                }
+                val diagonal = lu[k * n + k]
+                // The column is already zero below a zero pivot
+                if (diagonal == 0.0) continue
+                for (i in k + 1 until n) {
+                    val l = lu[i * n + k] / diagonal
+                    lu[i * n + k] = l
+                    if (l != 0.0) for (j in k + 1 until k1) lu[i * n + j] -= l * lu[k * n + j]
+                }
+            }
+            if (k1 == n) break
+            // U of the rows of the panel, right of it
+            for (k in k0 until k1) {
+                for (i in k + 1 until k1) {
+                    val l = lu[i * n + k]
+                    if (l != 0.0) for (j in k1 until n) lu[i * n + j] -= l * lu[k * n + j]
+                }
+            }
+            // Trailing matrix, minus L below the panel times U right of it
+            multiplyAdd(
+                -1.0,
+                lu, k1 * n + k0, n,
+                lu, k0 * n + k1, n,
+                lu, k1 * n + k1, n,
+                n - k1, k1 - k0, n - k1,
+                executor
+            )
+        }
+        return sign
+    }
+
+    /** Solve L U x = P b in place in the n × r matrix [b], from the factorization of [factor] */
+    fun solve(lu: DoubleArray, n: Int, pivots: IntArray, b: DoubleArray, r: Int) {
+        for (k in 0 until n) {
+            val pivot = pivots[k]
+            if (pivot == k) continue
+            for (j in 0 until r) {
+                val swapped = b[k * r + j]
+                b[k * r + j] = b[pivot * r + j]
+                b[pivot * r + j] = swapped
+            }
+        }
+        // Forward substitution with L, then back substitution with U, a whole row of b at a time
+        for (i in 0 until n) {
+            for (k in 0 until i) {
+                val l = lu[i * n + k]
+                if (l != 0.0) for (j in 0 until r) b[i * r + j] -= l * b[k * r + j]
+            }
+        }
+        for (i in n - 1 downTo 0) {
+            for (k in i + 1 until n) {
+                val u = lu[i * n + k]
+                if (u != 0.0) for (j in 0 until r) b[i * r + j] -= u * b[k * r + j]
+            }
+            val diagonal = lu[i * n + i]
+            for (j in 0 until r) b[i * r + j] /= diagonal
+        }
+    }
+}
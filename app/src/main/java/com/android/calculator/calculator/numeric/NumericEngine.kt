@@ -0,0 +1,292 @@
+package com.android.calculator.calculator.numeric
+
+import com.android.calculator.calculator.CalculatorExecutor
+import java.math.BigDecimal
+import java.util.PriorityQueue
+import java.util.concurrent.ExecutorService
+import kotlin.math.abs
+import kotlin.math.max
+import kotlin.math.min
+import kotlin.math.withSign
+
+/**
+ * Solving for x and definite integrals of a clean expression of x, in doubles.
+ *
+ * Both run the compiled expression through the batched kernel of the plot: the brackets of a
+ * root are searched on a grid and the subintervals of an integral refined by whole rounds, each
+ * one evaluated as a single batch, split across [executor] when it is large. Every computation
+ * stops at the precision it is asked for, or at its [Budget], or when its [Cancellation] is
+ * cancelled, and then gives its best estimate so far.
+ */
+class NumericEngine(private val executor: ExecutorService = CalculatorExecutor.shared) {
+
+    companion object {
+        // Grid on which a sign change is searched for
+        private const val BRACKET_SAMPLES = 4096
+        private const val INITIAL_INTERVALS = 8
+        // Subintervals with the largest error bisected per round of integration
+        private const val REFINED_PER_ROUND = 64
+        private const val EPSILON = 2.220446049250313E-16
+
+        // 15 point Gauss–Kronrod rule: Kronrod nodes, the odd ones being the 7 point Gauss nodes
+        private val KRONROD_NODES = doubleArrayOf(
+            0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+            0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+            0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+            0.207784955007898467600689403773245, 0.0
+        )
+        private val KRONROD_WEIGHTS = doubleArrayOf(
+            0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+            0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+            0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+            0.204432940075298892414161999234649, 0.209482141084727828012999174891714
+        )
+        private val GAUSS_WEIGHTS = doubleArrayOf(
+            0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+            0.381830050505118944950369775488975, 0.417959183673469387755102040816327
+        )
+        private const val POINTS_PER_INTERVAL = 15
+    }
+
+    /** Limits of a computation: evaluations of the expression, and time */
+    data class Budget(
+        val maxEvaluations: Int = 200_000,
+        val timeoutMillis: Long = 2_000
+    )
+
+    /** Cancels a computation from another thread, such as when the input changes */
+    class Cancellation {
+        @Volatile
+        var isCancelled = false
+            private set
+
+        fun cancel() {
+            isCancelled = true
+        }
+    }
+
+    enum class Status {
+        CONVERGED,
+        // No sign change on the interval, or only across poles
+        NO_ROOT,
+        // The value is not finite, or not defined on the whole interval
+        DIVERGED,
+        BUDGET_EXHAUSTED,
+        CANCELLED,
+        SYNTAX_ERROR
+    }
+
+    data class Result(
+        val value: Double,
+        val errorEstimate: Double,
+        val evaluations: Int,
+        val status: Status
+    )
+
+    /**
+     * A root of [equation] in x between [from] and [to]: the first sign change found on a grid
+     * is refined with Brent's method until it is known within [tolerance].
+     */
+    fun solve(
+        equation: String,
+        isDegreeModeActivated: Boolean,
+        from: Double,
+        to: Double,
+        tolerance: Double = 1.0E-12,
+        budget: Budget = Budget(),
+        cancellation: Cancellation = Cancellation(),
+        values: Map<String, BigDecimal> = emptyMap()
+    ): Result {
+        val function = ParallelFunction(equation, isDegreeModeActivated, values, executor, budget, cancellation)
+        if (function.hasSyntaxError) return Result(Double.NaN, Double.NaN, 0, Status.SYNTAX_ERROR)
+
+        val low = min(from, to)
+        val step = (max(from, to) - low) / BRACKET_SAMPLES
+        val xs = DoubleArray(BRACKET_SAMPLES + 1) { low + it * step }
+        val ys = DoubleArray(xs.size)
+        if (!function.evaluate(xs, ys, xs.size)) return stopped(function, Double.NaN, Double.NaN)
+
+        for (i in xs.indices) {
+            if (ys[i] == 0.0) return Result(xs[i], 0.0, function.evaluations, Status.CONVERGED)
+            if (i == 0 || !ys[i - 1].isFinite() || !ys[i].isFinite() || (ys[i - 1] > 0) == (ys[i] > 0)) continue
+            val root = brent(function, xs[i - 1], xs[i], ys[i - 1], ys[i], tolerance)
+            if (root.status != Status.CONVERGED) return root
+            // A sign change across a pole, such as tan at 90°, converges where the value is huge
+            val value = function.evaluate(root.value)
+            if (function.stopStatus != null) return stopped(function, root.value, root.errorEstimate)
+            if (abs(value) <= abs(ys[i - 1]) + abs(ys[i])) return root.copy(evaluations = function.evaluations)
+        }
+        return Result(Double.NaN, Double.NaN, function.evaluations, Status.NO_ROOT)
+    }
+
+    /**
+     * The integral of [equation] in x from [from] to [to], by adaptive 15 point Gauss–Kronrod
+     * quadrature, until its estimated error is below [tolerance], relative to the value when it
+     * is larger than 1.
+     */
+    fun integrate(
+        equation: String,
+        isDegreeModeActivated: Boolean,
+        from: Double,
+        to: Double,
+        tolerance: Double = 1.0E-10,
+        budget: Budget = Budget(),
+        cancellation: Cancellation = Cancellation(),
+        values: Map<String, BigDecimal> = emptyMap()
+    ): Result {
+        val function = ParallelFunction(equation, isDegreeModeActivated, values, executor, budget, cancellation)
+        if (function.hasSyntaxError) return Result(Double.NaN, Double.NaN, 0, Status.SYNTAX_ERROR)
+        if (from == to) return Result(0.0, 0.0, 0, Status.CONVERGED)
+
+        // Subintervals by decreasing error
+        val intervals = PriorityQueue<Interval>(compareByDescending { it.error })
+        val width = (to - from) / INITIAL_INTERVALS
+        var pending = List(INITIAL_INTERVALS) { i ->
+            Interval(from + i * width, if (i == INITIAL_INTERVALS - 1) to else from + (i + 1) * width)
+        }
+        var parents = emptyList<Interval>()
+        while (true) {
+            if (!gaussKronrod(function, pending)) {
+                // The intervals that were being split still give their estimate
+                val estimate = intervals + parents
+                return stopped(function, estimate.sumOf { it.value }, estimate.sumOf { it.error })
+            }
+            intervals.addAll(pending)
+            val total = intervals.sumOf { it.value }
+            val totalError = intervals.sumOf { it.error }
+            if (!total.isFinite()) return Result(total, Double.POSITIVE_INFINITY, function.evaluations, Status.DIVERGED)
+            if (totalError <= tolerance * max(1.0, abs(total))) {
+                return Result(total, totalError, function.evaluations, Status.CONVERGED)
+            }
+
+            // Bisect the worst subintervals
+            val worstIntervals = ArrayList<Interval>(REFINED_PER_ROUND)
+            val refined = ArrayList<Interval>(REFINED_PER_ROUND * 2)
+            while (worstIntervals.size < REFINED_PER_ROUND && intervals.isNotEmpty()) {
+                val worst = intervals.poll()!!
+                worstIntervals.add(worst)
+                val middle = (worst.from + worst.to) / 2
+                // Too narrow to be split any further in doubles
+                if (middle <= min(worst.from, worst.to) || middle >= max(worst.from, worst.to)) {
+                    return Result(total, totalError, function.evaluations, Status.DIVERGED)
+                }
+                refined.add(Interval(worst.from, middle))
+                refined.add(Interval(middle, worst.to))
+            }
+            parents = worstIntervals
+            pending = refined
+        }
+    }
+
+    private class Interval(val from: Double, val to: Double) {
+        var value = 0.0
+        var error = 0.0
+    }
+
+    // Evaluate the rule on all the intervals as a single batch
+    private fun gaussKronrod(function: ParallelFunction, intervals: List<Interval>): Boolean {
+        val count = intervals.size * POINTS_PER_INTERVAL
+        val xs = DoubleArray(count)
+        val ys = DoubleArray(count)
+        for ((index, interval) in intervals.withIndex()) {
+            val center = (interval.from + interval.to) / 2
+            val halfWidth = (interval.to - interval.from) / 2
+            val offset = index * POINTS_PER_INTERVAL
+            for (k in 0 until 7) {
+                xs[offset + 2 * k] = center - halfWidth * KRONROD_NODES[k]
+                xs[offset + 2 * k + 1] = center + halfWidth * KRONROD_NODES[k]
+            }
+            xs[offset + 14] = center
+        }
+        if (!function.evaluate(xs, ys, count)) return false
+
+        for ((index, interval) in intervals.withIndex()) {
+            val halfWidth = (interval.to - interval.from) / 2
+            val offset = index * POINTS_PER_INTERVAL
+            var kronrod = KRONROD_WEIGHTS[7] * ys[offset + 14]
+            var gauss = GAUSS_WEIGHTS[3] * ys[offset + 14]
+            for (k in 0 until 7) {
+                val pair = ys[offset + 2 * k] + ys[offset + 2 * k + 1]
+                kronrod += KRONROD_WEIGHTS[k] * pair
+                if (k % 2 == 1) gauss += GAUSS_WEIGHTS[k / 2] * pair
+            }
+            interval.value = kronrod * halfWidth
+            val error = abs((kronrod - gauss) * halfWidth)
+            // An interval where the function is not defined everywhere is refined first
+            interval.error = if (error.isNaN()) Double.POSITIVE_INFINITY else error
+            if (interval.value.isNaN()) interval.value = 0.0
+        }
+        return true
+    }
+
+    // Brent's method on a bracket [a, b] where f changes sign
+    private fun brent(function: ParallelFunction, from: Double, to: Double, fromValue: Double, toValue: Double, tolerance: Double): Result {
+        var a = from
+        var b = to
+        var fa = fromValue
+        var fb = toValue
+        var c = b
+        var fc = fb
+        var d = 0.0
+        var e = 0.0
+        while (true) {
+            if ((fb > 0 && fc > 0) || (fb < 0 && fc < 0)) {
+                c = a
+                fc = fa
+                d = b - a
+                e = d
+            }
+            if (abs(fc) < abs(fb)) {
+                a = b
+                b = c
+                c = a
+                fa = fb
+                fb = fc
+                fc = fa
+            }
+            val tolerance1 = 2 * EPSILON * abs(b) + tolerance / 2
+            val middle = (c - b) / 2
+            if (abs(middle) <= tolerance1 || fb == 0.0) {
+                return Result(b, abs(middle), function.evaluations, Status.CONVERGED)
+            }
+            if (abs(e) >= tolerance1 && abs(fa) > abs(fb)) {
+                // Inverse quadratic interpolation, or secant when only two points are known
+                val s = fb / fa
+                var p: Double
+                var q: Double
+                if (a == c) {
+                    p = 2 * middle * s
+                    q = 1 - s
+                } else {
+                    val r = fb / fc
+                    q = fa / fc
+                    p = s * (2 * middle * q * (q - r) - (b - a) * (r - 1))
+                    q = (q - 1) * (r - 1) * (s - 1)
+                }
+                if (p > 0) q = -q
+                p = abs(p)
+                if (2 * p < min(3 * middle * q - abs(tolerance1 * q), abs(e * q))) {
+                    e = d
+                    d = p / q
+                } else {
+                    // Bisection
+                    d = middle
+                    e = d
+                }
+            } else {
+                d = middle
+                e = d
+            }
+            a = b
+            fa = fb
+            b += if (abs(d) > tolerance1) d else tolerance1.withSign(middle)
+            fb = function.evaluate(b)
+            if (function.stopStatus != null) return stopped(function, b, abs(middle))
+            if (fb.isNaN()) return Result(b, abs(middle), function.evaluations, Status.DIVERGED)
+        }
+    }
+
+    private fun stopped(function: ParallelFunction, value: Double, errorEstimate: Double): Result {
+        return Result(value, errorEstimate, function.evaluations, function.stopStatus ?: Status.CANCELLED)
+    }
+}
@@ -0,0 +1,89 @@
+package com.android.calculator.calculator.numeric
+
+import com.android.calculator.plot.PlotKernel
+import java.math.BigDecimal
+import java.util.concurrent.Callable
+import java.util.concurrent.ConcurrentLinkedQueue
+import java.util.concurrent.ExecutorService
+
+/**
+ * A function of x evaluated in doubles for [NumericEngine], within a budget.
+ *
+ * Large batches are split into chunks evaluated in parallel on [executor], each chunk by its own
+ * [PlotKernel] taken from a pool, since a kernel is only used by one thread at a time.
+ */
+internal class ParallelFunction(
+    private val equation: String,
+    private val isDegreeModeActivated: Boolean,
+    private val values: Map<String, BigDecimal>,
+    private val executor: ExecutorService,
+    private val budget: NumericEngine.Budget,
+    private val cancellation: NumericEngine.Cancellation
+) {
+
+    companion object {
+        // Below this, a batch is evaluated on the calling thread
+        private const val MIN_CHUNK_SIZE = PlotKernel.BATCH_SIZE * 2
+    }
+
+    private val kernels = ConcurrentLinkedQueue<PlotKernel>()
+    private val deadline = System.nanoTime() + budget.timeoutMillis * 1_000_000
+
+    val hasSyntaxError: Boolean = withKernel { it.hasSyntaxError }
+
+    var evaluations = 0
+        private set
+
+    /** Why the last evaluation was refused, null while the budget allows more */
+    var stopStatus: NumericEngine.Status? = null
+        private set
+
+    /**
+     * Write f(xs[i]) to ys[i] for i in 0 until [count], unless the computation was cancelled or
+     * is out of budget, in which case nothing is written and false is returned
+     */
+    fun evaluate(xs: DoubleArray, ys: DoubleArray, count: Int): Boolean {
+        if (!reserve(count)) return false
+        val chunkCount = minOf(count / MIN_CHUNK_SIZE, Runtime.getRuntime().availableProcessors())
+        if (chunkCount <= 1) {
+            withKernel { it.evaluate(xs, ys, 0, count) }
+            return true
+        }
+        val chunkSize = (count + chunkCount - 1) / chunkCount
+        val tasks = (0 until chunkCount).map { chunk ->
+            Callable {
+                val from = chunk * chunkSize
+                withKernel { it.evaluate(xs, ys, from, minOf(count, from + chunkSize)) }
+            }
+        }
+        executor.invokeAll(tasks).forEach { it.get() }
+        return true
+    }
+
+    /** f(x), or NaN if the computation was cancelled or is out of budget */
+    fun evaluate(x: Double): Double {
+        if (!reserve(1)) return Double.NaN
+        return withKernel { it.evaluate(x) }
+    }
+
+    private fun reserve(count: Int): Boolean {
+        stopStatus = when {
+            cancellation.isCancelled -> NumericEngine.Status.CANCELLED
+            evaluations + count > budget.maxEvaluations -> NumericEngine.Status.BUDGET_EXHAUSTED
+            System.nanoTime() > deadline -> NumericEngine.Status.BUDGET_EXHAUSTED
+            else -> null
+        }
+        if (stopStatus != null) return false
+        evaluations += count
+        return true
+    }
+
+    private inline fun <T> withKernel(block: (PlotKernel) -> T): T {
+        val kernel = kernels.poll() ?: PlotKernel.compile(equation, isDegreeModeActivated, values)
+        try {
+            return block(kernel)
+        } finally {
+            kernels.offer(kernel)
+        }
+    }
+}
@@ -1,14 +1,14 @@
 package com.android.calculator.calculator.parser
 
 import com.android.calculator.calculator.syntax_error
-import com.android.calculator.obfuscation.ObfuscationManager
+import com.android.calculator.obfuscation.HotPathObfuscation
 
 class Expression {
 
     fun getCleanExpression(calculation: String, decimalSeparatorSymbol: String, groupingSeparatorSymbol: String): String {
         // Apply obfuscation to expression parsing
-        return ObfuscationManager.StaticObfuscation.executeWithObfuscationReturn {
-            ObfuscationManager.StaticObfuscation.obfuscatedBranch {
+        return HotPathObfuscation.guarded {
+            HotPathObfuscation.branch {
                 var cleanCalculation = replaceSymbolsFromCalculation(calculation, decimalSeparatorSymbol, groupingSeparatorSymbol)
                 cleanCalculation = addMultiply(cleanCalculation)
                 if (cleanCalculation.contains('√')) {
@@ -1,133 +1,105 @@
 package com.android.calculator.calculator.parser
 
 object NumberFormatter {
+
+    // Formatting runs on every display update: reuse one builder per thread
+    private const val MAX_RETAINED_CAPACITY = 64 * 1024
+    private val buffers = ThreadLocal.withInitial { StringBuilder() }
+
     fun format(
-        text: String,
+        text: CharSequence,
         decimalSeparatorSymbol: String,
         groupingSeparatorSymbol: String,
         numberingSystem: NumberingSystem = NumberingSystem.INTERNATIONAL
     ): String {
-        val textNoSeparator = removeSeparators(text, groupingSeparatorSymbol)
-        val numbersList = extractString(textNoSeparator, decimalSeparatorSymbol)
-        val numbersWithSeparators =
-            addSeparators(numbersList, decimalSeparatorSymbol, groupingSeparatorSymbol, numberingSystem)
-
-        val newString = StringBuilder()
-
-        for (item in numbersWithSeparators) {
-            newString.append(item)
+        val buffer = buffers.get()!!
+        buffer.setLength(0)
+        formatTo(buffer, text, decimalSeparatorSymbol, groupingSeparatorSymbol, numberingSystem)
+        val formatted = buffer.toString()
+        if (buffer.capacity() > MAX_RETAINED_CAPACITY) {
+            buffer.setLength(0)
+            buffer.trimToSize()
         }
-
-        return newString.toString()
+        return formatted
     }
 
-    // This function was changed to extract all elements from the input string, not just numbers.
-    // This returns a list of all elements. Once the numbers have had separators added, a new string
-    // can be constructed from the list.
-    private fun extractString(text: String, decimalSeparatorSymbol: String): List<String> {
-        val result = mutableListOf<String>()
-        var currentNumber = StringBuilder()
+    /**
+     * Append [text] to [out] with its numbers grouped again, in a single pass over the text.
+     *
+     * Grouping separators already in the text are dropped. A number is a run of digits and
+     * decimal separators; only the digits before its first decimal separator are grouped, by
+     * three, or by three then by two with the Indian numbering system.
+     */
+    fun formatTo(
+        out: StringBuilder,
+        text: CharSequence,
+        decimalSeparatorSymbol: String,
+        groupingSeparatorSymbol: String,
+        numberingSystem: NumberingSystem = NumberingSystem.INTERNATIONAL
+    ) {
+        // Separators are a single character in every locale, but stay correct otherwise
+        val source = if (groupingSeparatorSymbol.length > 1) {
+            text.toString().replace(groupingSeparatorSymbol, "")
+        } else {
+            text
+        }
+        val groupingSeparator = if (groupingSeparatorSymbol.length == 1) groupingSeparatorSymbol[0] else null
+        val decimalSeparator = decimalSeparatorSymbol.single()
+        val isIndian = numberingSystem == NumberingSystem.INDIAN
+        out.ensureCapacity(out.length + source.length + source.length / 3)
+
+        var i = 0
+        while (i < source.length) {
+            val char = source[i]
+            if (char == groupingSeparator) {
+                i++
+                continue
+            }
+            if (!char.isDigit() && char != decimalSeparator) {
+                out.append(char)
+                i++
+                continue
+            }
 
-        for (char in text) {
-            when {
-                char.isDigit() || char == decimalSeparatorSymbol.single() -> {
-                    currentNumber.append(char)
-                }
-                else -> {
-                    if (currentNumber.isNotEmpty()) {
-                        result.add(currentNumber.toString())
-                        currentNumber = StringBuilder()
-                    }
-                    result.add(char.toString())
+            // Find the end of the number and how many digits come before its decimal separator
+            var end = i
+            var integerDigits = 0
+            var hasDecimalSeparator = false
+            while (end < source.length) {
+                val digit = source[end]
+                if (digit.isDigit()) {
+                    if (!hasDecimalSeparator) integerDigits++
+                } else if (digit == decimalSeparator) {
+                    hasDecimalSeparator = true
+                } else if (digit != groupingSeparator) {
+                    break
                 }
+                end++
             }
-        }
-
-        if (currentNumber.isNotEmpty()) {
-            result.add(currentNumber.toString())
-        }
-
-        return result
-    }
 
-    private fun addSeparators(
-        numbersList: List<String>,
-        decimalSeparatorSymbol: String,
-        groupingSeparatorSymbol: String,
-        numberingSystem: NumberingSystem
-    ): List<String> {
-        return numbersList.map {
-            if (it.contains(decimalSeparatorSymbol)) {
-                if (it.first() == decimalSeparatorSymbol[0]) {
-                    //this means the floating point number doesn't have integers
-                    it
-                } else {
-                    val integersPart = it.substring(0, it.indexOf(decimalSeparatorSymbol))
-                    val fractions = it.substring(it.indexOf(decimalSeparatorSymbol) + 1)
-                    formatIntegers(
-                        integersPart,
-                        groupingSeparatorSymbol,
-                        numberingSystem == NumberingSystem.INTERNATIONAL
-                    ) + decimalSeparatorSymbol + fractions
+            var remainingIntegerDigits = integerDigits
+            for (k in i until end) {
+                val digit = source[k]
+                if (digit == groupingSeparator) continue
+                out.append(digit)
+                if (remainingIntegerDigits > 0) {
+                    remainingIntegerDigits--
+                    if (remainingIntegerDigits > 0 && isGroupBoundary(remainingIntegerDigits, isIndian)) {
+                        out.append(groupingSeparatorSymbol)
+                    }
                 }
-            } else {
-                formatIntegers(it, groupingSeparatorSymbol, numberingSystem == NumberingSystem.INTERNATIONAL)
             }
+            i = end
         }
     }
 
-    private fun formatIntegers(
-        integers: String,
-        groupingSeparatorSymbol: String,
-        isInternational: Boolean
-    ): String {
-        // sample input  : 00110
-        return if (isInternational) {
-            integers.reversed()                         // reversed      : 01100
-                .chunked(3)                             // chunked       : [011, 00]
-                .joinToString(groupingSeparatorSymbol)  // joinedToString: 011,00
-                .reversed()                             // reversed      : 00,110
+    // Whether a separator goes before the last [remainingDigits] digits of an integer part
+    private fun isGroupBoundary(remainingDigits: Int, isIndian: Boolean): Boolean {
+        return if (isIndian) {
+            // First separator after 3 digits, then every 2 digits
+            remainingDigits >= 3 && (remainingDigits - 3) % 2 == 0
         } else {
-            return formatIndianNumberingSystem(integers)
-        }
-    }
-
-    private fun removeSeparators(text: String, groupingSeparatorSymbol: String): String {
-        return text.replace(groupingSeparatorSymbol, "")
-    }
-
-    private fun formatIndianNumberingSystem(numberStr: String): String {
-        val isNegative = numberStr.startsWith("-")
-        val numberWithoutSign = if (isNegative) numberStr.substring(1) else numberStr
-
-        val numberParts = numberWithoutSign.split(".")
-        val integerPart = numberParts[0]
-        val decimalPart = if (numberParts.size > 1) numberParts[1] else ""
-
-        val length = integerPart.length
-        val result = StringBuilder()
-        var count = 0
-
-        for (i in length - 1 downTo 0) {
-            result.append(integerPart[i])
-            count++
-
-            when {
-                /** First comma comes after 3 digits **/
-                count == 3 && i != 0 -> {
-                    result.append(',')
-                    count = 0
-                }
-                /** Subsequent commas every 2 digits **/
-                count == 2 && i != 0 && length - i > 3 -> {
-                    result.append(',')
-                    count = 0
-                }
-            }
+            remainingDigits % 3 == 0
         }
-
-        val formattedIntegerPart = result.reverse().toString()
-        val formattedNumber = if (decimalPart.isNotEmpty()) "$formattedIntegerPart.$decimalPart" else formattedIntegerPart
-        return if (isNegative) "-$formattedNumber" else formattedNumber
     }
 }
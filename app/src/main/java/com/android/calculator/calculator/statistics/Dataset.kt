@@ -0,0 +1,195 @@
+package com.android.calculator.calculator.statistics
+
+import java.math.BigDecimal
+import kotlin.math.sqrt
+
+/**
+ * Columns of numbers pasted by the user: one row per line, the values of a row separated by
+ * spaces, tabs or semicolons, and by commas when they are not the decimal separator.
+ *
+ * The values are parsed once to doubles for [Statistics]; their exact decimals are only parsed
+ * when asked for, from the same text.
+ */
+class Dataset private constructor(
+    private val text: CharArray,
+    private val decimalSeparator: Char,
+    private val columns: List<DoubleArray>
+) {
+
+    companion object {
+        /** The dataset in [text], or null if a value is not a number or a row has another size */
+        fun parse(text: String, decimalSeparator: Char = '.'): Dataset? {
+            val chars = text.toCharArray()
+            val rows = ArrayList<DoubleArray>()
+            val scanner = Scanner(chars, decimalSeparator)
+            val row = ArrayList<Double>()
+            var width = -1
+            while (true) {
+                val token = scanner.next()
+                if (token == Scanner.VALUE) {
+                    row.add(scanner.double() ?: return null)
+                    continue
+                }
+                // End of a line or of the text
+                if (row.isNotEmpty()) {
+                    if (width >= 0 && row.size != width) return null
+                    width = row.size
+                    rows.add(row.toDoubleArray())
+                    row.clear()
+                }
+                if (token == Scanner.END) break
+            }
+            if (rows.isEmpty()) return null
+            val columns = List(width) { column -> DoubleArray(rows.size) { rows[it][column] } }
+            return Dataset(chars, decimalSeparator, columns)
+        }
+    }
+
+    /** Values that are null when they are not defined for the dataset, such as one variance */
+    data class Summary(
+        val count: Int,
+        val sum: BigDecimal,
+        val mean: BigDecimal,
+        val median: BigDecimal,
+        val variance: BigDecimal?,
+        val standardDeviation: BigDecimal?
+    )
+
+    val rowCount: Int
+        get() = columns[0].size
+
+    val columnCount: Int
+        get() = columns.size
+
+    fun column(index: Int): DoubleArray = columns[index]
+
+    /**
+     * Summary of a column, computed in doubles, or exactly in decimals rounded to [exactScale]
+     * when it is given
+     */
+    fun summary(column: Int = 0, exactScale: Int? = null): Summary {
+        if (exactScale != null) {
+            val values = exactColumn(column)
+            val isVariance = values.size > 1
+            return Summary(
+                values.size,
+                Statistics.exactSum(values),
+                Statistics.exactMean(values, exactScale),
+                Statistics.exactMedian(values),
+                if (isVariance) Statistics.exactVariance(values, exactScale) else null,
+                if (isVariance) Statistics.exactStandardDeviation(values, exactScale) else null
+            )
+        }
+        val values = columns[column]
+        val variance = Statistics.variance(values)
+        return Summary(
+            values.size,
+            BigDecimal.valueOf(Statistics.sum(values)),
+            BigDecimal.valueOf(Statistics.mean(values)),
+            BigDecimal.valueOf(Statistics.median(values)),
+            if (variance.isFinite()) BigDecimal.valueOf(variance) else null,
+            if (variance.isFinite()) BigDecimal.valueOf(sqrt(variance)) else null
+        )
+    }
+
+    fun percentile(percentile: Double, column: Int = 0): Double = Statistics.percentile(columns[column], percentile)
+
+    fun regression(xColumn: Int = 0, yColumn: Int = 1): Statistics.Regression {
+        return Statistics.linearRegression(columns[xColumn], columns[yColumn])
+    }
+
+    /** The values of [column] as written, parsed again in decimals */
+    fun exactColumn(column: Int): List<BigDecimal> {
+        val values = ArrayList<BigDecimal>(rowCount)
+        val scanner = Scanner(text, decimalSeparator)
+        var index = 0
+        while (true) {
+            when (scanner.next()) {
+                Scanner.VALUE -> {
+                    if (index == column) values.add(scanner.decimal())
+                    index++
+                }
+                Scanner.END_OF_LINE -> index = 0
+                Scanner.END -> return values
+            }
+        }
+    }
+
+    // Splits the text into values and ends of lines, normalizing the decimal separator to '.'
+    private class Scanner(private val chars: CharArray, private val decimalSeparator: Char) {
+
+        companion object {
+            const val VALUE = 0
+            const val END_OF_LINE = 1
+            const val END = 2
+        }
+
+        private var pos = 0
+        private var buffer = CharArray(32)
+        private var length = 0
+
+        fun next(): Int {
+            while (pos < chars.size) {
+                val ch = chars[pos]
+                when {
+                    ch == '\n' -> {
+                        pos++
+                        return END_OF_LINE
+                    }
+                    ch == ' ' || ch == '\t' || ch == '\r' || ch == ';' || (ch == ',' && decimalSeparator != ',') -> pos++
+                    else -> {
+                        readValue()
+                        return VALUE
+                    }
+                }
+            }
+            return END
+        }
+
+        fun double(): Double? {
+            if (!isDecimal()) return null
+            return String(buffer, 0, length).toDouble().takeIf { it.isFinite() }
+        }
+
+        fun decimal(): BigDecimal = BigDecimal(buffer, 0, length)
+
+        // Sign, digits with an optional decimal point, and an optional exponent, as BigDecimal reads them
+        private fun isDecimal(): Boolean {
+            var i = 0
+            if (i < length && (buffer[i] == '+' || buffer[i] == '-')) i++
+            var digits = 0
+            while (i < length && buffer[i] in '0'..'9') {
+                i++
+                digits++
+            }
+            if (i < length && buffer[i] == '.') {
+                i++
+                while (i < length && buffer[i] in '0'..'9') {
+                    i++
+                    digits++
+                }
+            }
+            if (digits == 0) return false
+            if (i < length && (buffer[i] == 'e' || buffer[i] == 'E')) {
+                i++
+                if (i < length && (buffer[i] == '+' || buffer[i] == '-')) i++
+                val exponentStart = i
+                while (i < length && buffer[i] in '0'..'9') i++
+                if (i == exponentStart) return false
+            }
+            return i == length
+        }
+
+        private fun readValue() {
+            length = 0
+            while (pos < chars.size) {
+                val ch = chars[pos]
+                if (ch == '\n' || ch == ' ' || ch == '\t' || ch == '\r' || ch == ';') break
+                if (ch == ',' && decimalSeparator != ',') break
+                if (length == buffer.size) buffer = buffer.copyOf(length * 2)
+                buffer[length++] = if (ch == decimalSeparator) '.' else ch
+                pos++
+            }
+        }
+    }
+}
@@ -0,0 +1,187 @@
+package com.android.calculator.calculator.statistics
+
+import java.math.BigDecimal
+import java.math.MathContext
+import java.math.RoundingMode
+import kotlin.math.abs
+import kotlin.math.floor
+import kotlin.math.sqrt
+
+/**
+ * Statistics of a list of values, in doubles or exactly in decimals.
+ *
+ * The double functions go over the values in four independent lanes, so that consecutive
+ * additions do not wait for one another, and sum each lane with Neumaier's compensation: the sum
+ * of a hundred thousand values keeps the precision of a single addition. The exact functions
+ * compute in BigDecimal and only round the final division, to the given scale.
+ */
+object Statistics {
+
+    private const val LANES = 4
+    private const val MAX_NEWTON_STEPS = 64
+
+    /** Coefficients of the least squares line y = slope * x + intercept, and their correlation */
+    data class Regression(val slope: Double, val intercept: Double, val correlation: Double)
+
+    fun sum(values: DoubleArray, from: Int = 0, to: Int = values.size): Double {
+        val sums = DoubleArray(LANES)
+        val compensations = DoubleArray(LANES)
+        var i = from
+        while (i + LANES <= to) {
+            for (lane in 0 until LANES) {
+                val value = values[i + lane]
+                val sum = sums[lane] + value
+                // Neumaier: keep the low order bits lost by the larger of the two terms
+                compensations[lane] += if (abs(sums[lane]) >= abs(value)) sums[lane] - sum + value else value - sum + sums[lane]
+                sums[lane] = sum
+            }
+            i += LANES
+        }
+        var sum = 0.0
+        var compensation = 0.0
+        for (lane in 0 until LANES) compensation += compensations[lane]
+        // The lanes, then the remaining values, are added with the same compensation
+        for (k in 0 until LANES + to - i) {
+            val value = if (k < LANES) sums[k] else values[i + k - LANES]
+            val next = sum + value
+            compensation += if (abs(sum) >= abs(value)) sum - next + value else value - next + sum
+            sum = next
+        }
+        return sum + compensation
+    }
+
+    fun mean(values: DoubleArray): Double = if (values.isEmpty()) Double.NaN else sum(values) / values.size
+
+    /** Sample variance, by two passes over the values: around the mean, then its correction */
+    fun variance(values: DoubleArray): Double {
+        if (values.size < 2) return Double.NaN
+        val mean = mean(values)
+        val deviations = DoubleArray(values.size)
+        for (i in values.indices) deviations[i] = values[i] - mean
+        val squares = DoubleArray(values.size)
+        for (i in values.indices) squares[i] = deviations[i] * deviations[i]
+        // The deviations only sum to 0 with an exact mean
+        val correction = sum(deviations)
+        return (sum(squares) - correction * correction / values.size) / (values.size - 1)
+    }
+
+    fun standardDeviation(values: DoubleArray): Double = sqrt(variance(values))
+
+    fun median(values: DoubleArray): Double = percentile(values, 50.0)
+
+    /** The [percentile] between 0 and 100, interpolated linearly between the closest ranks */
+    fun percentile(values: DoubleArray, percentile: Double): Double {
+        if (values.isEmpty() || percentile.isNaN() || percentile < 0 || percentile > 100) return Double.NaN
+        val sorted = values.copyOf()
+        val rank = percentile / 100 * (sorted.size - 1)
+        val lower = floor(rank).toInt()
+        val upper = minOf(lower + 1, sorted.size - 1)
+        // Only the two ranks are put in place, in linear time on average
+        select(sorted, lower, 0, sorted.size - 1)
+        if (upper != lower) select(sorted, upper, lower + 1, sorted.size - 1)
+        return sorted[lower] + (rank - lower) * (sorted[upper] - sorted[lower])
+    }
+
+    fun linearRegression(xs: DoubleArray, ys: DoubleArray): Regression {
+        require(xs.size == ys.size) { "The columns do not have the same size" }
+        if (xs.size < 2) return Regression(Double.NaN, Double.NaN, Double.NaN)
+        val meanX = mean(xs)
+        val meanY = mean(ys)
+        val xx = DoubleArray(xs.size)
+        val yy = DoubleArray(xs.size)
+        val xy = DoubleArray(xs.size)
+        for (i in xs.indices) {
+            val dx = xs[i] - meanX
+            val dy = ys[i] - meanY
+            xx[i] = dx * dx
+            yy[i] = dy * dy
+            xy[i] = dx * dy
+        }
+        val sxx = sum(xx)
+        val syy = sum(yy)
+        val sxy = sum(xy)
+        val slope = sxy / sxx
+        return Regression(slope, meanY - slope * meanX, sxy / sqrt(sxx * syy))
+    }
+
+    fun exactSum(values: List<BigDecimal>): BigDecimal {
+        var sum = BigDecimal.ZERO
+        for (value in values) sum = sum.add(value)
+        return sum
+    }
+
+    fun exactMean(values: List<BigDecimal>, scale: Int): BigDecimal {
+        return divide(exactSum(values), BigDecimal(values.size), scale)
+    }
+
+    /** Sample variance, from the exact sums of the values and of their squares */
+    fun exactVariance(values: List<BigDecimal>, scale: Int): BigDecimal {
+        val n = BigDecimal(values.size)
+        var sum = BigDecimal.ZERO
+        var squares = BigDecimal.ZERO
+        for (value in values) {
+            sum = sum.add(value)
+            squares = squares.add(value.multiply(value))
+        }
+        // (n Σx² - (Σx)²) / (n (n - 1))
+        val numerator = n.multiply(squares).subtract(sum.multiply(sum))
+        return divide(numerator, n.multiply(n.subtract(BigDecimal.ONE)), scale)
+    }
+
+    fun exactStandardDeviation(values: List<BigDecimal>, scale: Int): BigDecimal {
+        val variance = exactVariance(values, scale + 2)
+        return sqrt(variance, MathContext(variance.precision() + scale + 2, RoundingMode.HALF_EVEN))
+            .setScale(scale, RoundingMode.HALF_EVEN)
+    }
+
+    fun exactMedian(values: List<BigDecimal>): BigDecimal {
+        val sorted = values.sorted()
+        val middle = sorted.size / 2
+        if (sorted.size % 2 == 1) return sorted[middle]
+        // The mean of two decimals always terminates
+        return sorted[middle - 1].add(sorted[middle]).divide(BigDecimal(2))
+    }
+
+    // Exact when the quotient terminates, rounded to scale otherwise
+    private fun divide(x: BigDecimal, y: BigDecimal, scale: Int): BigDecimal {
+        return x.divide(y, maxOf(scale, x.scale()), RoundingMode.HALF_EVEN).stripTrailingZeros()
+    }
+
+    private fun sqrt(x: BigDecimal, mathContext: MathContext): BigDecimal {
+        if (x.signum() <= 0) return BigDecimal.ZERO
+        // Newton's method from the double estimate, as the calculator does before API 33
+        val guess = sqrt(x.toDouble())
+        var estimate = if (guess.isFinite() && guess > 0) BigDecimal(guess) else x
+        val two = BigDecimal(2)
+        // Quadratic convergence: a few steps suffice, the cap stops an oscillation on the last digit
+        for (step in 0 until MAX_NEWTON_STEPS) {
+            val next = x.divide(estimate, mathContext).add(estimate).divide(two, mathContext)
+            if (next.compareTo(estimate) == 0) break
+            estimate = next
+        }
+        return estimate
+    }
+
+    // Hoare's selection: put the value of rank k in values[k], smaller ones before, larger after
+    private fun select(values: DoubleArray, k: Int, from: Int, to: Int) {
+        var low = from
+        var high = to
+        while (low < high) {
+            val pivot = values[(low + high) ushr 1]
+            var i = low
+            var j = high
+            while (i <= j) {
+                while (values[i] < pivot) i++
+                while (values[j] > pivot) j--
+                if (i <= j) {
+                    val swapped = values[i]
+                    values[i] = values[j]
+                    values[j] = swapped
+                    i++
+                    j--
+                }
+            }
+            if (k <= j) high = j else if (k >= i) low = i else return
+        }
+    }
+}
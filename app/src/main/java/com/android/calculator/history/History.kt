@@ -1,11 +1,19 @@
 package com.android.calculator.history
 
 import com.google.gson.annotations.SerializedName
+import java.math.BigDecimal
 import java.util.UUID
 
 data class History(
     @SerializedName("calculation") var calculation: String,
     @SerializedName("result") var result: String,
     @SerializedName("time") var time: String,
-    @SerializedName("id") var id: String = UUID.randomUUID().toString()
+    @SerializedName("id") var id: String = UUID.randomUUID().toString(),
+    // Value of the result when it did not have to be rounded to the precision, to display it
+    // again at another one; the calculation is evaluated again otherwise
+    @SerializedName("exact") var exact: BigDecimal? = null,
+    // Format of the calculation and result, encoded by HistoryRecalculator.Format, if known
+    @SerializedName("format") var format: String? = null,
+    // Angle unit the calculation was evaluated in, if known
+    @SerializedName("degreeMode") var isDegreeModeActivated: Boolean? = null
 )
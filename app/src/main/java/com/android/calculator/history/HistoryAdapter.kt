@@ -16,7 +16,7 @@ import com.android.calculator.MyPreferences
 import com.android.calculator.R
 
 class HistoryAdapter(
-    private var history: MutableList<History>,
+    private val history: HistoryPagedSource,
     private val onElementClick: (value: String) -> Unit,
     private val context: Context
     ) : RecyclerView.Adapter<HistoryAdapter.HistoryViewHolder>() {
@@ -31,19 +31,13 @@ class HistoryAdapter(
         override fun getItemCount(): Int = history.size
 
         override fun onBindViewHolder(holder: HistoryViewHolder, position: Int) {
-            holder.bind(history[position], position)
-        }
-
-        fun appendHistory(historyList: List<History>) {
-            this.history.addAll(historyList)
-            notifyItemRangeInserted(
-                this.history.size,
-                historyList.size - 1
-            )
+            val historyElement = history.get(position) ?: return
+            holder.bind(historyElement, position)
         }
 
+        // The element has already been added to the history store
         fun appendOneHistoryElement(history: History) {
-            this.history.add(history)
+            this.history.onAppended()
             // Update the last 2 elements to avoid to have the same date and bar separator
             if (this.history.size > 1) {
                 notifyItemInserted(this.history.size - 1)
@@ -55,17 +49,12 @@ class HistoryAdapter(
 
         fun removeHistoryElement(position: Int){
             // No idea why, but time.isNotEmpty() is not working, only time.isNullOrEmpty() works
-            val historyElement = history[position]
+            val historyElement = history.get(position) ?: return
             if (!historyElement.time.isNullOrEmpty()){
-                val nextHistoryElement = history.getOrNull(position + 1)
+                val nextHistoryElement = history.get(position + 1)
                 nextHistoryElement?.let {
                     if (it.time.isNullOrEmpty()){
-                        this.history[position + 1] = History(
-                            calculation = nextHistoryElement.calculation,
-                            result = nextHistoryElement.result,
-                            time = historyElement.time,
-                            id = nextHistoryElement.id
-                        )
+                        this.history.update(position + 1, it.copy(time = historyElement.time))
                     }
                 }
             }
@@ -75,24 +64,38 @@ class HistoryAdapter(
 
 
         fun updateHistoryList() {
-            this.history = MyPreferences(context).getHistory()
+            this.history.refresh()
         }
+
+        // The element has already been updated in the history store
         fun updateHistoryElement(historyElement: History) {
-            updateHistoryList()
-            val position = this.history.indexOfFirst { it.id == historyElement.id }
-            if (position != -1) {
-                this.history[position] = historyElement
+            val position = this.history.positionOf(historyElement.id)
+            if (position != -1 && position < this.history.size) {
+                this.history.onChanged(position)
                 notifyItemChanged(position)
             }
         }
 
+        fun updateHistoryRange(positions: IntRange) {
+            val last = minOf(positions.last, this.history.size - 1)
+            if (positions.first < 0 || positions.first > last) return
+            this.history.onRangeChanged(positions.first..last)
+            notifyItemRangeChanged(positions.first, last - positions.first + 1)
+        }
+
+        // The element has already been trimmed from the history store
         fun removeFirstHistoryElement() {
-            this.history.removeAt(0)
+            this.history.onRemovedFirst()
             notifyItemRemoved(0)
         }
 
+        // The oldest elements are removed from the store in the background, then the list is reloaded
+        fun trimHistory(maxSize: Int, onTrimmed: () -> Unit) {
+            this.history.trimTo(maxSize, onTrimmed)
+        }
+
         fun clearHistory() {
-            this.history.clear()
+            this.history.refresh()
             notifyDataSetChanged()
         }
 
@@ -128,10 +131,12 @@ class HistoryAdapter(
                     )
                     // Check if the former result has the same date -> hide the date
                     if (position > 0) {
+                        val previousHistoryElement = history.get(position - 1)
                         if (
-                            !history[position-1].time.isNullOrEmpty()
+                            previousHistoryElement != null
+                            && !previousHistoryElement.time.isNullOrEmpty()
                             && DateUtils.getRelativeTimeSpanString(
-                                history[position-1].time.toLong(),
+                                previousHistoryElement.time.toLong(),
                                 System.currentTimeMillis(),
                                 DateUtils.DAY_IN_MILLIS,
                                 DateUtils.FORMAT_ABBREV_RELATIVE,
@@ -145,10 +150,11 @@ class HistoryAdapter(
                         time.visibility = View.VISIBLE
                     }
                     // Check if the next result has the same date -> hide the separator
-                    if (position+1 < history.size) {
+                    val nextHistoryElement = history.get(position + 1)
+                    if (nextHistoryElement != null && !nextHistoryElement.time.isNullOrEmpty()) {
                         if (
                             DateUtils.getRelativeTimeSpanString(
-                                history[position+1].time.toLong(),
+                                nextHistoryElement.time.toLong(),
                                 System.currentTimeMillis(),
                                 DateUtils.DAY_IN_MILLIS,
                                 DateUtils.FORMAT_ABBREV_RELATIVE,
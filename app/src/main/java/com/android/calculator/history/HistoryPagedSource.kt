@@ -0,0 +1,263 @@
+package com.android.calculator.history
+
+import java.util.concurrent.Executor
+import java.util.concurrent.Executors
+
+/**
+ * Windowed view of a [HistoryStore] for the history RecyclerView.
+ *
+ * Elements are decoded a page at a time and kept in a small LRU cache, so memory stays constant
+ * whatever the history size. Neighbouring pages are decoded ahead of the scroll on a background
+ * thread, and evicted page arrays are recycled for the next page to decode.
+ *
+ * Removals and updates are written to the store on the same background thread, since a write may
+ * compact the log. Until a write is applied, the pages are read as if it already were.
+ *
+ * [size] is a snapshot that only moves when the adapter is notified of a change, so the
+ * RecyclerView never sees the store grow or shrink behind its back.
+ */
+class HistoryPagedSource(
+    private val store: HistoryStore,
+    private val pageSize: Int = DEFAULT_PAGE_SIZE,
+    private val maxCachedPages: Int = DEFAULT_MAX_CACHED_PAGES,
+    private val executor: Executor = storeExecutor
+) {
+
+    companion object {
+        const val DEFAULT_PAGE_SIZE = 64
+        const val DEFAULT_MAX_CACHED_PAGES = 6
+
+        // Single thread, so that writes are applied in order and before the prefetches posted after them
+        private val storeExecutor: Executor = Executors.newSingleThreadExecutor { runnable ->
+            Thread(runnable, "history-store").apply { isDaemon = true }
+        }
+    }
+
+    private class Page(val elements: Array<History?>, var count: Int)
+
+    private val recycledPages = ArrayDeque<Page>()
+
+    private val pages = object : LinkedHashMap<Int, Page>(maxCachedPages + 1, 0.75f, true) {
+        override fun removeEldestEntry(eldest: MutableMap.MutableEntry<Int, Page>?): Boolean {
+            if (size > maxCachedPages) {
+                eldest?.let { recycle(it.value) }
+                return true
+            }
+            return false
+        }
+    }
+
+    private val pendingPages = HashSet<Int>()
+
+    // Writes posted to the executor and not applied to the store yet, by id
+    private val pendingRemovals = HashSet<String>()
+    private val pendingUpdates = HashMap<String, History>()
+
+    // Bumped on every structural change so that a prefetch decoded before it is dropped
+    private var generation = 0
+
+    var size: Int = store.size
+        @Synchronized get
+        private set
+
+    @Synchronized
+    fun get(position: Int): History? {
+        if (position < 0 || position >= size) return null
+        val pageIndex = position / pageSize
+        val page = pages[pageIndex] ?: loadPage(pageIndex)
+        prefetchAround(pageIndex, position % pageSize)
+        val offset = position % pageSize
+        return if (offset < page.count) page.elements[offset] else null
+    }
+
+    /**
+     * Re-read the size of the store and drop every decoded page.
+     */
+    @Synchronized
+    fun refresh() {
+        size = synchronized(store) { store.size - removedPositions(pendingRemovals).size }
+        invalidateFrom(0)
+    }
+
+    @Synchronized
+    fun onAppended() {
+        size++
+        invalidateFrom(size - 1)
+    }
+
+    @Synchronized
+    fun onRemovedFirst() {
+        if (size > 0) size--
+        invalidateFrom(0)
+    }
+
+    @Synchronized
+    fun onChanged(position: Int) {
+        val page = pages[position / pageSize] ?: return
+        val offset = position % pageSize
+        val element = arrayOfNulls<History>(1)
+        if (offset < page.count && readRange(position, element, pendingRemovals, pendingUpdates) == 1) {
+            page.elements[offset] = element[0]
+        }
+    }
+
+    /**
+     * Drop the decoded pages overlapping [positions], after the store was rewritten underneath.
+     */
+    @Synchronized
+    fun onRangeChanged(positions: IntRange) {
+        generation++
+        for (pageIndex in positions.first / pageSize..positions.last / pageSize) {
+            pages.remove(pageIndex)?.let { recycle(it) }
+        }
+        pendingPages.clear()
+    }
+
+    @Synchronized
+    fun removeAt(position: Int) {
+        val history = get(position) ?: return
+        pendingRemovals.add(history.id)
+        size--
+        invalidateFrom(position)
+        executor.execute {
+            store.remove(history.id)
+            synchronized(this) { pendingRemovals.remove(history.id) }
+        }
+    }
+
+    /**
+     * Remove the oldest elements of the store beyond [maxSize] on the thread of the store, which may
+     * rewrite the whole log, then call [onTrimmed] from that thread if any was removed.
+     */
+    fun trimTo(maxSize: Int, onTrimmed: () -> Unit) {
+        executor.execute {
+            val trimmed = synchronized(store) {
+                val trimmed = store.size > maxSize
+                store.trimTo(maxSize)
+                trimmed
+            }
+            if (trimmed) onTrimmed()
+        }
+    }
+
+    @Synchronized
+    fun update(position: Int, history: History) {
+        pendingUpdates[history.id] = history
+        // A prefetch posted before would decode the former element
+        generation++
+        pendingPages.clear()
+        val page = pages[position / pageSize]
+        if (page != null && position % pageSize < page.count) {
+            page.elements[position % pageSize] = history
+        }
+        executor.execute {
+            store.update(history.id, history)
+            synchronized(this) {
+                if (pendingUpdates[history.id] === history) pendingUpdates.remove(history.id)
+            }
+        }
+    }
+
+    @Synchronized
+    fun positionOf(id: String): Int {
+        if (id in pendingRemovals) return -1
+        return synchronized(store) {
+            val position = store.positionOf(id)
+            if (position < 0) -1 else position - removedPositions(pendingRemovals).count { it < position }
+        }
+    }
+
+    private fun invalidateFrom(position: Int) {
+        generation++
+        val firstPage = position.coerceAtLeast(0) / pageSize
+        val iterator = pages.entries.iterator()
+        while (iterator.hasNext()) {
+            val entry = iterator.next()
+            if (entry.key >= firstPage) {
+                recycle(entry.value)
+                iterator.remove()
+            }
+        }
+        pendingPages.clear()
+    }
+
+    private fun loadPage(pageIndex: Int): Page {
+        val page = obtainPage()
+        page.count = readRange(pageIndex * pageSize, page.elements, pendingRemovals, pendingUpdates)
+        pages[pageIndex] = page
+        return page
+    }
+
+    /**
+     * Decode the elements from [position] on into [into], as they are once [removals] and
+     * [updates] are applied to the store.
+     *
+     * @return the number of decoded elements
+     */
+    private fun readRange(position: Int, into: Array<History?>, removals: Set<String>, updates: Map<String, History>): Int {
+        var count = 0
+        synchronized(store) {
+            val removed = removedPositions(removals)
+            if (removed.isEmpty()) {
+                count = store.getRange(position, into.size, into)
+            } else {
+                var start = position
+                for (removedPosition in removed) {
+                    if (removedPosition <= start) start++ else break
+                }
+                val elements = arrayOfNulls<History>(into.size + removed.size)
+                val read = store.getRange(start, elements.size, elements)
+                for (i in 0 until read) {
+                    val element = elements[i] ?: continue
+                    if (element.id in removals) continue
+                    if (count == into.size) break
+                    into[count++] = element
+                }
+            }
+        }
+        if (updates.isNotEmpty()) {
+            for (i in 0 until count) {
+                val updated = into[i]?.let { updates[it.id] } ?: continue
+                into[i] = updated
+            }
+        }
+        return count
+    }
+
+    // Positions in the store of the elements of [removals] it still holds, in increasing order
+    private fun removedPositions(removals: Set<String>): List<Int> {
+        if (removals.isEmpty()) return emptyList()
+        return removals.map { store.positionOf(it) }.filter { it >= 0 }.sorted()
+    }
+
+    private fun prefetchAround(pageIndex: Int, offset: Int) {
+        // Only look ahead in the direction the user is heading to within the page
+        val neighbour = if (offset >= pageSize / 2) pageIndex + 1 else pageIndex - 1
+        if (neighbour < 0 || neighbour * pageSize >= size) return
+        if (pages.containsKey(neighbour) || !pendingPages.add(neighbour)) return
+        val requestedGeneration = generation
+        val removals = if (pendingRemovals.isEmpty()) emptySet() else HashSet(pendingRemovals)
+        val updates = if (pendingUpdates.isEmpty()) emptyMap() else HashMap(pendingUpdates)
+        executor.execute {
+            val elements = arrayOfNulls<History>(pageSize)
+            val count = readRange(neighbour * pageSize, elements, removals, updates)
+            synchronized(this) {
+                if (requestedGeneration == generation && pendingPages.remove(neighbour) && !pages.containsKey(neighbour)) {
+                    pages[neighbour] = Page(elements, count)
+                }
+            }
+        }
+    }
+
+    private fun obtainPage(): Page {
+        return recycledPages.removeFirstOrNull() ?: Page(arrayOfNulls(pageSize), 0)
+    }
+
+    private fun recycle(page: Page) {
+        page.elements.fill(null)
+        page.count = 0
+        if (recycledPages.size < maxCachedPages) {
+            recycledPages.addLast(page)
+        }
+    }
+}
@@ -0,0 +1,257 @@
+package com.android.calculator.history
+
+import com.android.calculator.calculator.Calculator
+import com.android.calculator.calculator.CalculatorExecutor
+import com.android.calculator.calculator.CalculatorErrors
+import com.android.calculator.calculator.parser.Expression
+import com.android.calculator.calculator.parser.NumberFormatter
+import com.android.calculator.calculator.parser.NumberingSystem
+import com.android.calculator.calculator.parser.NumberingSystem.Companion.toNumberingSystem
+import java.math.BigDecimal
+import java.util.concurrent.ExecutorService
+import java.util.concurrent.Future
+import java.util.concurrent.atomic.AtomicBoolean
+import java.util.concurrent.atomic.AtomicInteger
+
+/**
+ * Brings the stored history up to date after the precision, the numbering system or the
+ * separators changed.
+ *
+ * The history is split into chunks that are recomputed on a thread pool, the chunks holding
+ * the visible elements first and then the others by distance to them. Each chunk is written
+ * back to the store as soon as it is done, so the history is updated progressively.
+ * A change of precision or of scientific notation rounds the results that terminate again, and
+ * re-evaluates the others, in the angle unit they were evaluated in;
+ * any other change only has to reformat the stored strings.
+ *
+ * Every element written back records the format it is now in, and is converted from that format
+ * rather than from the one the recomputation starts from: a recomputation cancelled half way and
+ * restarted towards another format never converts an element twice.
+ */
+class HistoryRecalculator(
+    private val store: HistoryStore,
+    private val executor: ExecutorService = CalculatorExecutor.shared,
+    private val chunkSize: Int = DEFAULT_CHUNK_SIZE
+) {
+
+    companion object {
+        const val DEFAULT_CHUNK_SIZE = 64
+
+        // Functions whose result depends on the angle unit, their inverses included
+        private val ANGLE_FUNCTIONS = listOf("sin", "cos", "tan")
+    }
+
+    data class Format(
+        val numberPrecision: Int,
+        val writeNumberIntoScientificNotation: Boolean,
+        val numberingSystem: NumberingSystem,
+        val decimalSeparatorSymbol: String,
+        val groupingSeparatorSymbol: String
+    ) {
+        fun encode(): String {
+            return listOf(
+                numberPrecision,
+                writeNumberIntoScientificNotation,
+                numberingSystem.value,
+                decimalSeparatorSymbol,
+                groupingSeparatorSymbol
+            ).joinToString(SEPARATOR)
+        }
+
+        companion object {
+            private const val SEPARATOR = "|"
+
+            fun decode(encoded: String?): Format? {
+                val fields = encoded?.split(SEPARATOR) ?: return null
+                if (fields.size != 5) return null
+                return Format(
+                    numberPrecision = fields[0].toIntOrNull() ?: return null,
+                    writeNumberIntoScientificNotation = fields[1].toBoolean(),
+                    numberingSystem = fields[2].toIntOrNull()?.toNumberingSystem() ?: return null,
+                    decimalSeparatorSymbol = fields[3],
+                    groupingSeparatorSymbol = fields[4]
+                )
+            }
+        }
+    }
+
+    class Recomputation internal constructor(private val cancelled: AtomicBoolean) {
+        internal val futures = ArrayList<Future<*>>()
+
+        val isDone: Boolean
+            get() = futures.all { it.isDone }
+
+        fun cancel() {
+            cancelled.set(true)
+            futures.forEach { it.cancel(false) }
+        }
+    }
+
+    /**
+     * Recompute the whole history to [to].
+     *
+     * @param from format of the elements that do not record their own
+     * @param visible positions to recompute first
+     * @param onWritten called from a worker thread with the positions of every chunk written back
+     * @param onFinished called from a worker thread once every chunk has been written back
+     */
+    fun recompute(
+        from: Format,
+        to: Format,
+        visible: IntRange,
+        onWritten: (IntRange) -> Unit,
+        onFinished: () -> Unit = {}
+    ): Recomputation {
+        val cancelled = AtomicBoolean(false)
+        val recomputation = Recomputation(cancelled)
+        val chunks = chunkOrder(store.size, visible)
+        if (chunks.isEmpty()) {
+            onFinished()
+            return recomputation
+        }
+
+        // Evaluation is reentrant, so one calculator is shared by every worker
+        val calculator = Calculator(to.numberPrecision)
+        val remaining = AtomicInteger(chunks.size)
+
+        for (chunk in chunks) {
+            recomputation.futures.add(executor.submit {
+                if (cancelled.get()) return@submit
+                val positions = recomputeChunk(chunk, from, to, calculator, cancelled)
+                if (!positions.isEmpty() && !cancelled.get()) onWritten(positions)
+                if (remaining.decrementAndGet() == 0 && !cancelled.get()) onFinished()
+            })
+        }
+        return recomputation
+    }
+
+    fun recompute(history: History, from: Format, to: Format, calculator: Calculator): History {
+        val encoded = to.encode()
+        if (history.format == encoded) return history
+        val format = Format.decode(history.format) ?: from
+        val calculation = reformat(history.calculation, format, to)
+        val exact = history.exact
+        val result = when {
+            format.numberPrecision == to.numberPrecision &&
+                format.writeNumberIntoScientificNotation == to.writeNumberIntoScientificNotation ->
+                reformat(history.result, format, to)
+            // Only the rounding changed: no need to evaluate again
+            exact != null -> formatResult(exact, to)
+            else -> evaluate(calculation, history.isDegreeModeActivated, to, calculator)
+                ?: reformat(history.result, format, to)
+        }
+        return history.copy(calculation = calculation, result = result, format = encoded)
+    }
+
+    /**
+     * Move the separators of [text] from [from] to [to] and group its numbers again.
+     */
+    fun reformat(text: String, from: Format, to: Format): String {
+        if (from.decimalSeparatorSymbol == to.decimalSeparatorSymbol &&
+            from.groupingSeparatorSymbol == to.groupingSeparatorSymbol &&
+            from.numberingSystem == to.numberingSystem
+        ) {
+            return text
+        }
+        // A single pass, as the two separators may have been swapped. An empty separator is
+        // never found in the text, and one of several characters is matched as a whole
+        val grouping = from.groupingSeparatorSymbol
+        val decimal = from.decimalSeparatorSymbol
+        val builder = StringBuilder(text.length)
+        var i = 0
+        while (i < text.length) {
+            when {
+                grouping.isNotEmpty() && text.startsWith(grouping, i) -> i += grouping.length
+                decimal.isNotEmpty() && text.startsWith(decimal, i) -> {
+                    builder.append(to.decimalSeparatorSymbol)
+                    i += decimal.length
+                }
+                else -> builder.append(text[i++])
+            }
+        }
+        return NumberFormatter.format(
+            builder.toString(),
+            to.decimalSeparatorSymbol,
+            to.groupingSeparatorSymbol,
+            to.numberingSystem
+        )
+    }
+
+    private fun recomputeChunk(
+        chunk: Int,
+        from: Format,
+        to: Format,
+        calculator: Calculator,
+        cancelled: AtomicBoolean
+    ): IntRange {
+        val elements = arrayOfNulls<History>(chunkSize)
+        val start = chunk * chunkSize
+        val count = store.getRange(start, chunkSize, elements)
+        val updates = ArrayList<Pair<History, History>>(count)
+        for (i in 0 until count) {
+            if (cancelled.get()) return IntRange.EMPTY
+            val history = elements[i] ?: continue
+            val recomputed = recompute(history, from, to, calculator)
+            if (recomputed != history) updates.add(history to recomputed)
+        }
+        // Elements edited or removed since they were read are left alone
+        for ((expected, recomputed) in updates) {
+            store.updateIfUnchanged(expected, recomputed)
+        }
+        return if (updates.isEmpty()) IntRange.EMPTY else start until start + count
+    }
+
+    // Null when the angle unit of a trigonometric calculation is not known
+    private fun evaluate(calculation: String, isDegreeModeActivated: Boolean?, to: Format, calculator: Calculator): String? {
+        if (isDegreeModeActivated == null && ANGLE_FUNCTIONS.any { calculation.contains(it) }) return null
+        return CalculatorErrors.isolated { errors ->
+            val cleanCalculation = Expression().getCleanExpression(
+                calculation,
+                to.decimalSeparatorSymbol,
+                to.groupingSeparatorSymbol
+            )
+            val value = calculator.evaluate(cleanCalculation, isDegreeModeActivated ?: false)
+            if (errors.hasError) null else formatResult(value, to)
+        }
+    }
+
+    // Same rounding and formatting as the result display of the calculator
+    private fun formatResult(value: BigDecimal, to: Format): String {
+        val result = Calculator.roundResult(value, to.numberPrecision, to.writeNumberIntoScientificNotation)
+        var resultString = result.toString()
+        if (!to.writeNumberIntoScientificNotation || !(result >= BigDecimal(9999) || result <= BigDecimal(0.1))) {
+            val resultSplited = resultString.split('.')
+            if (resultSplited.size > 1) {
+                val resultPartAfterDecimalSeparator = resultSplited[1].trimEnd('0')
+                resultString = resultSplited[0]
+                if (resultPartAfterDecimalSeparator != "") {
+                    resultString += ".$resultPartAfterDecimalSeparator"
+                }
+            }
+        }
+        return NumberFormatter.format(
+            resultString.replace(".", to.decimalSeparatorSymbol),
+            to.decimalSeparatorSymbol,
+            to.groupingSeparatorSymbol,
+            to.numberingSystem
+        )
+    }
+
+    // Chunks holding the visible positions first, then the others by distance to them
+    private fun chunkOrder(size: Int, visible: IntRange): List<Int> {
+        val chunkCount = (size + chunkSize - 1) / chunkSize
+        if (chunkCount == 0) return emptyList()
+        val firstVisible = (if (visible.isEmpty()) size - 1 else visible.first).coerceIn(0, size - 1) / chunkSize
+        val lastVisible = (if (visible.isEmpty()) size - 1 else visible.last).coerceIn(0, size - 1) / chunkSize
+
+        val order = ArrayList<Int>(chunkCount)
+        for (chunk in firstVisible..lastVisible) order.add(chunk)
+        var before = firstVisible - 1
+        var after = lastVisible + 1
+        while (before >= 0 || after < chunkCount) {
+            if (after < chunkCount) order.add(after++)
+            if (before >= 0) order.add(before--)
+        }
+        return order
+    }
+}
@@ -0,0 +1,314 @@
+package com.android.calculator.history
+
+import java.math.BigDecimal
+import java.math.BigInteger
+import java.nio.ByteBuffer
+import java.nio.charset.StandardCharsets
+import java.util.UUID
+
+/**
+ * Binary encoding of a history element inside a [HistoryStore] record.
+ *
+ * ```
+ * body        := sequence:varint time:varint id text(calculation) text(result) exact flags:byte [text(format)]
+ * id          := 0x00 uuid:16 bytes | 0x01 length:varint utf8
+ * text        := length:varint token*
+ * exact       := 0x00 | 0x01 scale:zigzag-varint length:varint unscaled:two's complement bytes
+ * ```
+ *
+ * Times are stored plus one, 0 meaning no time. Calculations and results are tokenized: ASCII
+ * characters are one byte, the symbols and functions of the keyboard are one byte from
+ * [DICTIONARY], and runs of digits are packed two digits per byte. The flags tell whether the
+ * format and the angle unit of the element are known, and the angle unit.
+ */
+internal object HistoryRecordFormat {
+
+    private const val ID_UUID = 0
+    private const val ID_STRING = 1
+
+    private const val EXACT_NONE = 0
+    private const val EXACT_DECIMAL = 1
+
+    private const val FLAG_FORMAT = 0x1
+    private const val FLAG_ANGLE_UNIT = 0x2
+    private const val FLAG_DEGREE = 0x4
+
+    private const val TOKEN_DIGITS = 0x01
+    private const val TOKEN_UTF8 = 0x02
+    private const val TOKEN_DICTIONARY = 0x80
+
+    // Shorter runs are cheaper as ASCII
+    private const val MIN_PACKED_DIGITS = 4
+
+    // Append only: the index of an entry is stored in every record
+    private val DICTIONARY = arrayOf(
+        "sin⁻¹(", "cos⁻¹(", "tan⁻¹(", "sin(", "cos(", "tan(", "ln(", "log₂(", "log(", "exp(",
+        "×", "÷", "√", "π", "−", "\u00A0", "\u202F", "\u2019"
+    )
+
+    class Writer {
+        var bytes = ByteArray(256)
+            private set
+        var size = 0
+            private set
+
+        fun reset() {
+            size = 0
+        }
+
+        fun byte(value: Int) {
+            ensureCapacity(size + 1)
+            bytes[size++] = value.toByte()
+        }
+
+        fun bytes(value: ByteArray) {
+            ensureCapacity(size + value.size)
+            System.arraycopy(value, 0, bytes, size, value.size)
+            size += value.size
+        }
+
+        fun varint(value: Long) {
+            var remaining = value
+            while (remaining and 0x7FL.inv() != 0L) {
+                byte(((remaining and 0x7F) or 0x80).toInt())
+                remaining = remaining ushr 7
+            }
+            byte(remaining.toInt())
+        }
+
+        fun long(value: Long) {
+            for (shift in 56 downTo 0 step 8) byte((value ushr shift).toInt())
+        }
+
+        private fun ensureCapacity(required: Int) {
+            if (required > bytes.size) bytes = bytes.copyOf(maxOf(required, bytes.size * 2))
+        }
+    }
+
+    class Reader(private val buffer: ByteBuffer, var position: Int) {
+        fun byte(): Int = buffer.get(position++).toInt() and 0xFF
+
+        fun bytes(length: Int): ByteArray {
+            val bytes = ByteArray(length)
+            for (i in 0 until length) bytes[i] = buffer.get(position + i)
+            position += length
+            return bytes
+        }
+
+        fun varint(): Long {
+            var value = 0L
+            var shift = 0
+            while (shift < 64) {
+                val byte = byte()
+                value = value or ((byte and 0x7F).toLong() shl shift)
+                if (byte and 0x80 == 0) return value
+                shift += 7
+            }
+            throw IllegalStateException("Malformed varint")
+        }
+
+        fun long(): Long {
+            var value = 0L
+            for (i in 0 until 8) value = (value shl 8) or byte().toLong()
+            return value
+        }
+    }
+
+    fun varintSize(value: Long): Int {
+        var size = 1
+        var remaining = value ushr 7
+        while (remaining != 0L) {
+            size++
+            remaining = remaining ushr 7
+        }
+        return size
+    }
+
+    fun encode(history: History, sequence: Long, writer: Writer) {
+        writer.varint(sequence)
+        val time = history.time.takeUnless { it.isNullOrEmpty() }?.toLongOrNull()
+        writer.varint(if (time == null || time < 0) 0 else time + 1)
+        encodeId(history.id, writer)
+        encodeText(history.calculation, writer)
+        encodeText(history.result, writer)
+        encodeExact(history.exact, writer)
+        encodeFlags(history, writer)
+    }
+
+    fun decode(reader: Reader): History {
+        reader.varint() // sequence
+        val time = reader.varint()
+        val id = decodeId(reader)
+        val calculation = decodeText(reader)
+        val result = decodeText(reader)
+        val exact = decodeExact(reader)
+        val flags = reader.byte()
+        return History(
+            calculation = calculation,
+            result = result,
+            time = if (time == 0L) "" else (time - 1).toString(),
+            id = id,
+            exact = exact,
+            format = if (flags and FLAG_FORMAT != 0) decodeText(reader) else null,
+            isDegreeModeActivated = if (flags and FLAG_ANGLE_UNIT != 0) flags and FLAG_DEGREE != 0 else null
+        )
+    }
+
+    fun decodeSequence(reader: Reader): Long = reader.varint()
+
+    // Only the id, for the store to index records without decoding them
+    fun decodeIdOnly(reader: Reader): String {
+        reader.varint() // sequence
+        reader.varint() // time
+        return decodeId(reader)
+    }
+
+    private fun encodeId(id: String, writer: Writer) {
+        val uuid = try {
+            UUID.fromString(id).takeIf { it.toString() == id }
+        } catch (e: IllegalArgumentException) {
+            null
+        }
+        if (uuid != null) {
+            writer.byte(ID_UUID)
+            writer.long(uuid.mostSignificantBits)
+            writer.long(uuid.leastSignificantBits)
+        } else {
+            val bytes = id.toByteArray(StandardCharsets.UTF_8)
+            writer.byte(ID_STRING)
+            writer.varint(bytes.size.toLong())
+            writer.bytes(bytes)
+        }
+    }
+
+    private fun decodeId(reader: Reader): String {
+        return when (reader.byte()) {
+            ID_UUID -> UUID(reader.long(), reader.long()).toString()
+            else -> String(reader.bytes(reader.varint().toInt()), StandardCharsets.UTF_8)
+        }
+    }
+
+    private fun encodeText(text: String, writer: Writer) {
+        writer.varint(tokenize(text, null).toLong())
+        tokenize(text, writer)
+    }
+
+    // Write the tokens of [text] to [writer], if any, and return their size in bytes
+    private fun tokenize(text: String, writer: Writer?): Int {
+        var size = 0
+        var i = 0
+        while (i < text.length) {
+            val char = text[i]
+            if (char in '0'..'9') {
+                var end = i
+                while (end < text.length && text[end] in '0'..'9') end++
+                val count = end - i
+                if (count >= MIN_PACKED_DIGITS) {
+                    size += 1 + varintSize(count.toLong()) + (count + 1) / 2
+                    writer?.let { encodeDigits(text, i, end, it) }
+                } else {
+                    size += count
+                    if (writer != null) for (j in i until end) writer.byte(text[j].code)
+                }
+                i = end
+                continue
+            }
+            val entry = dictionaryEntryAt(text, i)
+            if (entry >= 0) {
+                size++
+                writer?.byte(TOKEN_DICTIONARY + entry)
+                i += DICTIONARY[entry].length
+            } else if (char.code in 0x20..0x7E) {
+                size++
+                writer?.byte(char.code)
+                i++
+            } else {
+                // Keep surrogate pairs together
+                val end = if (char.isHighSurrogate() && i + 1 < text.length) i + 2 else i + 1
+                val bytes = text.substring(i, end).toByteArray(StandardCharsets.UTF_8)
+                size += 1 + varintSize(bytes.size.toLong()) + bytes.size
+                writer?.let {
+                    it.byte(TOKEN_UTF8)
+                    it.varint(bytes.size.toLong())
+                    it.bytes(bytes)
+                }
+                i = end
+            }
+        }
+        return size
+    }
+
+    private fun decodeText(reader: Reader): String {
+        val length = reader.varint().toInt()
+        val end = reader.position + length
+        val builder = StringBuilder(length)
+        while (reader.position < end) {
+            val token = reader.byte()
+            when {
+                token >= TOKEN_DICTIONARY -> builder.append(DICTIONARY[token - TOKEN_DICTIONARY])
+                token == TOKEN_DIGITS -> {
+                    val count = reader.varint().toInt()
+                    for (k in 0 until count step 2) {
+                        val byte = reader.byte()
+                        builder.append('0' + (byte ushr 4))
+                        if (k + 1 < count) builder.append('0' + (byte and 0x0F))
+                    }
+                }
+                token == TOKEN_UTF8 -> builder.append(String(reader.bytes(reader.varint().toInt()), StandardCharsets.UTF_8))
+                else -> builder.append(token.toChar())
+            }
+        }
+        return builder.toString()
+    }
+
+    private fun encodeDigits(text: String, start: Int, end: Int, writer: Writer) {
+        writer.byte(TOKEN_DIGITS)
+        writer.varint((end - start).toLong())
+        var i = start
+        while (i < end) {
+            val high = text[i] - '0'
+            val low = if (i + 1 < end) text[i + 1] - '0' else 0
+            writer.byte((high shl 4) or low)
+            i += 2
+        }
+    }
+
+    private fun dictionaryEntryAt(text: String, index: Int): Int {
+        for (entry in DICTIONARY.indices) {
+            if (text.startsWith(DICTIONARY[entry], index)) return entry
+        }
+        return -1
+    }
+
+    private fun encodeExact(exact: BigDecimal?, writer: Writer) {
+        if (exact == null) {
+            writer.byte(EXACT_NONE)
+            return
+        }
+        val scale = exact.scale().toLong()
+        val unscaled = exact.unscaledValue().toByteArray()
+        writer.byte(EXACT_DECIMAL)
+        writer.varint((scale shl 1) xor (scale shr 63))
+        writer.varint(unscaled.size.toLong())
+        writer.bytes(unscaled)
+    }
+
+    private fun encodeFlags(history: History, writer: Writer) {
+        val format = history.format
+        val isDegreeModeActivated = history.isDegreeModeActivated
+        var flags = 0
+        if (format != null) flags = flags or FLAG_FORMAT
+        if (isDegreeModeActivated != null) flags = flags or FLAG_ANGLE_UNIT
+        if (isDegreeModeActivated == true) flags = flags or FLAG_DEGREE
+        writer.byte(flags)
+        if (format != null) encodeText(format, writer)
+    }
+
+    private fun decodeExact(reader: Reader): BigDecimal? {
+        if (reader.byte() != EXACT_DECIMAL) return null
+        val zigzag = reader.varint()
+        val scale = ((zigzag ushr 1) xor -(zigzag and 1)).toInt()
+        val unscaled = BigInteger(reader.bytes(reader.varint().toInt()))
+        return BigDecimal(unscaled, scale)
+    }
+}
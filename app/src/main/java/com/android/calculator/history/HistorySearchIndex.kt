@@ -0,0 +1,219 @@
+package com.android.calculator.history
+
+import java.math.BigDecimal
+import java.text.DecimalFormatSymbols
+import java.util.BitSet
+
+/**
+ * In-memory search index over the history, maintained incrementally by [HistoryStore].
+ *
+ * Calculations are indexed by trigram: every substring query of three characters or more is
+ * answered by intersecting the posting lists of its trigrams, and only the few remaining
+ * candidates have to be checked against the stored calculation. Results are kept in a sorted
+ * numeric index so that range queries are two binary searches.
+ *
+ * Documents are identified by the order in which they were added.
+ */
+class HistorySearchIndex(
+    private val groupingSeparator: Char = DecimalFormatSymbols.getInstance().groupingSeparator,
+    private val decimalSeparator: Char = DecimalFormatSymbols.getInstance().decimalSeparator
+) {
+
+    private class IntList(capacity: Int = 4) {
+        var values = IntArray(capacity)
+        var size = 0
+
+        fun add(value: Int) {
+            if (size == values.size) values = values.copyOf(size * 2)
+            values[size++] = value
+        }
+    }
+
+    private val postings = HashMap<Long, IntList>()
+    private val removed = BitSet()
+    private var documentCount = 0
+
+    // Sorted numeric index, with the values added since the last query waiting to be merged in
+    private var sortedValues = DoubleArray(0)
+    private var sortedDocuments = IntArray(0)
+    private var pendingValues = DoubleArray(16)
+    private var pendingDocuments = IntArray(16)
+    private var pendingCount = 0
+
+    val liveCount: Int
+        get() = documentCount - removed.cardinality()
+
+    /**
+     * @param exact exact value of the result, indexed instead of [result] when known
+     * @return the id of the new document
+     */
+    fun add(calculation: String, result: String, exact: BigDecimal? = null): Int {
+        val document = documentCount++
+        val text = normalize(calculation)
+        var previous = -1L
+        for (i in 0..text.length - 3) {
+            val trigram = trigram(text, i)
+            // Consecutive equal trigrams ("1111") only need one posting
+            if (trigram != previous) {
+                val list = postings.getOrPut(trigram) { IntList() }
+                if (list.size == 0 || list.values[list.size - 1] != document) list.add(document)
+            }
+            previous = trigram
+        }
+        (exact?.toDouble()?.takeIf { it.isFinite() } ?: parseResult(result))?.let { addValue(it, document) }
+        return document
+    }
+
+    fun remove(document: Int) {
+        removed.set(document)
+    }
+
+    /**
+     * Lowercase [text] and drop the grouping separators, so that "1,234" is found by "1234".
+     */
+    fun normalize(text: String): String {
+        val builder = StringBuilder(text.length)
+        for (char in text) {
+            if (char != groupingSeparator && !char.isWhitespace()) builder.append(char.lowercaseChar())
+        }
+        return builder.toString()
+    }
+
+    /**
+     * Documents whose calculation may contain [normalizedQuery], in increasing id order.
+     * Every calculation containing the query is a candidate, but candidates still have to be
+     * checked against the calculation itself.
+     *
+     * @return null if the query is too short to be looked up by trigram
+     */
+    fun candidates(normalizedQuery: String): IntArray? {
+        if (normalizedQuery.length < 3) return null
+        val lists = ArrayList<IntList>()
+        val seen = HashSet<Long>()
+        for (i in 0..normalizedQuery.length - 3) {
+            val trigram = trigram(normalizedQuery, i)
+            if (!seen.add(trigram)) continue
+            lists.add(postings[trigram] ?: return IntArray(0))
+        }
+        lists.sortBy { it.size }
+
+        val candidates = lists[0].values.copyOf(lists[0].size)
+        var count = candidates.size
+        for (l in 1 until lists.size) {
+            count = intersect(candidates, count, lists[l])
+            if (count == 0) break
+        }
+        var live = 0
+        for (i in 0 until count) {
+            if (!removed.get(candidates[i])) candidates[live++] = candidates[i]
+        }
+        return candidates.copyOf(live)
+    }
+
+    /**
+     * Documents whose result lies in [min, max], in increasing result order.
+     */
+    fun range(min: Double, max: Double): IntArray {
+        mergePending()
+        val from = lowerBound(min)
+        val to = upperBound(max)
+        val documents = IntList(maxOf(to - from, 1))
+        for (i in from until to) {
+            if (!removed.get(sortedDocuments[i])) documents.add(sortedDocuments[i])
+        }
+        return documents.values.copyOf(documents.size)
+    }
+
+    fun parseResult(result: String): Double? {
+        val builder = StringBuilder(result.length)
+        for (char in result) {
+            when (char) {
+                groupingSeparator -> {}
+                decimalSeparator -> builder.append('.')
+                '−' -> builder.append('-')
+                else -> builder.append(char)
+            }
+        }
+        return builder.toString().toDoubleOrNull()?.takeUnless { it.isNaN() }
+    }
+
+    private fun trigram(text: String, index: Int): Long {
+        return (text[index].code.toLong() shl 32) or
+            (text[index + 1].code.toLong() shl 16) or
+            text[index + 2].code.toLong()
+    }
+
+    // Intersect the first [count] sorted values of [candidates] with [list], in place
+    private fun intersect(candidates: IntArray, count: Int, list: IntList): Int {
+        var i = 0
+        var j = 0
+        var size = 0
+        while (i < count && j < list.size) {
+            val a = candidates[i]
+            val b = list.values[j]
+            when {
+                a < b -> i++
+                a > b -> j++
+                else -> {
+                    candidates[size++] = a
+                    i++
+                    j++
+                }
+            }
+        }
+        return size
+    }
+
+    private fun addValue(value: Double, document: Int) {
+        if (pendingCount == pendingValues.size) {
+            pendingValues = pendingValues.copyOf(pendingCount * 2)
+            pendingDocuments = pendingDocuments.copyOf(pendingCount * 2)
+        }
+        pendingValues[pendingCount] = value
+        pendingDocuments[pendingCount] = document
+        pendingCount++
+    }
+
+    private fun mergePending() {
+        if (pendingCount == 0) return
+        val pending = (0 until pendingCount).sortedBy { pendingValues[it] }
+        val values = DoubleArray(sortedValues.size + pendingCount)
+        val documents = IntArray(values.size)
+        var i = 0
+        var j = 0
+        var k = 0
+        while (i < sortedValues.size || j < pending.size) {
+            if (j >= pending.size || (i < sortedValues.size && sortedValues[i] <= pendingValues[pending[j]])) {
+                values[k] = sortedValues[i]
+                documents[k++] = sortedDocuments[i++]
+            } else {
+                values[k] = pendingValues[pending[j]]
+                documents[k++] = pendingDocuments[pending[j++]]
+            }
+        }
+        sortedValues = values
+        sortedDocuments = documents
+        pendingCount = 0
+    }
+
+    private fun lowerBound(value: Double): Int {
+        var low = 0
+        var high = sortedValues.size
+        while (low < high) {
+            val middle = (low + high) ushr 1
+            if (sortedValues[middle] < value) low = middle + 1 else high = middle
+        }
+        return low
+    }
+
+    // Index of the first value greater than [value]
+    private fun upperBound(value: Double): Int {
+        var low = 0
+        var high = sortedValues.size
+        while (low < high) {
+            val middle = (low + high) ushr 1
+            if (sortedValues[middle] <= value) low = middle + 1 else high = middle
+        }
+        return low
+    }
+}
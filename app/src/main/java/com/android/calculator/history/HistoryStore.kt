@@ -0,0 +1,508 @@
+package com.android.calculator.history
+
+import android.content.Context
+import java.io.Closeable
+import java.io.File
+import java.io.IOException
+import java.io.RandomAccessFile
+import java.nio.ByteOrder
+import java.nio.MappedByteBuffer
+import java.nio.channels.FileChannel
+
+/**
+ * Append-only, memory-mapped history log.
+ *
+ * Each history element is written once as a record made of a status byte, the length of its body
+ * and the body encoded by [HistoryRecordFormat]. Updating an element appends a new record carrying the same sequence number and
+ * flips the status byte of the previous one, so adding, updating, looking up or removing a single
+ * element never decodes or rewrites the rest of the history. Dead records are reclaimed by
+ * [compact] once they outweigh the live ones.
+ */
+class HistoryStore(private val file: File) : Closeable {
+
+    companion object {
+        private const val MAGIC = 0x48495354 // "HIST"
+        private const val VERSION = 1
+
+        // File header: magic, version, committed end of the log, reserved
+        private const val FILE_HEADER_SIZE = 16
+        private const val OFFSET_END = 8
+
+        private const val STATUS_DEAD: Byte = 0
+        private const val STATUS_LIVE: Byte = 1
+
+        private const val INITIAL_CAPACITY = 64 * 1024
+        private const val MIN_COMPACTION_WASTE = 64 * 1024
+
+        private const val FILE_NAME = "history.log"
+
+        const val DEFAULT_SEARCH_LIMIT = 100
+
+        @Volatile
+        private var instance: HistoryStore? = null
+
+        fun getInstance(context: Context): HistoryStore {
+            return instance ?: synchronized(this) {
+                instance ?: HistoryStore(File(context.applicationContext.filesDir, FILE_NAME)).also { instance = it }
+            }
+        }
+    }
+
+    // Shared between the id index and the ordered list, so an update only has to move the offset
+    private class Slot(val id: String, val sequence: Long, var offset: Int, var length: Int) {
+        var document = -1
+    }
+
+    private var channel: FileChannel
+    private var buffer: MappedByteBuffer
+
+    private val index = HashMap<String, Slot>()
+    // Live slots in sequence order; entries before [head] have already been removed
+    private var order = ArrayList<Slot>()
+    private var head = 0
+
+    private var end = FILE_HEADER_SIZE
+    private var nextSequence = 0L
+    private var liveBytes = 0L
+    private var deadBytes = 0L
+
+    // Built on the first search, then kept up to date on every write
+    private var searchIndex: HistorySearchIndex? = null
+    private val documents = ArrayList<Slot?>()
+
+    private val writer = HistoryRecordFormat.Writer()
+
+    init {
+        file.parentFile?.mkdirs()
+        channel = RandomAccessFile(file, "rw").channel
+        buffer = map(channel, capacityFor(channel.size()))
+        if (buffer.getInt(0) == MAGIC && buffer.getInt(4) == VERSION) {
+            load()
+        } else {
+            reset()
+        }
+    }
+
+    val size: Int
+        @Synchronized get() = order.size - head
+
+    @Synchronized
+    fun getAll(): MutableList<History> {
+        val list = ArrayList<History>(size)
+        for (i in head until order.size) {
+            list.add(read(order[i].offset))
+        }
+        return list
+    }
+
+    @Synchronized
+    fun get(id: String): History? {
+        val slot = index[id] ?: return null
+        return read(slot.offset)
+    }
+
+    @Synchronized
+    fun getAt(position: Int): History? {
+        if (position < 0 || position >= size) return null
+        return read(order[head + position].offset)
+    }
+
+    /**
+     * Decode up to [count] elements starting at [position] into [into].
+     *
+     * @return the number of decoded elements
+     */
+    @Synchronized
+    fun getRange(position: Int, count: Int, into: Array<History?>): Int {
+        val available = (size - position).coerceIn(0, minOf(count, into.size))
+        for (i in 0 until available) {
+            into[i] = read(order[head + position + i].offset)
+        }
+        return available
+    }
+
+    @Synchronized
+    fun positionOf(id: String): Int {
+        val slot = index[id] ?: return -1
+        return indexOf(slot) - head
+    }
+
+    @Synchronized
+    fun last(): History? {
+        return if (size > 0) read(order[order.size - 1].offset) else null
+    }
+
+    /**
+     * Elements whose calculation contains [query], most recently written first.
+     * Grouping separators and case are ignored.
+     */
+    @Synchronized
+    fun search(query: String, limit: Int = DEFAULT_SEARCH_LIMIT): List<History> {
+        val searchIndex = searchIndex()
+        val needle = searchIndex.normalize(query)
+        val results = ArrayList<History>()
+        if (needle.isEmpty() || limit <= 0) return results
+
+        val candidates = searchIndex.candidates(needle)
+        if (candidates == null) {
+            // Too short to be looked up by trigram
+            for (i in order.size - 1 downTo head) {
+                val history = read(order[i].offset)
+                if (searchIndex.normalize(history.calculation).contains(needle)) {
+                    results.add(history)
+                    if (results.size == limit) break
+                }
+            }
+        } else {
+            for (i in candidates.size - 1 downTo 0) {
+                val slot = documents[candidates[i]] ?: continue
+                val history = read(slot.offset)
+                if (searchIndex.normalize(history.calculation).contains(needle)) {
+                    results.add(history)
+                    if (results.size == limit) break
+                }
+            }
+        }
+        return results
+    }
+
+    /**
+     * Elements whose result lies in [min, max], by increasing result.
+     * Results that are not numbers are never returned.
+     */
+    @Synchronized
+    fun searchResultRange(min: Double, max: Double, limit: Int = DEFAULT_SEARCH_LIMIT): List<History> {
+        val results = ArrayList<History>()
+        if (min > max || limit <= 0) return results
+        for (document in searchIndex().range(min, max)) {
+            val slot = documents[document] ?: continue
+            results.add(read(slot.offset))
+            if (results.size == limit) break
+        }
+        return results
+    }
+
+    /**
+     * Add a history element at the end of the history.
+     * An element whose id is already stored is updated in place instead.
+     */
+    @Synchronized
+    fun append(history: History) {
+        if (index.containsKey(history.id)) {
+            update(history.id, history)
+            return
+        }
+        val slot = writeRecord(history, nextSequence++)
+        index[slot.id] = slot
+        order.add(slot)
+        liveBytes += slot.length
+        addDocument(slot, history)
+    }
+
+    /**
+     * Replace the element stored under [id], keeping its position in the history.
+     *
+     * @return false if no element is stored under [id]
+     */
+    @Synchronized
+    fun update(id: String, history: History): Boolean {
+        val slot = index[id] ?: return false
+        val record = writeRecord(if (history.id == id) history else history.copy(id = id), slot.sequence)
+        markDead(slot.offset)
+        deadBytes += slot.length
+        liveBytes += record.length - slot.length
+        slot.offset = record.offset
+        slot.length = record.length
+        if (searchIndex != null) {
+            removeDocument(slot)
+            addDocument(slot, history)
+        }
+        compactIfWasteful()
+        return true
+    }
+
+    /**
+     * Replace [expected] with [history], unless it has been changed or removed in the meantime.
+     */
+    @Synchronized
+    fun updateIfUnchanged(expected: History, history: History): Boolean {
+        val slot = index[expected.id] ?: return false
+        if (read(slot.offset) != expected) return false
+        return update(expected.id, history)
+    }
+
+    @Synchronized
+    fun remove(id: String): Boolean {
+        val slot = index[id] ?: return false
+        removeSlot(slot, indexOf(slot))
+        return true
+    }
+
+    @Synchronized
+    fun removeAt(position: Int): Boolean {
+        if (position < 0 || position >= size) return false
+        removeSlot(order[head + position], head + position)
+        return true
+    }
+
+    /**
+     * Drop the oldest elements until at most [maxSize] remain.
+     */
+    @Synchronized
+    fun trimTo(maxSize: Int) {
+        while (size > maxSize) {
+            removeSlot(order[head], head)
+        }
+    }
+
+    @Synchronized
+    fun replaceAll(history: List<History>) {
+        reset()
+        for (element in history) {
+            append(element)
+        }
+    }
+
+    @Synchronized
+    fun clear() {
+        reset()
+    }
+
+    /**
+     * Rewrite the live records into a fresh log, dropping every dead one.
+     */
+    @Synchronized
+    fun compact() {
+        val compacted = File(file.parentFile, file.name + ".compact")
+        compacted.delete()
+        val live = ArrayList<Slot>(size)
+        RandomAccessFile(compacted, "rw").channel.use { target ->
+            val targetBuffer = map(target, capacityFor(FILE_HEADER_SIZE + liveBytes))
+            var offset = FILE_HEADER_SIZE
+            for (i in head until order.size) {
+                val slot = order[i]
+                val source = buffer.duplicate()
+                source.limit(slot.offset + slot.length)
+                source.position(slot.offset)
+                targetBuffer.position(offset)
+                targetBuffer.put(source)
+                slot.offset = offset
+                offset += slot.length
+                live.add(slot)
+            }
+            targetBuffer.putInt(0, MAGIC)
+            targetBuffer.putInt(4, VERSION)
+            targetBuffer.putInt(OFFSET_END, offset)
+            targetBuffer.force()
+            end = offset
+        }
+        channel.close()
+        if (!compacted.renameTo(file)) {
+            throw IOException("Unable to replace ${file.name} with its compacted log")
+        }
+        channel = RandomAccessFile(file, "rw").channel
+        buffer = map(channel, capacityFor(channel.size()))
+        order = live
+        head = 0
+        deadBytes = 0
+    }
+
+    @Synchronized
+    override fun close() {
+        buffer.force()
+        channel.close()
+    }
+
+    private fun load() {
+        end = buffer.getInt(OFFSET_END).coerceIn(FILE_HEADER_SIZE, buffer.capacity())
+        val slots = LinkedHashMap<String, Slot>()
+        var offset = FILE_HEADER_SIZE
+        while (offset + 2 <= end) {
+            val length = recordLength(offset)
+            if (length <= 2 || offset + length > end) break
+            val sequence = HistoryRecordFormat.decodeSequence(HistoryRecordFormat.Reader(buffer, bodyOffset(offset)))
+            nextSequence = maxOf(nextSequence, sequence + 1)
+            if (buffer.get(offset) == STATUS_LIVE) {
+                val slot = Slot(readId(offset), sequence, offset, length)
+                // An update interrupted before its former record was marked dead: the later record wins
+                slots.put(slot.id, slot)?.let {
+                    markDead(it.offset)
+                    deadBytes += it.length
+                    liveBytes -= it.length
+                }
+                liveBytes += length
+            } else {
+                deadBytes += length
+            }
+            offset += length
+        }
+        end = offset
+        index.putAll(slots)
+        order = ArrayList(slots.values)
+        order.sortBy { it.sequence }
+        head = 0
+    }
+
+    private fun reset() {
+        buffer.putInt(0, MAGIC)
+        buffer.putInt(4, VERSION)
+        buffer.putInt(OFFSET_END, FILE_HEADER_SIZE)
+        end = FILE_HEADER_SIZE
+        index.clear()
+        order = ArrayList()
+        head = 0
+        searchIndex = null
+        documents.clear()
+        nextSequence = 0
+        liveBytes = 0
+        deadBytes = 0
+    }
+
+    // Index of a live slot in [order], found by its sequence: the live slots are sorted by it
+    private fun indexOf(slot: Slot): Int {
+        var low = head
+        var high = order.size - 1
+        while (low <= high) {
+            val middle = (low + high) ushr 1
+            val sequence = order[middle].sequence
+            when {
+                sequence < slot.sequence -> low = middle + 1
+                sequence > slot.sequence -> high = middle - 1
+                else -> return middle
+            }
+        }
+        return -1
+    }
+
+    private fun removeSlot(slot: Slot, position: Int) {
+        markDead(slot.offset)
+        index.remove(slot.id)
+        removeDocument(slot)
+        liveBytes -= slot.length
+        deadBytes += slot.length
+        if (position == head) {
+            head++
+            if (head > 1024 && head > order.size / 2) {
+                order = ArrayList(order.subList(head, order.size))
+                head = 0
+            }
+        } else {
+            order.removeAt(position)
+        }
+        compactIfWasteful()
+    }
+
+    private fun searchIndex(): HistorySearchIndex {
+        searchIndex?.let { return it }
+        val created = HistorySearchIndex()
+        searchIndex = created
+        documents.clear()
+        for (i in head until order.size) {
+            val slot = order[i]
+            addDocument(slot, read(slot.offset))
+        }
+        return created
+    }
+
+    private fun addDocument(slot: Slot, history: History) {
+        val searchIndex = searchIndex ?: return
+        slot.document = searchIndex.add(history.calculation, history.result, history.exact)
+        documents.add(slot)
+    }
+
+    private fun removeDocument(slot: Slot) {
+        val searchIndex = searchIndex ?: return
+        if (slot.document < 0) return
+        searchIndex.remove(slot.document)
+        documents[slot.document] = null
+        slot.document = -1
+        // Postings of removed documents are only reclaimed by a rebuild
+        if (documents.size > 1024 && searchIndex.liveCount < documents.size / 4) {
+            this.searchIndex = null
+            documents.clear()
+        }
+    }
+
+    private fun compactIfWasteful() {
+        if (deadBytes > MIN_COMPACTION_WASTE && deadBytes > liveBytes) {
+            compact()
+        }
+    }
+
+    private fun writeRecord(history: History, sequence: Long): Slot {
+        writer.reset()
+        HistoryRecordFormat.encode(history, sequence, writer)
+        val bodyLength = writer.size
+        val length = 1 + HistoryRecordFormat.varintSize(bodyLength.toLong()) + bodyLength
+
+        ensureCapacity(end + length)
+        val offset = end
+        buffer.put(offset, STATUS_LIVE)
+        var position = offset + 1
+        var remaining = bodyLength
+        while (remaining >= 0x80) {
+            buffer.put(position++, ((remaining and 0x7F) or 0x80).toByte())
+            remaining = remaining ushr 7
+        }
+        buffer.put(position++, remaining.toByte())
+        buffer.position(position)
+        buffer.put(writer.bytes, 0, bodyLength)
+
+        // The record only becomes visible once the committed end moves past it
+        end = offset + length
+        buffer.putInt(OFFSET_END, end)
+        return Slot(history.id, sequence, offset, length)
+    }
+
+    private fun read(offset: Int): History {
+        return HistoryRecordFormat.decode(HistoryRecordFormat.Reader(buffer, bodyOffset(offset)))
+    }
+
+    private fun readId(offset: Int): String {
+        return HistoryRecordFormat.decodeIdOnly(HistoryRecordFormat.Reader(buffer, bodyOffset(offset)))
+    }
+
+    private fun bodyOffset(offset: Int): Int {
+        var position = offset + 1
+        while (buffer.get(position).toInt() and 0x80 != 0) position++
+        return position + 1
+    }
+
+    // -1 if the record is cut short, e.g. by a write interrupted before its end was committed
+    private fun recordLength(offset: Int): Int {
+        var bodyLength = 0L
+        var shift = 0
+        var position = offset + 1
+        while (position < end && shift < 35) {
+            val byte = buffer.get(position++).toInt()
+            bodyLength = bodyLength or ((byte and 0x7F).toLong() shl shift)
+            if (byte and 0x80 == 0) {
+                val length = position - offset + bodyLength
+                return if (length > Int.MAX_VALUE) -1 else length.toInt()
+            }
+            shift += 7
+        }
+        return -1
+    }
+
+    private fun markDead(offset: Int) {
+        buffer.put(offset, STATUS_DEAD)
+    }
+
+    private fun ensureCapacity(required: Int) {
+        if (required <= buffer.capacity()) return
+        buffer = map(channel, capacityFor(required.toLong()))
+    }
+
+    private fun capacityFor(required: Long): Int {
+        var capacity = INITIAL_CAPACITY.toLong()
+        while (capacity < required) capacity *= 2
+        return capacity.coerceAtMost(Int.MAX_VALUE.toLong()).toInt()
+    }
+
+    private fun map(channel: FileChannel, capacity: Int): MappedByteBuffer {
+        val mapped = channel.map(FileChannel.MapMode.READ_WRITE, 0, capacity.toLong())
+        mapped.order(ByteOrder.LITTLE_ENDIAN)
+        return mapped
+    }
+}
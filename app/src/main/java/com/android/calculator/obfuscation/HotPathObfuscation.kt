@@ -0,0 +1,70 @@
+package com.android.calculator.obfuscation
+
+import com.android.calculator.BuildConfig
+
+/**
+ * Hot Path Obfuscation
+ * Build-time policy for the obfuscation wrappers of the arithmetic hot path
+ *
+ * The calculator engine runs for every key typed, and wrapping each operation in the full set of
+ * control flow constructs costs more than the operation itself. Code on the hot path uses these
+ * wrappers instead of [ObfuscationManager.StaticObfuscation]; the level is a BuildConfig constant,
+ * so the compiler drops the disabled constructs and the lambdas are inlined. Cold paths keep
+ * calling [ObfuscationManager] directly.
+ *
+ * The level is set per flavor in build.gradle.kts and can be overridden with
+ * `-PhotPathObfuscation=none|single|full`. Run `./gradlew :app:benchmarkObfuscation` to measure
+ * the cost of each construct.
+ */
+object HotPathObfuscation {
+
+    /** No wrapper: the code runs as written */
+    const val NONE = 0
+
+    /** Only the outermost [guarded] construct of an operation */
+    const val SINGLE = 1
+
+    /** Every construct, as with [ObfuscationManager.StaticObfuscation] */
+    const val FULL = 2
+
+    const val LEVEL = BuildConfig.HOT_PATH_OBFUSCATION
+
+    /**
+     * Outermost construct of a hot path operation, kept from [SINGLE] up
+     */
+    inline fun <T> guarded(crossinline block: () -> T): T {
+        return if (LEVEL >= SINGLE) {
+            ObfuscationManager.StaticObfuscation.executeWithObfuscationReturn { block() }
+        } else {
+            block()
+        }
+    }
+
+    /**
+     * Opaque branching around [realLogic], kept at [FULL] only
+     */
+    inline fun <T> branch(crossinline realLogic: () -> T): T {
+        return if (LEVEL >= FULL) {
+            ObfuscationManager.StaticObfuscation.obfuscatedBranch { realLogic() }
+        } else {
+            realLogic()
+        }
+    }
+
+    /**
+     * Noisy condition evaluation, kept at [FULL] only
+     */
+    inline fun <T> conditional(
+        condition: Boolean,
+        crossinline trueAction: () -> T,
+        crossinline falseAction: () -> T
+    ): T {
+        return if (LEVEL >= FULL) {
+            ObfuscationManager.StaticObfuscation.conditionalExecution(condition, { trueAction() }, { falseAction() })
+        } else if (condition) {
+            trueAction()
+        } else {
+            falseAction()
+        }
+    }
+}
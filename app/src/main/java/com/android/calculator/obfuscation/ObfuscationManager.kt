@@ -1,6 +1,7 @@
 ﻿package com.android.calculator.obfuscation
 
 import android.content.Context
+import com.android.calculator.calculator.PhaseTimer
 import com.android.calculator.obfuscation.static.AdvancedObfuscator
 import com.android.calculator.obfuscation.static.StringObfuscator
 import com.android.calculator.obfuscation.static.ControlFlowObfuscator
@@ -67,21 +68,27 @@ object ObfuscationManager {
                 block()
                 return
             }
-            ControlFlowObfuscator.executeWithObfuscation(block)
+            PhaseTimer.measure(PhaseTimer.Phase.OBFUSCATION) {
+                ControlFlowObfuscator.executeWithObfuscation { PhaseTimer.passThrough(block) }
+            }
         }
         
         fun <T> executeWithObfuscationReturn(block: () -> T): T {
             if (com.android.calculator.BuildConfig.DEBUG) {
                 return block()
             }
-            return ControlFlowObfuscator.executeWithObfuscation(block)
+            return PhaseTimer.measure(PhaseTimer.Phase.OBFUSCATION) {
+                ControlFlowObfuscator.executeWithObfuscation { PhaseTimer.passThrough(block) }
+            }
         }
         
         fun <T> obfuscatedBranch(realLogic: () -> T): T {
             if (com.android.calculator.BuildConfig.DEBUG) {
                 return realLogic()
             }
-            return FlowObfuscator.obfuscatedBranch(realLogic)
+            return PhaseTimer.measure(PhaseTimer.Phase.OBFUSCATION) {
+                FlowObfuscator.obfuscatedBranch { PhaseTimer.passThrough(realLogic) }
+            }
         }
         
         fun <T> conditionalExecution(
@@ -89,7 +96,16 @@ object ObfuscationManager {
             trueAction: () -> T, 
             falseAction: () -> T
         ): T {
-            return FlowObfuscator.conditionalExecution(condition, trueAction, falseAction)
+            if (com.android.calculator.BuildConfig.DEBUG) {
+                return if (condition) trueAction() else falseAction()
+            }
+            return PhaseTimer.measure(PhaseTimer.Phase.OBFUSCATION) {
+                FlowObfuscator.conditionalExecution(
+                    condition,
+                    { PhaseTimer.passThrough(trueAction) },
+                    { PhaseTimer.passThrough(falseAction) }
+                )
+            }
         }
         
         fun <T> flattenedExecution(vararg actions: () -> T): T {
@@ -0,0 +1,185 @@
+package com.android.calculator.plot
+
+import com.android.calculator.calculator.Calculator
+import com.android.calculator.calculator.compiler.MathFunction
+import com.android.calculator.calculator.compiler.Program
+import com.android.calculator.calculator.compiler.ProgramCache
+import java.math.BigDecimal
+import kotlin.math.abs
+import kotlin.math.acos
+import kotlin.math.asin
+import kotlin.math.atan
+import kotlin.math.cos
+import kotlin.math.exp
+import kotlin.math.floor
+import kotlin.math.ln
+import kotlin.math.log10
+import kotlin.math.log2
+import kotlin.math.pow
+import kotlin.math.sin
+import kotlin.math.sqrt
+import kotlin.math.tan
+
+/**
+ * A function of x compiled once and evaluated in doubles over batches of x values.
+ *
+ * The kernel runs the instructions of a [Program] one at a time over a whole batch, each register
+ * being an array of [BATCH_SIZE] doubles, so that every step is a tight loop over contiguous
+ * values. Where the calculator would raise an error flag the kernel gives NaN, and the plot has a
+ * gap there.
+ *
+ * A kernel keeps its registers between calls and must only be used by one thread at a time.
+ */
+class PlotKernel private constructor(
+    program: Program,
+    private val isDegreeModeActivated: Boolean,
+    values: Map<String, BigDecimal>
+) {
+
+    companion object {
+        const val BATCH_SIZE = 256
+        const val VARIABLE_NAME = "x"
+
+        /**
+         * Compile [equation], a clean expression in which `x` is the variable; any other variable
+         * keeps its value in [values], and is NaN without one
+         */
+        fun compile(
+            equation: String,
+            isDegreeModeActivated: Boolean,
+            values: Map<String, BigDecimal> = emptyMap()
+        ): PlotKernel {
+            return PlotKernel(ProgramCache.get(equation), isDegreeModeActivated, values)
+        }
+
+        private const val MAX_EXPONENT = 10000.0
+        private const val MAX_FACTORIAL = 3000.0
+    }
+
+    private val count = program.instructionCount
+    private val opcodes = IntArray(count) { program.code[it * Program.STRIDE] }
+    private val operandsA = IntArray(count) { program.code[it * Program.STRIDE + 1] }
+    private val operandsB = IntArray(count) { program.code[it * Program.STRIDE + 2] }
+    private val result = program.result
+
+    /** Whether the expression has a syntax error, which makes every value NaN */
+    val hasSyntaxError = opcodes.contains(Program.SYNTAX_ERROR)
+
+    // Registers of x, the other variables being as constant as the constants
+    private val abscissas = BooleanArray(count) { register ->
+        opcodes[register] == Program.VARIABLE && program.variables[operandsA[register]] == VARIABLE_NAME
+    }
+
+    private val registers = Array(count) { register ->
+        DoubleArray(BATCH_SIZE).also { registerValues ->
+            // Constants are filled once
+            when {
+                opcodes[register] == Program.CONSTANT -> {
+                    registerValues.fill(program.constants[operandsA[register]].toDouble())
+                }
+                opcodes[register] == Program.VARIABLE && !abscissas[register] -> {
+                    registerValues.fill(values[program.variables[operandsA[register]]]?.toDouble() ?: Double.NaN)
+                }
+            }
+        }
+    }
+
+    fun evaluate(x: Double): Double {
+        val xs = DoubleArray(1)
+        val ys = DoubleArray(1)
+        xs[0] = x
+        evaluate(xs, ys, 0, 1)
+        return ys[0]
+    }
+
+    /**
+     * Write f(xs[i]) to ys[i] for i in [from] until [to]
+     */
+    fun evaluate(xs: DoubleArray, ys: DoubleArray, from: Int, to: Int) {
+        var start = from
+        while (start < to) {
+            val size = minOf(BATCH_SIZE, to - start)
+            if (hasSyntaxError) {
+                ys.fill(Double.NaN, start, start + size)
+            } else {
+                for (register in 0 until count) run(register, xs, start, size)
+                System.arraycopy(registers[result], 0, ys, start, size)
+            }
+            start += size
+        }
+    }
+
+    private fun run(register: Int, xs: DoubleArray, offset: Int, size: Int) {
+        val opcode = opcodes[register]
+        val out = registers[register]
+        // Operands that are not registers read the output, unused
+        val a = if (opcode in Program.NEGATE..Program.FUNCTION) registers[operandsA[register]] else out
+        val b = if (opcode in Program.ADD..Program.POWER) registers[operandsB[register]] else out
+        when (opcode) {
+            Program.CONSTANT -> {}
+            Program.VARIABLE -> if (abscissas[register]) System.arraycopy(xs, offset, out, 0, size)
+            Program.NEGATE -> for (i in 0 until size) out[i] = -a[i]
+            Program.ADD -> for (i in 0 until size) out[i] = a[i] + b[i]
+            Program.SUBTRACT -> for (i in 0 until size) out[i] = a[i] - b[i]
+            Program.MULTIPLY -> for (i in 0 until size) out[i] = a[i] * b[i]
+            Program.SQUARE -> for (i in 0 until size) out[i] = a[i] * a[i]
+            Program.DIVIDE -> for (i in 0 until size) {
+                // Same test as the calculator, sin(2π) included
+                out[i] = if (b[i].toFloat() == 0f || b[i] == -2.4492935982947064E-16) Double.NaN else a[i] / b[i]
+            }
+            Program.MODULO -> for (i in 0 until size) out[i] = if (b[i] == 0.0) Double.NaN else a[i] % b[i]
+            Program.POWER -> for (i in 0 until size) out[i] = power(a[i], b[i])
+            Program.FUNCTION -> function(operandsB[register], a, out, size)
+            else -> out.fill(Double.NaN, 0, size)
+        }
+    }
+
+    private fun power(x: Double, exponent: Double): Double {
+        return when {
+            x == 0.0 -> 0.0
+            exponent > MAX_EXPONENT -> Double.NaN
+            x < 0 && exponent != floor(exponent) -> Double.NaN
+            else -> x.pow(exponent)
+        }
+    }
+
+    private fun function(function: Int, a: DoubleArray, out: DoubleArray, size: Int) {
+        when (function) {
+            MathFunction.SQRT -> for (i in 0 until size) out[i] = if (a[i] < 0) Double.NaN else sqrt(a[i])
+            MathFunction.FACTORIAL -> for (i in 0 until size) out[i] = factorial(a[i])
+            MathFunction.LN -> for (i in 0 until size) out[i] = if (a[i] <= 0) Double.NaN else ln(a[i])
+            MathFunction.LOG_TWO -> for (i in 0 until size) out[i] = if (a[i] <= 0) Double.NaN else log2(a[i])
+            MathFunction.LOG_TEN -> for (i in 0 until size) out[i] = if (a[i] <= 0) Double.NaN else log10(a[i])
+            MathFunction.EXP -> for (i in 0 until size) out[i] = exp(a[i])
+            MathFunction.SIN -> for (i in 0 until size) out[i] = snapToZero(sin(toRadians(a[i])))
+            MathFunction.COS -> for (i in 0 until size) out[i] = snapToZero(cos(toRadians(a[i])))
+            MathFunction.TAN -> for (i in 0 until size) {
+                out[i] = if (Math.toDegrees(a[i]) == 90.0) Double.NaN else snapToZero(tan(toRadians(a[i])))
+            }
+            MathFunction.ARCSIN -> for (i in 0 until size) {
+                out[i] = if (abs(a[i]) > 1) Double.NaN else snapToZero(fromRadians(asin(a[i])))
+            }
+            MathFunction.ARCCOS -> for (i in 0 until size) {
+                out[i] = if (abs(a[i]) > 1) Double.NaN else snapToZero(fromRadians(acos(a[i])))
+            }
+            MathFunction.ARCTAN -> for (i in 0 until size) out[i] = snapToZero(fromRadians(atan(a[i])))
+            else -> out.fill(Double.NaN, 0, size)
+        }
+    }
+
+    private fun factorial(x: Double): Double {
+        if (x >= MAX_FACTORIAL || x < 0) return Double.NaN
+        if (x != floor(x)) return Calculator.gamma(x + 1)
+        var factorial = 1.0
+        var i = 2
+        while (i <= x && factorial < Double.POSITIVE_INFINITY) factorial *= i++
+        return factorial
+    }
+
+    private fun toRadians(x: Double): Double = if (isDegreeModeActivated) Math.toRadians(x) else x
+
+    private fun fromRadians(x: Double): Double = if (isDegreeModeActivated) x * 180 / Math.PI else x
+
+    // As the calculator does, so that sin(180) is 0 and not 1.2E-16
+    private fun snapToZero(x: Double): Double = if (x > 0 && x < 1.0E-14) 0.0 else x
+}
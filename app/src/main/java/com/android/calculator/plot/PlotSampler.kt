@@ -0,0 +1,173 @@
+package com.android.calculator.plot
+
+import kotlin.math.abs
+
+/**
+ * Samples a [PlotKernel] over a viewport into polylines.
+ *
+ * The function is first sampled once per pixel column, in one batch. The intervals whose ends
+ * are more than [MAX_STEP_PIXELS] apart vertically, or where the function is only defined at one
+ * end, are then halved, all of a pass in one batch, for at most [MAX_REFINEMENTS] passes. An
+ * interval that still jumps across the viewport at the finest step is a discontinuity, and the
+ * line is broken there rather than drawn through it.
+ *
+ * The sampler reuses its buffers from one frame to the next, so that panning and zooming do not
+ * allocate once they have reached their largest size.
+ */
+class PlotSampler {
+
+    companion object {
+        private const val MAX_STEP_PIXELS = 2.0
+        private const val MAX_REFINEMENTS = 10
+        // Points of a frame, over the width of the viewport in pixels
+        private const val MAX_POINTS_PER_PIXEL = 8
+    }
+
+    /** Viewport in function coordinates, and its size in pixels */
+    data class Viewport(
+        val xMin: Double,
+        val xMax: Double,
+        val yMin: Double,
+        val yMax: Double,
+        val width: Int,
+        val height: Int
+    )
+
+    // Sampled points in increasing x, and whether the interval to the next one is still halved
+    private var xs = DoubleArray(0)
+    private var ys = DoubleArray(0)
+    private var refine = BooleanArray(0)
+    private var size = 0
+
+    // Next pass, built from the current one
+    private var nextXs = DoubleArray(0)
+    private var nextYs = DoubleArray(0)
+    private var nextRefine = BooleanArray(0)
+    private var midXs = DoubleArray(0)
+    private var midYs = DoubleArray(0)
+
+    private var lines = FloatArray(0)
+
+    /** Number of points of the last call to [sample] */
+    val pointCount: Int
+        get() = size
+
+    /**
+     * Sample [kernel] over [viewport] and return the segments to draw, in pixels, as
+     * `x0, y0, x1, y1` quadruples for Canvas.drawLines. Only the first [lineCount] * 4 values
+     * of the returned array are meaningful.
+     */
+    fun sample(kernel: PlotKernel, viewport: Viewport): FloatArray {
+        val columns = maxOf(1, viewport.width)
+        val budget = columns * MAX_POINTS_PER_PIXEL
+        val xScale = (viewport.xMax - viewport.xMin) / columns
+        val yPixels = viewport.height / (viewport.yMax - viewport.yMin)
+
+        size = columns + 1
+        ensureCapacity(size)
+        for (i in 0 until size) xs[i] = viewport.xMin + i * xScale
+        kernel.evaluate(xs, ys, 0, size)
+        refine.fill(true, 0, size)
+
+        for (pass in 0 until MAX_REFINEMENTS) {
+            // Midpoints of the intervals still too coarse
+            var midCount = 0
+            for (i in 0 until size - 1) {
+                refine[i] = refine[i] && size + midCount < budget && isTooCoarse(ys[i], ys[i + 1], yPixels)
+                if (!refine[i]) continue
+                if (midCount == midXs.size) growMidpoints(midCount + 1)
+                midXs[midCount++] = (xs[i] + xs[i + 1]) / 2
+            }
+            refine[size - 1] = false
+            if (midCount == 0) break
+            kernel.evaluate(midXs, midYs, 0, midCount)
+
+            // Merge them in, keeping only the halves of refined intervals for the next pass
+            ensureNextCapacity(size + midCount)
+            var mid = 0
+            var next = 0
+            for (i in 0 until size) {
+                nextXs[next] = xs[i]
+                nextYs[next] = ys[i]
+                val midX = if (refine[i]) midXs[mid] else Double.NaN
+                val midY = if (refine[i]) midYs[mid++] else Double.NaN
+                // The midpoint of two consecutive doubles is one of them: nothing left to halve
+                if (refine[i] && midX > xs[i] && midX < xs[i + 1]) {
+                    nextRefine[next++] = true
+                    nextXs[next] = midX
+                    nextYs[next] = midY
+                    nextRefine[next++] = true
+                } else {
+                    nextRefine[next++] = false
+                }
+            }
+            swap()
+            size = next
+        }
+        return toLines(viewport, yPixels)
+    }
+
+    /** Number of segments in the array returned by the last call to [sample] */
+    var lineCount = 0
+        private set
+
+    private fun isTooCoarse(y0: Double, y1: Double, yPixels: Double): Boolean {
+        val finite0 = y0.isFinite()
+        val finite1 = y1.isFinite()
+        if (finite0 != finite1) return true
+        return finite0 && abs(y1 - y0) * yPixels > MAX_STEP_PIXELS
+    }
+
+    private fun toLines(viewport: Viewport, yPixels: Double): FloatArray {
+        if (lines.size < (size - 1) * 4) lines = FloatArray((size - 1) * 4)
+        val xPixels = viewport.width / (viewport.xMax - viewport.xMin)
+        var count = 0
+        for (i in 0 until size - 1) {
+            val y0 = ys[i]
+            val y1 = ys[i + 1]
+            if (!y0.isFinite() || !y1.isFinite()) continue
+            // Still steep after the last refinement: a jump, such as tan at 90°
+            if (refine[i] && abs(y1 - y0) * yPixels > viewport.height) continue
+            lines[count * 4] = ((xs[i] - viewport.xMin) * xPixels).toFloat()
+            lines[count * 4 + 1] = ((viewport.yMax - y0) * yPixels).toFloat()
+            lines[count * 4 + 2] = ((xs[i + 1] - viewport.xMin) * xPixels).toFloat()
+            lines[count * 4 + 3] = ((viewport.yMax - y1) * yPixels).toFloat()
+            count++
+        }
+        lineCount = count
+        return lines
+    }
+
+    private fun ensureCapacity(capacity: Int) {
+        if (xs.size >= capacity) return
+        xs = DoubleArray(capacity)
+        ys = DoubleArray(capacity)
+        refine = BooleanArray(capacity)
+    }
+
+    private fun ensureNextCapacity(capacity: Int) {
+        if (nextXs.size >= capacity) return
+        val newCapacity = maxOf(capacity, nextXs.size * 2)
+        nextXs = DoubleArray(newCapacity)
+        nextYs = DoubleArray(newCapacity)
+        nextRefine = BooleanArray(newCapacity)
+    }
+
+    private fun growMidpoints(capacity: Int) {
+        val newCapacity = maxOf(capacity, midXs.size * 2, PlotKernel.BATCH_SIZE)
+        midXs = midXs.copyOf(newCapacity)
+        midYs = DoubleArray(newCapacity)
+    }
+
+    private fun swap() {
+        val swappedXs = xs
+        val swappedYs = ys
+        val swappedRefine = refine
+        xs = nextXs
+        ys = nextYs
+        refine = nextRefine
+        nextXs = swappedXs
+        nextYs = swappedYs
+        nextRefine = swappedRefine
+    }
+}
@@ -0,0 +1,139 @@
+package com.android.calculator.plot
+
+import android.content.Context
+import android.graphics.Canvas
+import android.graphics.Paint
+import android.util.AttributeSet
+import android.util.TypedValue
+import android.view.GestureDetector
+import android.view.MotionEvent
+import android.view.ScaleGestureDetector
+import android.view.View
+import com.android.calculator.R
+
+/**
+ * Plot of a function of x, panned by dragging and zoomed by pinching.
+ *
+ * The expression is compiled once by [setExpression]; every frame then only samples it over the
+ * visible range, which keeps panning and zooming at the display refresh rate.
+ */
+class PlotView @JvmOverloads constructor(
+    context: Context,
+    attrs: AttributeSet? = null,
+    defStyleAttr: Int = 0
+) : View(context, attrs, defStyleAttr) {
+
+    companion object {
+        private const val DEFAULT_HALF_RANGE = 10.0
+        private const val MIN_HALF_RANGE = 1.0E-9
+        private const val MAX_HALF_RANGE = 1.0E9
+    }
+
+    private var kernel: PlotKernel? = null
+    private val sampler = PlotSampler()
+
+    // Visible range, centered on (centerX, centerY); the y range follows the aspect ratio
+    private var centerX = 0.0
+    private var centerY = 0.0
+    private var halfRangeX = DEFAULT_HALF_RANGE
+
+    private val curvePaint = Paint(Paint.ANTI_ALIAS_FLAG).apply {
+        color = themeColor(R.attr.text_symbol_color)
+        strokeWidth = resources.displayMetrics.density * 2
+        style = Paint.Style.STROKE
+    }
+    private val axisPaint = Paint(Paint.ANTI_ALIAS_FLAG).apply {
+        color = themeColor(R.attr.separator_color)
+        strokeWidth = resources.displayMetrics.density
+    }
+
+    private val gestureDetector = GestureDetector(context, object : GestureDetector.SimpleOnGestureListener() {
+        override fun onDown(e: MotionEvent): Boolean = true
+
+        override fun onScroll(e1: MotionEvent?, e2: MotionEvent, distanceX: Float, distanceY: Float): Boolean {
+            val unitsPerPixel = 2 * halfRangeX / width.coerceAtLeast(1)
+            centerX += distanceX * unitsPerPixel
+            centerY -= distanceY * unitsPerPixel
+            postInvalidateOnAnimation()
+            return true
+        }
+
+        override fun onDoubleTap(e: MotionEvent): Boolean {
+            resetViewport()
+            return true
+        }
+    })
+
+    private val scaleDetector = ScaleGestureDetector(context, object : ScaleGestureDetector.SimpleOnScaleGestureListener() {
+        override fun onScale(detector: ScaleGestureDetector): Boolean {
+            val viewport = viewport()
+            // Keep the point under the fingers in place
+            val focusX = viewport.xMin + detector.focusX / width * (viewport.xMax - viewport.xMin)
+            val focusY = viewport.yMax - detector.focusY / height * (viewport.yMax - viewport.yMin)
+            val newHalfRange = (halfRangeX / detector.scaleFactor).coerceIn(MIN_HALF_RANGE, MAX_HALF_RANGE)
+            val ratio = newHalfRange / halfRangeX
+            centerX = focusX + (centerX - focusX) * ratio
+            centerY = focusY + (centerY - focusY) * ratio
+            halfRangeX = newHalfRange
+            postInvalidateOnAnimation()
+            return true
+        }
+    })
+
+    /**
+     * Plot [cleanExpression], as given by Expression.getCleanExpression, with `x` as variable.
+     */
+    fun setExpression(cleanExpression: String, isDegreeModeActivated: Boolean) {
+        kernel = PlotKernel.compile(cleanExpression, isDegreeModeActivated)
+        invalidate()
+    }
+
+    fun resetViewport() {
+        centerX = 0.0
+        centerY = 0.0
+        halfRangeX = DEFAULT_HALF_RANGE
+        invalidate()
+    }
+
+    override fun onTouchEvent(event: MotionEvent): Boolean {
+        scaleDetector.onTouchEvent(event)
+        if (!scaleDetector.isInProgress) gestureDetector.onTouchEvent(event)
+        return true
+    }
+
+    override fun onDraw(canvas: Canvas) {
+        super.onDraw(canvas)
+        if (width == 0 || height == 0) return
+        val viewport = viewport()
+
+        // Axes, when visible
+        if (viewport.xMin < 0 && viewport.xMax > 0) {
+            val x = (-viewport.xMin / (viewport.xMax - viewport.xMin) * width).toFloat()
+            canvas.drawLine(x, 0f, x, height.toFloat(), axisPaint)
+        }
+        if (viewport.yMin < 0 && viewport.yMax > 0) {
+            val y = (viewport.yMax / (viewport.yMax - viewport.yMin) * height).toFloat()
+            canvas.drawLine(0f, y, width.toFloat(), y, axisPaint)
+        }
+
+        val kernel = kernel ?: return
+        if (kernel.hasSyntaxError) return
+        val lines = sampler.sample(kernel, viewport)
+        canvas.drawLines(lines, 0, sampler.lineCount * 4, curvePaint)
+    }
+
+    private fun viewport(): PlotSampler.Viewport {
+        val halfRangeY = halfRangeX * height / width.coerceAtLeast(1)
+        return PlotSampler.Viewport(
+            centerX - halfRangeX, centerX + halfRangeX,
+            centerY - halfRangeY, centerY + halfRangeY,
+            width, height
+        )
+    }
+
+    private fun themeColor(attribute: Int): Int {
+        val value = TypedValue()
+        context.theme.resolveAttribute(attribute, value, true)
+        return value.data
+    }
+}
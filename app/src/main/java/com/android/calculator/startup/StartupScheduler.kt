@@ -0,0 +1,165 @@
+package com.android.calculator.startup
+
+import android.os.Handler
+import android.os.Looper
+import android.os.Trace
+import android.util.Log
+import android.view.View
+import android.view.ViewTreeObserver
+import java.util.concurrent.CountDownLatch
+import java.util.concurrent.ExecutorService
+import java.util.concurrent.Executors
+import java.util.concurrent.TimeUnit
+import java.util.concurrent.atomic.AtomicInteger
+
+/**
+ * Runs the work of a cold start in phases, so that only what the first frame needs is done
+ * before it.
+ *
+ * Each task declares its [Phase] and the tasks it depends on. [Phase.CRITICAL] tasks run at once
+ * on the thread registering them. The others run on background threads once their phase has
+ * started and their dependencies are done: [Phase.AFTER_FIRST_FRAME] when the first frame of the
+ * view given to [startAfterFirstFrame] is drawn, and [Phase.IDLE] when the main thread is idle
+ * after it. Each phase starts after a timeout at the latest, so that the tasks it holds, such as
+ * the security verdict, still run within a bounded time when there is no frame or no idle time.
+ */
+object StartupScheduler {
+
+    enum class Phase {
+        CRITICAL,
+        AFTER_FIRST_FRAME,
+        IDLE
+    }
+
+    private const val TAG = "Startup"
+    // Time after start() at which each phase starts, if it has not already
+    private const val FIRST_FRAME_TIMEOUT_MILLIS = 1_000L
+    private const val IDLE_TIMEOUT_MILLIS = 3_000L
+
+    private class Task(
+        val name: String,
+        val phase: Phase,
+        val dependencies: List<String>,
+        val block: () -> Unit
+    ) {
+        var isStarted = false
+        val done = CountDownLatch(1)
+
+        val isDone: Boolean
+            get() = done.count == 0L
+    }
+
+    private val lock = Any()
+    private val tasks = HashMap<String, Task>()
+    // Ordinal of the last phase started, -1 before start()
+    private var startedPhase = -1
+    private var isWaitingForFrame = false
+
+    private val mainHandler by lazy { Handler(Looper.getMainLooper()) }
+
+    private val executor: ExecutorService by lazy {
+        val threadCount = (Runtime.getRuntime().availableProcessors() - 1).coerceIn(1, 4)
+        val threadNumber = AtomicInteger()
+        Executors.newFixedThreadPool(threadCount) { runnable ->
+            Thread(runnable, "startup-${threadNumber.incrementAndGet()}").apply { isDaemon = true }
+        }
+    }
+
+    /**
+     * Register a task to run in [phase] after the tasks named in [dependencies], which must not
+     * be in a later phase. A dependency that is not registered yet is not waited for.
+     *
+     * A task that is done can be registered again, to run once more; returns false, and changes
+     * nothing, if a task with the same name is still waiting or running.
+     */
+    fun register(name: String, phase: Phase, dependencies: List<String> = emptyList(), block: () -> Unit): Boolean {
+        synchronized(lock) {
+            if (tasks[name]?.isDone == false) return false
+            for (dependency in dependencies) {
+                val task = tasks[dependency] ?: continue
+                require(task.phase <= phase) { "$name cannot depend on $dependency, which runs in a later phase" }
+            }
+            tasks[name] = Task(name, phase, dependencies, block)
+        }
+        dispatch()
+        return true
+    }
+
+    /** Start the critical phase, and the timeouts of the others: called once, from Application.onCreate */
+    fun start() {
+        startPhase(Phase.CRITICAL)
+        mainHandler.postDelayed({ startPhase(Phase.AFTER_FIRST_FRAME) }, FIRST_FRAME_TIMEOUT_MILLIS)
+        mainHandler.postDelayed({ startPhase(Phase.IDLE) }, IDLE_TIMEOUT_MILLIS)
+    }
+
+    /** Start the phases after the critical one once [view] has drawn its first frame */
+    fun startAfterFirstFrame(view: View) {
+        synchronized(lock) {
+            if (isWaitingForFrame || startedPhase >= Phase.AFTER_FIRST_FRAME.ordinal) return
+            isWaitingForFrame = true
+        }
+        view.viewTreeObserver.addOnDrawListener(object : ViewTreeObserver.OnDrawListener {
+            override fun onDraw() {
+                // A draw listener cannot be removed while drawing, and the frame is only done after it
+                mainHandler.postAtFrontOfQueue {
+                    if (!view.viewTreeObserver.isAlive) return@postAtFrontOfQueue
+                    view.viewTreeObserver.removeOnDrawListener(this)
+                    startPhase(Phase.AFTER_FIRST_FRAME)
+                    Looper.myQueue().addIdleHandler {
+                        startPhase(Phase.IDLE)
+                        false
+                    }
+                }
+            }
+        })
+    }
+
+    /** Wait until the task [name] is done, for at most [timeoutMillis]. Returns whether it is done. */
+    fun await(name: String, timeoutMillis: Long): Boolean {
+        val task = synchronized(lock) { tasks[name] } ?: return false
+        return task.done.await(timeoutMillis, TimeUnit.MILLISECONDS)
+    }
+
+    fun isDone(name: String): Boolean = synchronized(lock) { tasks[name]?.isDone == true }
+
+    private fun startPhase(phase: Phase) {
+        synchronized(lock) {
+            if (startedPhase >= phase.ordinal) return
+            startedPhase = phase.ordinal
+            Log.d(TAG, "Phase ${phase.name} started")
+        }
+        dispatch()
+    }
+
+    // Run the tasks that can run now
+    private fun dispatch() {
+        val ready = ArrayList<Task>()
+        synchronized(lock) {
+            for (task in tasks.values) {
+                if (task.isStarted || task.phase.ordinal > startedPhase) continue
+                if (task.dependencies.any { tasks[it]?.isDone == false }) continue
+                task.isStarted = true
+                ready.add(task)
+            }
+        }
+        for (task in ready) {
+            if (task.phase == Phase.CRITICAL) run(task) else executor.execute { run(task) }
+        }
+    }
+
+    private fun run(task: Task) {
+        val start = System.nanoTime()
+        Trace.beginSection("Startup.${task.name}")
+        try {
+            task.block()
+        } catch (e: Exception) {
+            // The tasks depending on it still run, and handle what it did not do
+            Log.e(TAG, "Startup task ${task.name} failed", e)
+        } finally {
+            Trace.endSection()
+            task.done.countDown()
+        }
+        Log.d(TAG, "Startup task ${task.name} done in ${(System.nanoTime() - start) / 1_000_000} ms")
+        dispatch()
+    }
+}
@@ -227,4 +227,31 @@ class NumberFormatterTest {
         val expected = "-12,34,567"
         assertEquals(expected, result)
     }
+
+    @Test
+    fun `given an expression with separators when formatting with the indian numbering system then every number is grouped again`() {
+        // Given
+        val expression = "1.234.567,89×12.34+,5"
+
+        // When
+        val result = NumberFormatter.format(expression, ",", ".", NumberingSystem.INDIAN)
+
+        // Then
+        val expected = "12.34.567,89×1.234+,5"
+        assertEquals(expected, result)
+    }
+
+    @Test
+    fun `given a huge number when formatting then every group of three digits is separated`() {
+        // Given
+        val number = "1" + "0".repeat(299_999)
+
+        // When
+        val result = NumberFormatter.format(number, ".", ",", NumberingSystem.INTERNATIONAL)
+
+        // Then
+        val expected = "100" + ",000".repeat(99_999)
+        assertEquals(expected.length, result.length)
+        assertEquals(expected, result)
+    }
 }
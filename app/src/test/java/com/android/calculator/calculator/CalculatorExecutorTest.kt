@@ -0,0 +1,28 @@
+package com.android.calculator.calculator
+
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertNotEquals
+import org.junit.Test
+import java.util.concurrent.Callable
+import java.util.concurrent.TimeUnit
+
+class CalculatorExecutorTest {
+
+    @Test
+    fun `given tasks submitted from a thread of the pool when running them then they run on that thread`() {
+        // Given
+        val executor = CalculatorExecutor.shared
+        val caller = Thread.currentThread()
+
+        // When
+        val (outer, inner) = executor.submit(Callable {
+            // As many tasks as threads, each waited for: queued, they could never start
+            val nested = (0..Runtime.getRuntime().availableProcessors()).map { Callable { Thread.currentThread() } }
+            Thread.currentThread() to executor.invokeAll(nested).map { it.get() }
+        }).get(10, TimeUnit.SECONDS)
+
+        // Then
+        assertNotEquals(caller, outer)
+        assertEquals(List(inner.size) { outer }, inner)
+    }
+}
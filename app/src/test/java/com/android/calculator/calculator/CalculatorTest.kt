@@ -0,0 +1,68 @@
+package com.android.calculator.calculator
+
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertFalse
+import org.junit.Assert.assertTrue
+import org.junit.Test
+import java.math.BigDecimal
+
+class CalculatorTest {
+
+    @Test
+    fun `given a non integer when computing its factorial then the gamma function is used`() {
+        // Given
+        val calculator = Calculator(10)
+
+        // When
+        val (result, errors) = CalculatorErrors.isolated { errors ->
+            calculator.factorial(BigDecimal("4.5")) to errors
+        }
+
+        // Then
+        assertFalse(errors.hasError)
+        // Γ(5.5) = 52.34277778455352...
+        assertEquals(52.34277778455352, result.toDouble(), 1e-9)
+    }
+
+    @Test
+    fun `given a chain of divisions and multiplications when evaluating then the result is exact`() {
+        // Given
+        val calculator = Calculator(10)
+
+        // When
+        val (result, errors) = CalculatorErrors.isolated { errors ->
+            calculator.evaluate("1/3*3+2/7*7/2", true) to errors
+        }
+
+        // Then
+        assertFalse(errors.hasError)
+        assertEquals(0, BigDecimal(2).compareTo(result))
+    }
+
+    @Test
+    fun `given a non terminating division when evaluating then it is rounded to the precision`() {
+        // Given
+        val calculator = Calculator(10)
+
+        // When
+        val result = CalculatorErrors.isolated { calculator.evaluate("2/3", true) }
+
+        // Then
+        assertEquals(BigDecimal("0.6666666667"), result)
+    }
+
+    @Test
+    fun `given terminating and non terminating results when evaluating then only the latter are flagged as rounded`() {
+        // Given
+        val calculator = Calculator(10)
+
+        // When
+        val rounded = CalculatorErrors.isolated { errors ->
+            listOf("2/3", "1/4", "1/3*3").map { calculator.evaluate(it, true); errors.isRounded }
+        }
+
+        // Then
+        assertTrue(rounded[0])
+        assertEquals(listOf(false, false), rounded.drop(1))
+    }
+}
@@ -0,0 +1,104 @@
+package com.android.calculator.calculator
+
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertTrue
+import org.junit.Test
+
+class PhaseTimerTest {
+
+    private fun stat(phase: PhaseTimer.Phase, name: String): Long {
+        return PhaseTimer.snapshot()[phase.key]!![name]!!
+    }
+
+    @Test
+    fun `given nested phases when measuring then each phase records its own time only`() {
+        // Given
+        val formatTotal = stat(PhaseTimer.Phase.FORMAT, "total_us")
+        val evaluateTotal = stat(PhaseTimer.Phase.EVALUATE, "total_us")
+        val resultTotal = stat(PhaseTimer.Phase.RESULT, "total_us")
+
+        // When
+        PhaseTimer.measure(PhaseTimer.Phase.RESULT) {
+            PhaseTimer.measure(PhaseTimer.Phase.FORMAT) {
+                Thread.sleep(20)
+                PhaseTimer.measure(PhaseTimer.Phase.EVALUATE) { Thread.sleep(60) }
+            }
+        }
+
+        // Then
+        val format = stat(PhaseTimer.Phase.FORMAT, "total_us") - formatTotal
+        val evaluate = stat(PhaseTimer.Phase.EVALUATE, "total_us") - evaluateTotal
+        val result = stat(PhaseTimer.Phase.RESULT, "total_us") - resultTotal
+        assertTrue("format: $format", format in 20_000 until 60_000)
+        assertTrue("evaluate: $evaluate", evaluate >= 60_000)
+        // Inclusive of everything it wraps
+        assertTrue("result: $result", result >= 80_000)
+    }
+
+    @Test
+    fun `given a wrapper passing its block through when measuring then the block is counted in the enclosing phase`() {
+        // Given
+        val obfuscationTotal = stat(PhaseTimer.Phase.OBFUSCATION, "total_us")
+        val evaluateTotal = stat(PhaseTimer.Phase.EVALUATE, "total_us")
+        val formatTotal = stat(PhaseTimer.Phase.FORMAT, "total_us")
+
+        // When
+        PhaseTimer.measure(PhaseTimer.Phase.EVALUATE) {
+            PhaseTimer.measure(PhaseTimer.Phase.OBFUSCATION) {
+                Thread.sleep(5)
+                PhaseTimer.passThrough {
+                    Thread.sleep(40)
+                    PhaseTimer.measure(PhaseTimer.Phase.FORMAT) { Thread.sleep(60) }
+                }
+            }
+        }
+
+        // Then
+        val obfuscation = stat(PhaseTimer.Phase.OBFUSCATION, "total_us") - obfuscationTotal
+        val evaluate = stat(PhaseTimer.Phase.EVALUATE, "total_us") - evaluateTotal
+        val format = stat(PhaseTimer.Phase.FORMAT, "total_us") - formatTotal
+        assertTrue("obfuscation: $obfuscation", obfuscation in 5_000 until 40_000)
+        assertTrue("evaluate: $evaluate", evaluate in 40_000 until 100_000)
+        assertTrue("format: $format", format >= 60_000)
+    }
+
+    @Test
+    fun `given a phase throwing when measuring then it is recorded and the enclosing phase is still accounted`() {
+        // Given
+        val resultCount = stat(PhaseTimer.Phase.RESULT, "count")
+        val formatTotal = stat(PhaseTimer.Phase.FORMAT, "total_us")
+
+        // When
+        try {
+            PhaseTimer.measure(PhaseTimer.Phase.RESULT) { throw IllegalStateException() }
+        } catch (e: IllegalStateException) {
+            // Expected
+        }
+        PhaseTimer.measure(PhaseTimer.Phase.FORMAT) {
+            PhaseTimer.measure(PhaseTimer.Phase.EVALUATE) { Thread.sleep(60) }
+        }
+
+        // Then
+        assertEquals(resultCount + 1, stat(PhaseTimer.Phase.RESULT, "count"))
+        val format = stat(PhaseTimer.Phase.FORMAT, "total_us") - formatTotal
+        assertTrue("format: $format", format < 60_000)
+    }
+
+    @Test
+    fun `given several threads recording when taking a snapshot then their records are merged`() {
+        // Given
+        val count = stat(PhaseTimer.Phase.OBFUSCATION, "count")
+        val threads = List(4) {
+            Thread {
+                repeat(1000) { PhaseTimer.measure(PhaseTimer.Phase.OBFUSCATION) {} }
+            }
+        }
+
+        // When
+        threads.forEach { it.start() }
+        threads.forEach { it.join() }
+
+        // Then
+        assertEquals(count + 4000, stat(PhaseTimer.Phase.OBFUSCATION, "count"))
+    }
+}
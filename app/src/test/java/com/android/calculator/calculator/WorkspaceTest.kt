@@ -0,0 +1,81 @@
+package com.android.calculator.calculator
+
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertFalse
+import org.junit.Assert.assertNull
+import org.junit.Assert.assertTrue
+import org.junit.Test
+import java.math.BigDecimal
+
+class WorkspaceTest {
+
+    @Test
+    fun `given variables depending on another when it changes then they are evaluated again`() {
+        // Given
+        val workspace = Workspace(10, true)
+        workspace.setValue("a", BigDecimal(3))
+        workspace.define("b", "a*2")
+        workspace.define("c", "b+a")
+        workspace.define("d", "a-1")
+
+        // When
+        workspace.setValue("a", BigDecimal(5))
+
+        // Then
+        assertEquals(0, BigDecimal(10).compareTo(workspace.value("b")))
+        assertEquals(0, BigDecimal(15).compareTo(workspace.value("c")))
+        assertEquals(0, BigDecimal(4).compareTo(workspace.value("d")))
+    }
+
+    @Test
+    fun `given a variable depending on itself when defining it then it is refused`() {
+        // Given
+        val workspace = Workspace(10, true)
+        workspace.define("a", "b+1")
+
+        // When
+        val defined = workspace.define("b", "a*2")
+
+        // Then
+        assertFalse(defined)
+        assertNull(workspace.value("b"))
+        // a reads b, which is not defined
+        assertNull(workspace.value("a"))
+    }
+
+    @Test
+    fun `given a calculation when evaluating then its result is kept as ans`() {
+        // Given
+        val workspace = Workspace(10, true)
+        workspace.memoryAdd(BigDecimal(4))
+
+        // When
+        val (result, errors) = CalculatorErrors.isolated { errors ->
+            workspace.evaluate("m*2+1") to errors
+        }
+
+        // Then
+        assertFalse(errors.hasError)
+        assertEquals(0, BigDecimal(9).compareTo(result))
+        assertEquals(0, BigDecimal(9).compareTo(workspace.value(Workspace.ANS)))
+        assertTrue(Workspace.isValidName("ans"))
+        assertFalse(Workspace.isValidName("sin"))
+    }
+
+    @Test
+    fun `given a preview when evaluating then ans is read but not replaced`() {
+        // Given
+        val workspace = Workspace(10, true)
+        CalculatorErrors.isolated { workspace.evaluate("20+1") }
+
+        // When
+        val (result, errors) = CalculatorErrors.isolated { errors ->
+            workspace.evaluate("ans*2", keepAsAns = false) to errors
+        }
+
+        // Then
+        assertFalse(errors.hasError)
+        assertEquals(0, BigDecimal(42).compareTo(result))
+        assertEquals(0, BigDecimal(21).compareTo(workspace.value(Workspace.ANS)))
+    }
+}
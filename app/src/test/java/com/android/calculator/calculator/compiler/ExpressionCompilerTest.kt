@@ -0,0 +1,141 @@
+package com.android.calculator.calculator.compiler
+
+import com.android.calculator.calculator.Calculator
+import com.android.calculator.calculator.CalculatorErrors
+import com.android.calculator.calculator.Workspace
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertFalse
+import org.junit.Assert.assertTrue
+import org.junit.Test
+import java.math.BigDecimal
+
+class ExpressionCompilerTest {
+
+    private val calculator = Calculator(10)
+
+    @Test
+    fun `given only constants when compiling then the expression is folded to its value`() {
+        // Given
+        val equation = "(2+3)*4-10/4"
+
+        // When
+        val program = ExpressionCompiler.compile(equation)
+
+        // Then
+        assertEquals(1, program.instructionCount)
+        assertEquals(0, BigDecimal("17.5").compareTo(program.execute(calculator, true)))
+    }
+
+    @Test
+    fun `given a repeated subexpression when compiling then it is computed once`() {
+        // Given
+        val equation = "sin(30)+sin(30)*2"
+
+        // When
+        val program = ExpressionCompiler.compile(equation)
+
+        // Then
+        // 30, sin, 2, *, +
+        assertEquals(5, program.instructionCount)
+        val sine = calculator.function(MathFunction.SIN, BigDecimal(30), true)
+        assertEquals(0, sine.multiply(BigDecimal(3)).compareTo(program.execute(calculator, true)))
+    }
+
+    @Test
+    fun `given a square when compiling then it is a multiplication`() {
+        // Given
+        val equation = "cos(60)^2"
+
+        // When
+        val program = ExpressionCompiler.compile(equation)
+
+        // Then
+        assertTrue(program.toString().contains("^ 2"))
+        val cosine = calculator.function(MathFunction.COS, BigDecimal(60), true)
+        assertEquals(0, cosine.multiply(cosine).compareTo(program.execute(calculator, true)))
+    }
+
+    @Test
+    fun `given a determinant and a statistic when compiling then each gets its own instruction`() {
+        // Given
+        val equation = "det(1;2;3;4)+sum(1;2)"
+
+        // When
+        val program = ExpressionCompiler.compile(equation)
+
+        // Then
+        assertTrue(program.toString().contains("m${MatrixFunction.DETERMINANT}("))
+        assertTrue(program.toString().contains("s${StatisticFunction.SUM}("))
+        assertEquals(0, BigDecimal(1).compareTo(program.execute(calculator, true)))
+        assertFalse(Workspace.isValidName("det"))
+    }
+
+    @Test
+    fun `given a compiled program when changing the angle mode then the same program is reused`() {
+        // Given
+        val program = ExpressionCompiler.compile("sin(π/2)")
+
+        // When
+        val degrees = program.execute(calculator, true)
+        val radians = program.execute(calculator, false)
+
+        // Then
+        assertEquals(0, BigDecimal.ONE.compareTo(radians))
+        assertTrue(degrees < BigDecimal("0.03"))
+    }
+
+    @Test
+    fun `given invalid numbers when executing then the syntax error flag is raised`() {
+        // Given
+        val program = ExpressionCompiler.compile("1.2.3+4")
+
+        // When
+        val errors = CalculatorErrors.isolated { errors ->
+            program.execute(calculator, true)
+            errors
+        }
+
+        // Then
+        assertTrue(errors.syntaxError)
+        assertFalse(errors.divisionBy0)
+    }
+
+    @Test
+    fun `given mixed operators when compiling then the precedence is the one of the former evaluator`() {
+        // Given
+        val equation = "-2^2+3*-sqrt 4^2#5-(1+2)/4"
+
+        // When
+        val program = ExpressionCompiler.compile(equation)
+
+        // Then
+        // -(2^2) + ((3 * -sqrt(4^2)) # 5) - (3 / 4)
+        assertEquals(0, BigDecimal("-6.75").compareTo(program.execute(calculator, true)))
+    }
+
+    @Test
+    fun `given a deeply nested expression when compiling then it does not overflow the stack`() {
+        // Given
+        val depth = 100_000
+        val equation = "(".repeat(depth) + "-1" + ")".repeat(depth)
+
+        // When
+        val program = ExpressionCompiler.compile(equation)
+
+        // Then
+        assertEquals(0, BigDecimal.ONE.negate().compareTo(program.execute(calculator, true)))
+    }
+
+    @Test
+    fun `given a megabyte of input when compiling then every term is added`() {
+        // Given
+        val terms = 200_000
+        val equation = (1..terms).joinToString("+") { "1.5" }
+
+        // When
+        val program = ExpressionCompiler.compile(equation)
+
+        // Then
+        assertEquals(0, BigDecimal("1.5").multiply(BigDecimal(terms)).compareTo(program.execute(calculator, true)))
+    }
+}
@@ -0,0 +1,104 @@
+package com.android.calculator.calculator.matrix
+
+import com.android.calculator.calculator.Calculator
+import com.android.calculator.calculator.CalculatorErrors
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertFalse
+import org.junit.Assert.assertNull
+import org.junit.Assert.assertTrue
+import org.junit.Test
+import java.math.BigDecimal
+import java.util.Random
+import java.util.concurrent.Executors
+
+class MatrixCalculatorTest {
+
+    private val calculator = MatrixCalculator(10, Executors.newFixedThreadPool(2))
+
+    @Test
+    fun `given a small matrix when inverting then the inverse is exact`() {
+        // Given
+        val matrix = Matrix.parse("4 7\n2 6")!!
+
+        // When
+        val inverse = calculator.inverse(matrix)!!
+        val determinant = calculator.determinant(matrix)!!
+
+        // Then
+        assertEquals(0, BigDecimal("10").compareTo(determinant))
+        assertEquals("0.6\t-0.7\n-0.2\t0.4", inverse.toString())
+    }
+
+    @Test
+    fun `given a system with decimals when solving then the solution is exact`() {
+        // Given
+        val a = Matrix.parse("0.5 1 0\n0 3 -1\n2 0 1.25")!!
+        val b = Matrix.parse("2\n1\n-1")!!
+
+        // When
+        val x = calculator.solve(a, b)!!
+        val product = calculator.multiply(a, x)!!
+
+        // Then
+        for (i in 0 until 3) assertEquals(0, b.decimal(i, 0).compareTo(product.decimal(i, 0)))
+    }
+
+    @Test
+    fun `given a singular or mismatched matrix when computing then an error is raised`() {
+        // Given
+        val singular = Matrix.parse("1 2\n2 4")!!
+        val rectangular = Matrix.parse("1 2 3\n4 5 6")!!
+
+        // When
+        val (inverse, singularErrors) = CalculatorErrors.isolated { errors -> calculator.inverse(singular) to errors }
+        val (determinant, rectangularErrors) = CalculatorErrors.isolated { errors -> calculator.determinant(rectangular) to errors }
+
+        // Then
+        assertNull(inverse)
+        assertTrue(singularErrors.domainError)
+        assertNull(determinant)
+        assertTrue(rectangularErrors.syntaxError)
+    }
+
+    @Test
+    fun `given large matrices when multiplying and solving then the blocked kernels match the definition`() {
+        // Given
+        val random = Random(7)
+        val n = 203
+        val a = Matrix(n, n, DoubleArray(n * n) { random.nextDouble() - 0.5 }, null)
+        val x = Matrix(n, 3, DoubleArray(n * 3) { random.nextDouble() - 0.5 }, null)
+
+        // When
+        val b = calculator.multiply(a, x)!!
+        val solution = calculator.solve(a, b)!!
+
+        // Then
+        for (i in 0 until n) {
+            for (j in 0 until 3) {
+                var expected = 0.0
+                for (k in 0 until n) expected += a[i, k] * x[k, j]
+                assertEquals(expected, b[i, j], 1e-12)
+                assertEquals(x[i, j], solution[i, j], 1e-9)
+            }
+        }
+    }
+
+    @Test
+    fun `given a determinant in an expression when evaluating then it is computed from the entries row by row`() {
+        // Given
+        val calculator = Calculator(10)
+
+        // When
+        val (result, errors) = CalculatorErrors.isolated { errors ->
+            calculator.evaluate("det(4;7;2;6)*2+det(0.5;1;0;0;3;-1;2;0;1.25)", true) to errors
+        }
+        val (_, notSquareErrors) = CalculatorErrors.isolated { errors ->
+            calculator.evaluate("det(1;2;3)", true) to errors
+        }
+
+        // Then
+        assertFalse(errors.hasError)
+        assertEquals(0, BigDecimal("19.875").compareTo(result))
+        assertTrue(notSquareErrors.syntaxError)
+    }
+}
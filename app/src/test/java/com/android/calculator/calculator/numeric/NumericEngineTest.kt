@@ -0,0 +1,63 @@
+package com.android.calculator.calculator.numeric
+
+import org.junit.Assert.assertEquals
+import org.junit.Test
+import kotlin.math.PI
+import kotlin.math.sqrt
+
+class NumericEngineTest {
+
+    private val engine = NumericEngine()
+
+    @Test
+    fun `given a sign change when solving then the root is found within the tolerance`() {
+        // Given
+        val equation = "x^2-2"
+
+        // When
+        val result = engine.solve(equation, false, 0.0, 2.0, tolerance = 1e-12)
+
+        // Then
+        assertEquals(NumericEngine.Status.CONVERGED, result.status)
+        assertEquals(sqrt(2.0), result.value, 1e-12)
+    }
+
+    @Test
+    fun `given only a pole when solving then there is no root`() {
+        // Given
+        val equation = "tan(x)"
+
+        // When
+        val result = engine.solve(equation, true, 60.0, 120.0)
+
+        // Then
+        assertEquals(NumericEngine.Status.NO_ROOT, result.status)
+    }
+
+    @Test
+    fun `given a smooth function when integrating then the value meets the tolerance`() {
+        // Given
+        val equation = "sin(x)"
+
+        // When
+        val result = engine.integrate(equation, false, 0.0, PI, tolerance = 1e-12)
+
+        // Then
+        assertEquals(NumericEngine.Status.CONVERGED, result.status)
+        assertEquals(2.0, result.value, 1e-12)
+    }
+
+    @Test
+    fun `given a cancelled computation when integrating then it stops with its estimate`() {
+        // Given
+        val cancellation = NumericEngine.Cancellation()
+        cancellation.cancel()
+
+        // When
+        val result = engine.integrate("x^2", false, 0.0, 1.0, cancellation = cancellation)
+
+        // Then
+        assertEquals(NumericEngine.Status.CANCELLED, result.status)
+        assertEquals(0, result.evaluations)
+    }
+}
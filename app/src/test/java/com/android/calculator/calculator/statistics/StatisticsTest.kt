@@ -0,0 +1,73 @@
+package com.android.calculator.calculator.statistics
+
+import com.android.calculator.calculator.Calculator
+import com.android.calculator.calculator.CalculatorErrors
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertFalse
+import org.junit.Assert.assertNull
+import org.junit.Test
+import java.math.BigDecimal
+
+class StatisticsTest {
+
+    @Test
+    fun `given values of very different magnitudes when summing then nothing is lost`() {
+        // Given
+        val values = doubleArrayOf(1.0, 1e100, 1.0, -1e100, 0.1, 0.2, 0.3)
+
+        // When
+        val sum = Statistics.sum(values)
+
+        // Then
+        assertEquals(2.6, sum, 1e-15)
+    }
+
+    @Test
+    fun `given a column when computing percentiles then ranks are interpolated`() {
+        // Given
+        val values = DoubleArray(101) { (100 - it).toDouble() }
+
+        // When
+        val median = Statistics.median(values)
+        val percentile = Statistics.percentile(values, 92.5)
+
+        // Then
+        assertEquals(50.0, median, 0.0)
+        assertEquals(92.5, percentile, 1e-12)
+    }
+
+    @Test
+    fun `given pasted rows when parsing then each column gets its statistics`() {
+        // Given
+        val text = "1,5\t2\n2,5\t4\n3,5\t6\n"
+
+        // When
+        val dataset = Dataset.parse(text, decimalSeparator = ',')!!
+        val summary = dataset.summary(0, exactScale = 10)
+        val regression = dataset.regression()
+
+        // Then
+        assertEquals(3, dataset.rowCount)
+        assertEquals(0, BigDecimal("7.5").compareTo(summary.sum))
+        assertEquals(0, BigDecimal("2.5").compareTo(summary.mean))
+        assertEquals(0, BigDecimal.ONE.compareTo(summary.variance))
+        assertEquals(2.0, regression.slope, 1e-12)
+        assertEquals(-1.0, regression.intercept, 1e-12)
+        assertNull(Dataset.parse("1 2\n3"))
+    }
+
+    @Test
+    fun `given a list literal when evaluating then its statistic is computed`() {
+        // Given
+        val calculator = Calculator(10)
+
+        // When
+        val (result, errors) = CalculatorErrors.isolated { errors ->
+            calculator.evaluate("mean(1;2;3;2*2)^2+sum(0.1;0.2)", true) to errors
+        }
+
+        // Then
+        assertFalse(errors.hasError)
+        assertEquals(0, BigDecimal("6.55").compareTo(result))
+    }
+}
@@ -0,0 +1,45 @@
+package com.android.calculator.history
+
+import android.content.ContextWrapper
+import com.android.calculator.calculator.parser.NumberingSystem
+import org.junit.Assert.assertEquals
+import org.junit.Rule
+import org.junit.Test
+import org.junit.rules.TemporaryFolder
+import java.io.File
+import java.math.BigDecimal
+import java.util.concurrent.Executor
+
+class HistoryAdapterTest {
+
+    @get:Rule
+    val folder = TemporaryFolder()
+
+    @Test
+    fun `given a next element without time when removing an element then the next one only inherits its time`() {
+        // Given
+        val store = HistoryStore(File(folder.root, "history.log"))
+        val format = HistoryRecalculator.Format(10, false, NumberingSystem.INTERNATIONAL, ".", ",").encode()
+        store.append(History(calculation = "1+1", result = "2", time = "1700000000000", id = "first"))
+        val next = History(
+            calculation = "sin(1)",
+            result = "0.0174524064",
+            time = "",
+            id = "next",
+            exact = BigDecimal("0.25"),
+            format = format,
+            isDegreeModeActivated = true
+        )
+        store.append(next)
+        val source = HistoryPagedSource(store, executor = Executor { it.run() })
+        val adapter = HistoryAdapter(source, {}, ContextWrapper(null))
+
+        // When
+        adapter.removeHistoryElement(0)
+
+        // Then
+        assertEquals(1, store.size)
+        assertEquals(next.copy(time = "1700000000000"), store.get("next"))
+        store.close()
+    }
+}
@@ -0,0 +1,159 @@
+package com.android.calculator.history
+
+import org.junit.After
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertNull
+import org.junit.Before
+import org.junit.Rule
+import org.junit.Test
+import org.junit.rules.TemporaryFolder
+import java.io.File
+import java.util.concurrent.Executor
+
+class HistoryPagedSourceTest {
+
+    @get:Rule
+    val folder = TemporaryFolder()
+
+    // Runs the posted tasks only when asked, so that pending writes can be observed
+    private class QueuedExecutor : Executor {
+        val tasks = ArrayDeque<Runnable>()
+
+        override fun execute(command: Runnable) {
+            tasks.addLast(command)
+        }
+
+        fun runAll() {
+            while (tasks.isNotEmpty()) tasks.removeFirst().run()
+        }
+    }
+
+    private lateinit var store: HistoryStore
+    private val executor = QueuedExecutor()
+
+    private fun history(index: Int) = History(
+        calculation = "$index+$index",
+        result = "${index * 2}",
+        time = "",
+        id = "id-$index"
+    )
+
+    @Before
+    fun setUp() {
+        store = HistoryStore(File(folder.root, "history.log"))
+        for (i in 0 until 10) store.append(history(i))
+    }
+
+    @After
+    fun tearDown() {
+        store.close()
+    }
+
+    @Test
+    fun `given pages smaller than the history when reading every position then elements cross page boundaries in order`() {
+        // Given
+        val source = HistoryPagedSource(store, pageSize = 4, maxCachedPages = 2, executor = executor)
+
+        // When
+        val read = (0 until source.size).map { source.get(it) }
+        executor.runAll()
+        val reread = (9 downTo 0).map { source.get(it) }
+
+        // Then
+        assertEquals(10, source.size)
+        assertEquals((0 until 10).map { history(it) }, read)
+        assertEquals((9 downTo 0).map { history(it) }, reread)
+    }
+
+    @Test
+    fun `given out of range positions when reading then nothing is returned`() {
+        // Given
+        val source = HistoryPagedSource(store, pageSize = 4, executor = executor)
+
+        // When
+        source.removeAt(10)
+        source.removeAt(-1)
+
+        // Then
+        assertNull(source.get(-1))
+        assertNull(source.get(10))
+        assertEquals(10, source.size)
+        assertEquals(-1, source.positionOf("id-unknown"))
+        assertEquals(0, executor.tasks.size)
+    }
+
+    @Test
+    fun `given a loaded page when an element is appended then the new element is read`() {
+        // Given
+        val source = HistoryPagedSource(store, pageSize = 4, executor = executor)
+        source.get(9)
+
+        // When
+        store.append(history(10))
+        source.onAppended()
+
+        // Then
+        assertEquals(11, source.size)
+        assertEquals(history(10), source.get(10))
+        assertEquals(history(8), source.get(8))
+    }
+
+    @Test
+    fun `given a removal not yet written when reading then the pages already skip the removed element`() {
+        // Given
+        val source = HistoryPagedSource(store, pageSize = 4, executor = executor)
+        (0 until 10).forEach { source.get(it) }
+        executor.runAll()
+
+        // When
+        source.removeAt(3)
+
+        // Then
+        assertEquals(10, store.size)
+        assertEquals(9, source.size)
+        assertEquals(listOf(0, 1, 2, 4, 5, 6, 7, 8, 9).map { history(it) }, (0 until 9).map { source.get(it) })
+        assertEquals(-1, source.positionOf("id-3"))
+        assertEquals(3, source.positionOf("id-4"))
+    }
+
+    @Test
+    fun `given pending removals and updates when they are written then the store matches the pages`() {
+        // Given
+        val source = HistoryPagedSource(store, pageSize = 4, executor = executor)
+        val updated = history(6).copy(result = "twelve")
+
+        // When
+        source.removeAt(0)
+        source.update(5, updated)
+        source.removeAt(7)
+        val pending = (0 until source.size).map { source.get(it) }
+        executor.runAll()
+        source.refresh()
+
+        // Then
+        val expected = listOf(history(1), history(2), history(3), history(4), history(5), updated, history(7), history(9))
+        assertEquals(expected, pending)
+        assertEquals(expected, store.getAll())
+        assertEquals(expected, (0 until source.size).map { source.get(it) })
+    }
+
+    @Test
+    fun `given a history longer than its maximum size when trimming then the store is trimmed on the store thread`() {
+        // Given
+        val source = HistoryPagedSource(store, pageSize = 4, executor = executor)
+        var trimmed = 0
+
+        // When
+        source.trimTo(6) { trimmed++ }
+        val before = store.size
+        executor.runAll()
+        source.trimTo(6) { trimmed++ }
+        executor.runAll()
+        source.refresh()
+
+        // Then
+        assertEquals(10, before)
+        assertEquals(1, trimmed)
+        assertEquals((4 until 10).map { history(it) }, (0 until source.size).map { source.get(it) })
+    }
+}
@@ -0,0 +1,116 @@
+package com.android.calculator.history
+
+import com.android.calculator.calculator.parser.NumberingSystem
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertTrue
+import org.junit.Rule
+import org.junit.Test
+import org.junit.rules.TemporaryFolder
+import java.io.File
+import java.math.BigDecimal
+import java.util.Collections
+import java.util.concurrent.CountDownLatch
+import java.util.concurrent.Executors
+import java.util.concurrent.TimeUnit
+import java.util.concurrent.atomic.AtomicReference
+
+class HistoryRecalculatorTest {
+
+    @get:Rule
+    val folder = TemporaryFolder()
+
+    @Test
+    fun `given swapped separators when recomputing then the visible chunk is written back first`() {
+        // Given
+        val store = HistoryStore(File(folder.root, "history.log"))
+        for (i in 0 until 200) {
+            store.append(History(calculation = "1,234.5+$i", result = "1,${234 + i}.5", time = "", id = "id-$i"))
+        }
+        val from = HistoryRecalculator.Format(10, false, NumberingSystem.INTERNATIONAL, ".", ",")
+        val to = HistoryRecalculator.Format(10, false, NumberingSystem.INTERNATIONAL, ",", ".")
+        val written = Collections.synchronizedList(ArrayList<IntRange>())
+        val finished = CountDownLatch(1)
+
+        // When
+        HistoryRecalculator(store, Executors.newSingleThreadExecutor()).recompute(
+            from, to, 150..160,
+            onWritten = { written.add(it) },
+            onFinished = { finished.countDown() }
+        )
+
+        // Then
+        assertTrue(finished.await(10, TimeUnit.SECONDS))
+        assertEquals(listOf(128..191, 192..199, 64..127, 0..63), written)
+        assertEquals(
+            History(calculation = "1.234,5+0", result = "1.234,5", time = "", id = "id-0", format = to.encode()),
+            store.get("id-0")
+        )
+        assertEquals(
+            History(calculation = "1.234,5+199", result = "1.433,5", time = "", id = "id-199", format = to.encode()),
+            store.get("id-199")
+        )
+        store.close()
+    }
+
+    @Test
+    fun `given a higher precision when recomputing then rounded results are evaluated again in their angle unit`() {
+        // Given
+        val store = HistoryStore(File(folder.root, "history.log"))
+        val from = HistoryRecalculator.Format(10, false, NumberingSystem.INTERNATIONAL, ".", ",")
+        val to = HistoryRecalculator.Format(15, false, NumberingSystem.INTERNATIONAL, ".", ",")
+        store.append(History(calculation = "2÷3", result = "0.6666666667", time = "", id = "division", isDegreeModeActivated = false))
+        store.append(History(calculation = "sin(90)", result = "1", time = "", id = "degrees", isDegreeModeActivated = true))
+        store.append(History(calculation = "1÷4", result = "0.25", time = "", id = "exact", exact = BigDecimal("0.25")))
+        val finished = CountDownLatch(1)
+
+        // When
+        HistoryRecalculator(store, Executors.newSingleThreadExecutor()).recompute(
+            from, to, IntRange.EMPTY,
+            onWritten = {},
+            onFinished = { finished.countDown() }
+        )
+
+        // Then
+        assertTrue(finished.await(10, TimeUnit.SECONDS))
+        assertEquals("0.666666666666667", store.get("division")?.result)
+        assertEquals("1", store.get("degrees")?.result)
+        assertEquals("0.25", store.get("exact")?.result)
+        assertEquals(to.encode(), store.get("division")?.format)
+        store.close()
+    }
+
+    @Test
+    fun `given a recomputation cancelled half way when restarting towards another format then no element is converted twice`() {
+        // Given
+        val store = HistoryStore(File(folder.root, "history.log"))
+        for (i in 0 until 200) {
+            store.append(History(calculation = "1,234.5+$i", result = "1,${234 + i}.5", time = "", id = "id-$i"))
+        }
+        val original = HistoryRecalculator.Format(10, false, NumberingSystem.INTERNATIONAL, ".", ",")
+        val swapped = HistoryRecalculator.Format(10, false, NumberingSystem.INTERNATIONAL, ",", ".")
+        val executor = Executors.newSingleThreadExecutor()
+        val recalculator = HistoryRecalculator(store, executor)
+        val gate = CountDownLatch(1)
+        executor.submit { gate.await() }
+        val first = AtomicReference<HistoryRecalculator.Recomputation>()
+        first.set(recalculator.recompute(original, swapped, 0..10, onWritten = { first.get().cancel() }))
+        gate.countDown()
+        executor.submit {}.get(10, TimeUnit.SECONDS)
+        assertEquals("1.234,5+0", store.get("id-0")?.calculation)
+        assertEquals("1,234.5+199", store.get("id-199")?.calculation)
+        val finished = CountDownLatch(1)
+
+        // When
+        recalculator.recompute(original, original, 0..10, onWritten = {}, onFinished = { finished.countDown() })
+
+        // Then
+        assertTrue(finished.await(10, TimeUnit.SECONDS))
+        for (i in listOf(0, 63, 64, 199)) {
+            val history = store.get("id-$i")
+            assertEquals("1,234.5+$i", history?.calculation)
+            assertEquals("1,${234 + i}.5", history?.result)
+        }
+        assertEquals(original.encode(), store.get("id-0")?.format)
+        store.close()
+    }
+}
@@ -0,0 +1,165 @@
+package com.android.calculator.history
+
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertNull
+import org.junit.Rule
+import org.junit.Test
+import org.junit.rules.TemporaryFolder
+import java.io.File
+import java.math.BigDecimal
+import java.util.UUID
+
+class HistoryStoreTest {
+
+    @get:Rule
+    val folder = TemporaryFolder()
+
+    private fun history(index: Int) = History(
+        calculation = "$index+$index",
+        result = "${index * 2}",
+        time = (1_700_000_000_000L + index).toString(),
+        id = "id-$index"
+    )
+
+    @Test
+    fun `given appended elements when reading then elements are returned in insertion order`() {
+        // Given
+        val store = HistoryStore(File(folder.root, "history.log"))
+
+        // When
+        for (i in 0 until 10) store.append(history(i))
+
+        // Then
+        assertEquals((0 until 10).map { history(it) }, store.getAll())
+        assertEquals(history(3), store.get("id-3"))
+        assertEquals(history(9), store.last())
+        store.close()
+    }
+
+    @Test
+    fun `given an updated element when reopening then the update keeps its position`() {
+        // Given
+        val file = File(folder.root, "history.log")
+        val store = HistoryStore(file)
+        for (i in 0 until 5) store.append(history(i))
+
+        // When
+        val updated = History(calculation = "2×21", result = "42", time = "", id = "id-2")
+        store.update("id-2", updated)
+        store.close()
+        val reopened = HistoryStore(file)
+
+        // Then
+        assertEquals(listOf(history(0), history(1), updated, history(3), history(4)), reopened.getAll())
+        assertEquals(updated, reopened.get("id-2"))
+        reopened.close()
+    }
+
+    @Test
+    fun `given removed and trimmed elements when reopening then only the live elements remain`() {
+        // Given
+        val file = File(folder.root, "history.log")
+        val store = HistoryStore(file)
+        for (i in 0 until 8) store.append(history(i))
+
+        // When
+        store.remove("id-5")
+        store.removeAt(0)
+        store.trimTo(4)
+        store.close()
+        val reopened = HistoryStore(file)
+
+        // Then
+        assertEquals(listOf(history(3), history(4), history(6), history(7)), reopened.getAll())
+        assertNull(reopened.get("id-0"))
+        reopened.close()
+    }
+
+    @Test
+    fun `given removed elements when looking up positions then positions follow the remaining order`() {
+        // Given
+        val store = HistoryStore(File(folder.root, "history.log"))
+        for (i in 0 until 20) store.append(history(i))
+
+        // When
+        store.removeAt(0)
+        store.remove("id-7")
+        store.remove("id-19")
+        store.update("id-12", history(12).copy(result = "0"))
+
+        // Then
+        assertEquals(listOf(-1, 0, 5, -1, 6, 10, 16, -1), listOf(0, 1, 6, 7, 8, 12, 18, 19).map { store.positionOf("id-$it") })
+        assertEquals(false, store.remove("id-7"))
+        assertEquals(history(8), store.getAt(store.positionOf("id-8")))
+        store.close()
+    }
+
+    @Test
+    fun `given many updates when compacting then the history is unchanged`() {
+        // Given
+        val file = File(folder.root, "history.log")
+        val store = HistoryStore(file)
+        for (i in 0 until 100) store.append(history(i))
+
+        // When
+        for (round in 0 until 50) {
+            for (i in 0 until 100) {
+                store.update("id-$i", history(i).copy(result = "$round"))
+            }
+        }
+        store.compact()
+        store.close()
+        val reopened = HistoryStore(file)
+
+        // Then
+        assertEquals(100, reopened.size)
+        assertEquals((0 until 100).map { history(it).copy(result = "49") }, reopened.getAll())
+        reopened.close()
+    }
+
+    @Test
+    fun `given indexed elements when searching then matching calculations and result ranges are returned`() {
+        // Given
+        val store = HistoryStore(File(folder.root, "history.log"))
+        for (i in 0 until 200) store.append(history(i))
+
+        // When
+        store.search("+12")
+        store.update("id-120", history(120).copy(calculation = "sin(0)", result = "0"))
+        store.remove("id-125")
+        store.append(history(1250))
+
+        // Then
+        assertEquals(
+            listOf("id-1250", "id-129", "id-128", "id-127", "id-126", "id-124", "id-123", "id-122", "id-121", "id-12"),
+            store.search("+12").map { it.id }
+        )
+        assertEquals(listOf("id-120"), store.search("SIN(").map { it.id })
+        assertEquals(listOf("id-0", "id-120", "id-1", "id-2"), store.searchResultRange(0.0, 4.0).map { it.id })
+        assertEquals(listOf("id-1250"), store.searchResultRange(2000.0, 3000.0).map { it.id })
+        store.close()
+    }
+
+    @Test
+    fun `given tokenized calculations and exact results when reopening then elements are decoded unchanged`() {
+        // Given
+        val file = File(folder.root, "history.log")
+        val store = HistoryStore(file)
+        val elements = listOf(
+            History("sin⁻¹(0.5)×√2÷π", "42.42640687", "1700000000000", UUID.randomUUID().toString(), BigDecimal("42.426406871192851464")),
+            History("123456789012345+9\u00A0999", "-1.2E+5", "", "not-a-uuid", BigDecimal("-1.2E+5")),
+            History("2^10 ≈ 1024 \uD83D\uDE00", "1,024", "0", UUID.randomUUID().toString()),
+            History("cos(60)", "0.5", "", "id-angle", format = "10|false|1|.|,", isDegreeModeActivated = true),
+            History("tan(0)", "0", "", "id-radian", isDegreeModeActivated = false)
+        )
+
+        // When
+        elements.forEach { store.append(it) }
+        store.close()
+        val reopened = HistoryStore(file)
+
+        // Then
+        assertEquals(elements, reopened.getAll())
+        reopened.close()
+    }
+}
@@ -0,0 +1,54 @@
+package com.android.calculator.plot
+
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertTrue
+import org.junit.Test
+import kotlin.math.abs
+
+class PlotKernelTest {
+
+    @Test
+    fun `given a polynomial when evaluating a batch then every x has its value`() {
+        // Given
+        val kernel = PlotKernel.compile("x^2-3*x+1", false)
+        val xs = DoubleArray(1000) { it / 10.0 - 50 }
+        val ys = DoubleArray(xs.size)
+
+        // When
+        kernel.evaluate(xs, ys, 0, xs.size)
+
+        // Then
+        for (i in xs.indices) assertEquals(xs[i] * xs[i] - 3 * xs[i] + 1, ys[i], 1e-9)
+    }
+
+    @Test
+    fun `given x outside of the domain when evaluating then the value is NaN`() {
+        // Given
+        val kernel = PlotKernel.compile("ln(x)", false)
+
+        // When
+        val negative = kernel.evaluate(-1.0)
+        val positive = kernel.evaluate(Math.E)
+
+        // Then
+        assertTrue(negative.isNaN())
+        assertEquals(1.0, positive, 1e-12)
+    }
+
+    @Test
+    fun `given tan in degrees when sampling then the line is broken at 90`() {
+        // Given
+        val kernel = PlotKernel.compile("tan(x)", true)
+        val viewport = PlotSampler.Viewport(-180.0, 180.0, -10.0, 10.0, 360, 200)
+        val sampler = PlotSampler()
+
+        // When
+        val lines = sampler.sample(kernel, viewport)
+
+        // Then
+        assertTrue(sampler.lineCount > 0)
+        for (line in 0 until sampler.lineCount) {
+            assertTrue(abs(lines[line * 4 + 3] - lines[line * 4 + 1]) <= viewport.height)
+        }
+    }
+}
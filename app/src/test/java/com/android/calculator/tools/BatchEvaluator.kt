@@ -0,0 +1,186 @@
+package com.android.calculator.tools
+
+import com.android.calculator.calculator.Calculator
+import com.android.calculator.calculator.CalculatorErrors
+import com.android.calculator.calculator.parser.Expression
+import java.io.BufferedReader
+import java.io.BufferedWriter
+import java.io.File
+import java.io.InputStreamReader
+import java.io.OutputStream
+import java.io.OutputStreamWriter
+import java.io.PrintStream
+import java.io.Writer
+import java.util.concurrent.ExecutorService
+import java.util.concurrent.Executors
+import java.util.concurrent.Future
+import kotlin.system.exitProcess
+
+/**
+ * Host-side batch evaluation of calculator expressions, to measure the throughput and latency of
+ * the engine outside the app.
+ *
+ * Expressions are read one per line, as typed on the calculator keyboard with "." as decimal
+ * separator, from a file or from the standard input. They are evaluated across a thread pool and
+ * a `line<TAB>result<TAB>microseconds` row is written for each of them, in input order. A summary
+ * with the p50/p99 latency and the number of expressions per second goes to the standard error.
+ *
+ * ```
+ * ./gradlew :app:evaluateBatch --args="--threads 4 --repeat 10 src/test/resources/corpus/expressions.txt"
+ * ```
+ */
+class BatchEvaluator(
+    private val threads: Int = Runtime.getRuntime().availableProcessors(),
+    numberPrecision: Int = DEFAULT_NUMBER_PRECISION,
+    private val isDegreeModeActivated: Boolean = true
+) {
+
+    companion object {
+        const val DEFAULT_NUMBER_PRECISION = 10
+
+        // Expressions in flight per thread, bounding the memory used on endless input
+        private const val WINDOW_PER_THREAD = 64
+    }
+
+    class Evaluation(val line: Long, val expression: String, val result: String, val nanos: Long)
+
+    class Summary(val count: Int, val errors: Int, val wallNanos: Long, latencies: LongArray) {
+        private val sorted = latencies.sortedArray()
+
+        val expressionsPerSecond: Double
+            get() = if (wallNanos == 0L) 0.0 else count * 1e9 / wallNanos
+
+        fun percentile(percent: Double): Long {
+            if (sorted.isEmpty()) return 0
+            val index = Math.ceil(percent / 100.0 * sorted.size).toInt() - 1
+            return sorted[index.coerceIn(0, sorted.size - 1)]
+        }
+
+        override fun toString(): String {
+            return buildString {
+                appendLine("expressions: $count (errors: $errors)")
+                appendLine("wall: ${"%.1f".format(wallNanos / 1e6)} ms, ${"%.0f".format(expressionsPerSecond)} expressions/s")
+                append("latency: p50 ${percentile(50.0) / 1000} µs, p99 ${percentile(99.0) / 1000} µs, ")
+                append("max ${percentile(100.0) / 1000} µs")
+            }
+        }
+    }
+
+    // Evaluation is reentrant, so every worker shares the same calculator
+    private val calculator = Calculator(numberPrecision)
+    private val expression = Expression()
+
+    fun evaluate(line: Long, input: String): Evaluation {
+        val start = System.nanoTime()
+        val result = try {
+            CalculatorErrors.isolated { errors ->
+                val cleanExpression = expression.getCleanExpression(input, ".", ",")
+                val value = calculator.evaluate(cleanExpression, isDegreeModeActivated)
+                when {
+                    errors.syntaxError -> "error: syntax"
+                    errors.domainError -> "error: domain"
+                    errors.requireRealNumber -> "error: real number required"
+                    errors.divisionBy0 -> "error: division by 0"
+                    errors.isInfinity -> "error: infinity"
+                    else -> value.toString()
+                }
+            }
+        } catch (e: Exception) {
+            "error: ${e.javaClass.simpleName}"
+        } catch (e: StackOverflowError) {
+            "error: StackOverflowError"
+        }
+        return Evaluation(line, input, result, System.nanoTime() - start)
+    }
+
+    /**
+     * Evaluate every line of [input], [repeat] times, writing the rows to [output] if any.
+     */
+    fun run(input: () -> BufferedReader, output: Writer?, repeat: Int = 1): Summary {
+        val executor: ExecutorService = Executors.newFixedThreadPool(threads)
+        val pending = ArrayDeque<Future<Evaluation>>()
+        var latencies = LongArray(1024)
+        var count = 0
+        var errors = 0
+
+        fun complete(evaluation: Evaluation) {
+            if (count == latencies.size) latencies = latencies.copyOf(count * 2)
+            latencies[count++] = evaluation.nanos
+            if (evaluation.result.startsWith("error")) errors++
+            output?.apply {
+                write(evaluation.line.toString())
+                write('\t'.code)
+                write(evaluation.result)
+                write('\t'.code)
+                write((evaluation.nanos / 1000).toString())
+                write('\n'.code)
+            }
+        }
+
+        val start = System.nanoTime()
+        try {
+            for (round in 0 until repeat) {
+                input().use { reader ->
+                    var line = 0L
+                    while (true) {
+                        val text = reader.readLine() ?: break
+                        line++
+                        if (text.isBlank()) continue
+                        val number = line
+                        pending.addLast(executor.submit<Evaluation> { evaluate(number, text.trim()) })
+                        if (pending.size >= threads * WINDOW_PER_THREAD) complete(pending.removeFirst().get())
+                    }
+                }
+            }
+            while (pending.isNotEmpty()) complete(pending.removeFirst().get())
+        } finally {
+            executor.shutdownNow()
+        }
+        output?.flush()
+        return Summary(count, errors, System.nanoTime() - start, latencies.copyOf(count))
+    }
+}
+
+private fun usage(): Nothing {
+    System.err.println("usage: evaluateBatch [--threads N] [--precision P] [--radians] [--repeat K] [--quiet] [FILE | -]")
+    exitProcess(2)
+}
+
+fun main(args: Array<String>) {
+    var threads = Runtime.getRuntime().availableProcessors()
+    var precision = BatchEvaluator.DEFAULT_NUMBER_PRECISION
+    var isDegreeModeActivated = true
+    var repeat = 1
+    var quiet = false
+    var path = "-"
+
+    var i = 0
+    while (i < args.size) {
+        when (args[i]) {
+            "--threads" -> threads = args.getOrNull(++i)?.toIntOrNull()?.takeIf { it > 0 } ?: usage()
+            "--precision" -> precision = args.getOrNull(++i)?.toIntOrNull()?.takeIf { it >= 0 } ?: usage()
+            "--repeat" -> repeat = args.getOrNull(++i)?.toIntOrNull()?.takeIf { it > 0 } ?: usage()
+            "--radians" -> isDegreeModeActivated = false
+            "--quiet" -> quiet = true
+            else -> if (args[i].startsWith("--")) usage() else path = args[i]
+        }
+        i++
+    }
+    if (path == "-" && repeat > 1) usage()
+
+    // The engine logs to the standard output: keep it for the results only
+    val stdout = System.out
+    System.setOut(PrintStream(OutputStream.nullOutputStream()))
+
+    val output = if (quiet) null else BufferedWriter(OutputStreamWriter(stdout, Charsets.UTF_8), 1 shl 16)
+    val input = {
+        if (path == "-") {
+            BufferedReader(InputStreamReader(System.`in`, Charsets.UTF_8))
+        } else {
+            File(path).bufferedReader(Charsets.UTF_8)
+        }
+    }
+    val summary = BatchEvaluator(threads, precision, isDegreeModeActivated).run(input, output, repeat)
+    System.err.println("threads: $threads")
+    System.err.println(summary)
+}
@@ -0,0 +1,109 @@
+package com.android.calculator.tools
+
+import com.android.calculator.calculator.Calculator
+import com.android.calculator.obfuscation.HotPathObfuscation
+import com.android.calculator.obfuscation.data.DataMasking
+import com.android.calculator.obfuscation.static.AdvancedObfuscator
+import com.android.calculator.obfuscation.static.ControlFlowObfuscator
+import com.android.calculator.obfuscation.static.FlowObfuscator
+import java.io.OutputStream
+import java.io.PrintStream
+import java.math.BigDecimal
+import kotlin.system.exitProcess
+
+/**
+ * Host-side cost of each obfuscation construct used on the arithmetic hot path.
+ *
+ * Every construct wraps the same trivial operation, and the wrappers are called directly rather
+ * than through ObfuscationManager, which skips them in debug builds. The median time per call of
+ * several rounds is reported, next to the bare operation and to a factorial evaluated with the
+ * [HotPathObfuscation] level of the build.
+ *
+ * ```
+ * ./gradlew :app:benchmarkObfuscation --args="--iterations 200000 --rounds 7"
+ * ```
+ */
+class ObfuscationBenchmark(private val iterations: Int, private val rounds: Int) {
+
+    companion object {
+        private fun usage(): Nothing {
+            System.err.println("usage: benchmarkObfuscation [--iterations N] [--rounds R]")
+            exitProcess(2)
+        }
+
+        @JvmStatic
+        fun main(args: Array<String>) {
+            var iterations = 100_000
+            var rounds = 5
+
+            var i = 0
+            while (i < args.size) {
+                when (args[i]) {
+                    "--iterations" -> iterations = args.getOrNull(++i)?.toIntOrNull()?.takeIf { it > 0 } ?: usage()
+                    "--rounds" -> rounds = args.getOrNull(++i)?.toIntOrNull()?.takeIf { it > 0 } ?: usage()
+                    else -> usage()
+                }
+                i++
+            }
+
+            // The obfuscators log to the standard output: keep it for the report only
+            val stdout = System.out
+            System.setOut(PrintStream(OutputStream.nullOutputStream()))
+
+            val results = ObfuscationBenchmark(iterations, rounds).run()
+            val baseline = results.first().nanosPerCall ?: 0.0
+            stdout.println("%-48s %12s %12s".format("construct", "ns/call", "overhead"))
+            for (result in results) {
+                val nanos = result.nanosPerCall
+                if (nanos == null) {
+                    stdout.println("%-48s %12s %12s".format(result.name, "-", "unavailable: ${result.error}"))
+                } else {
+                    stdout.println("%-48s %12.1f %12.1f".format(result.name, nanos, nanos - baseline))
+                }
+            }
+        }
+    }
+
+    class Result(val name: String, val nanosPerCall: Double?, val error: String? = null)
+
+    // Keeps the measured results alive so that the JIT cannot drop the calls
+    @Volatile
+    private var sink: Any? = null
+
+    private var operand = 0L
+
+    private fun operation(): Long = ++operand * 31
+
+    fun run(): List<Result> {
+        val calculator = Calculator(10)
+        val halfInteger = BigDecimal("5.5")
+        return listOf(
+            measure("bare operation") { operation() },
+            measure("executeWithObfuscationReturn") { ControlFlowObfuscator.executeWithObfuscation { operation() } },
+            measure("obfuscatedBranch") { FlowObfuscator.obfuscatedBranch { operation() } },
+            measure("conditionalExecution") {
+                FlowObfuscator.conditionalExecution(operand and 1L == 0L, { operation() }, { -operation() })
+            },
+            measure("maskNumericValue") { DataMasking.NumericMasking.maskNumericValue(7.0, "gamma_g") },
+            measure("obfuscateString") { AdvancedObfuscator.StringEncryption.encryptString("676.5203681218851", "gamma") },
+            measure("factorial(5.5), hot path level ${HotPathObfuscation.LEVEL}") { calculator.factorial(halfInteger) }
+        )
+    }
+
+    private fun measure(name: String, call: () -> Any): Result {
+        return try {
+            // Warm up so that every round runs compiled code
+            repeat(iterations) { sink = call() }
+            val samples = DoubleArray(rounds) {
+                val start = System.nanoTime()
+                repeat(iterations) { sink = call() }
+                (System.nanoTime() - start).toDouble() / iterations
+            }
+            samples.sort()
+            Result(name, samples[rounds / 2])
+        } catch (e: Exception) {
+            // Some constructs depend on Android classes that are stubs on the host
+            Result(name, null, e.javaClass.simpleName)
+        }
+    }
+}
@@ -0,0 +1,67 @@
+﻿#include "cpu-baseline.h"
+
+#include <math.h>
+
+namespace rasp {
+
+// Rates needed before the baseline is trusted
+#define BASELINE_MIN_RATES 10
+// Deviations above the baseline mean from which a rate spikes
+#define ANOMALY_DEVIATIONS 4.0
+// Fraction of the mean the deviation is at least taken as, so that a steady baseline does not flag noise
+#define RELATIVE_DEVIATION_FLOOR 0.25
+
+// Smallest deviation of each metric, in its unit: below it a spike is not significant. An idle
+// process has a deviation near zero, and the work of a screen or of a parallel computation must
+// stay below the mean plus ANOMALY_DEVIATIONS of these
+static const double deviation_floors[METRIC_COUNT] = {50.0, 2500.0, 10.0, 250.0};
+
+// Metrics of rate spiking above the rates before it in the ring
+static uint32_t find_spikes(const RateRing &ring, const Rate &rate) {
+    uint32_t spikes = 0;
+    for (uint32_t metric = 0; metric < METRIC_COUNT; metric++) {
+        // The rates of a run still to be confirmed stay out of the baseline, which they would raise
+        int excluded = ring.spike_runs[metric];
+        if (excluded > ANOMALY_SUSTAINED_RATES - 1) {
+            excluded = ANOMALY_SUSTAINED_RATES - 1;
+        }
+        int count = ring.count - excluded;
+        if (count < BASELINE_MIN_RATES) {
+            continue;
+        }
+        double sum = 0;
+        double sum_squares = 0;
+        for (int i = excluded + 1; i <= ring.count; i++) {
+            double value = ring.rates[(ring.head - i + RING_CAPACITY) % RING_CAPACITY].values[metric];
+            sum += value;
+            sum_squares += value * value;
+        }
+        double mean = sum / count;
+        double variance = sum_squares / count - mean * mean;
+        double deviation = sqrt(variance > 0 ? variance : 0);
+        deviation = fmax(deviation, fmax(mean * RELATIVE_DEVIATION_FLOOR, deviation_floors[metric]));
+        if (rate.values[metric] > mean + ANOMALY_DEVIATIONS * deviation) {
+            spikes |= METRIC_BIT(metric);
+        }
+    }
+    return spikes;
+}
+
+void add_rate(RateRing &ring, Rate &rate) {
+    rate.spikes = find_spikes(ring, rate);
+    rate.anomalies = 0;
+    for (uint32_t metric = 0; metric < METRIC_COUNT; metric++) {
+        if ((rate.spikes & METRIC_BIT(metric)) == 0) {
+            ring.spike_runs[metric] = 0;
+        } else if (++ring.spike_runs[metric] >= ANOMALY_SUSTAINED_RATES) {
+            rate.anomalies |= METRIC_BIT(metric);
+        }
+    }
+    ring.rates[ring.head] = rate;
+    ring.head = (ring.head + 1) % RING_CAPACITY;
+    if (ring.count < RING_CAPACITY) {
+        ring.count++;
+    }
+}
+
+}  // namespace rasp
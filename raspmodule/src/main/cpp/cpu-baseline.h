@@ -0,0 +1,37 @@
+﻿#pragma once
+
+#include "cpu-sampler.h"
+
+// Rolling baseline of the rates of the CPU sampler, apart from the sampling so that it can be
+// tested on a host.
+//
+// A metric is anomalous when its rate spikes above the mean and deviation of the rates before it
+// for ANOMALY_SUSTAINED_RATES rates in a row: the bursts of ordinary work, such as recomputing a
+// history or opening a screen, end before that, while an injected agent or single-stepping does not.
+
+namespace rasp {
+
+#define RING_CAPACITY 64
+// Consecutive spiking rates from which a metric is anomalous
+#define ANOMALY_SUSTAINED_RATES 5
+
+struct Rate {
+    long long time_ns;
+    double values[METRIC_COUNT];
+    // METRIC_BIT of each metric above its baseline, and of each one above it long enough to be anomalous
+    uint32_t spikes;
+    uint32_t anomalies;
+};
+
+struct RateRing {
+    Rate rates[RING_CAPACITY];
+    int head;
+    int count;
+    // Rates in a row each metric has spiked, up to the latest
+    int spike_runs[METRIC_COUNT];
+};
+
+// Set the spikes and the anomalies of rate against the rates of the ring, then add it to the ring
+void add_rate(RateRing &ring, Rate &rate);
+
+}  // namespace rasp
@@ -0,0 +1,191 @@
+﻿#include "cpu-sampler.h"
+#include "cpu-baseline.h"
+
+#include <android/log.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#define LOG_TAG "RASPNative"
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
+
+namespace rasp {
+
+struct Sample {
+    long long time_ns;
+    long long cpu_ns;
+    long long minor_faults;
+    long long major_faults;
+    long long switches;
+};
+
+static std::mutex sampler_mutex;
+static std::condition_variable sampler_stopped;
+// Never destroyed: a joinable std::thread destroyed at exit would terminate the process
+static std::thread *sampler_thread = NULL;
+// Incremented by each start and stop: a sampler thread runs while it is the one it started with
+static unsigned sampler_generation = 0;
+
+static int stat_fd = -1;
+static int schedstat_fd = -1;
+static long long ns_per_tick = 10000000LL;
+
+static bool has_previous = false;
+static Sample previous;
+static RateRing ring;
+
+static long long now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Read the counters with a pread on each open descriptor, which regenerates the procfs file
+static bool take_sample(Sample &sample) {
+    char buffer[1024];
+    ssize_t length = pread(stat_fd, buffer, sizeof(buffer) - 1, 0);
+    if (length <= 0) {
+        return false;
+    }
+    buffer[length] = '\0';
+    // The command name in parentheses may hold spaces: the fields are counted after its end
+    const char *fields = strrchr(buffer, ')');
+    unsigned long long minor_faults;
+    unsigned long long major_faults;
+    unsigned long long utime;
+    unsigned long long stime;
+    // state ppid pgrp session tty_nr tpgid flags minflt cminflt majflt cmajflt utime stime
+    if (fields == NULL ||
+        sscanf(fields + 1, " %*c %*d %*d %*d %*d %*d %*u %llu %*u %llu %*u %llu %llu",
+               &minor_faults, &major_faults, &utime, &stime) != 4) {
+        return false;
+    }
+    sample.time_ns = now_ns();
+    sample.cpu_ns = (long long)(utime + stime) * ns_per_tick;
+    sample.minor_faults = (long long)minor_faults;
+    sample.major_faults = (long long)major_faults;
+    sample.switches = 0;
+
+    // run_ns wait_ns timeslices, where each timeslice is one switch to the main thread
+    if (schedstat_fd >= 0) {
+        length = pread(schedstat_fd, buffer, sizeof(buffer) - 1, 0);
+        unsigned long long timeslices;
+        if (length > 0) {
+            buffer[length] = '\0';
+            if (sscanf(buffer, "%*u %*u %llu", &timeslices) == 1) {
+                sample.switches = (long long)timeslices;
+            }
+        }
+    }
+    return true;
+}
+
+// Called with sampler_mutex held
+static void record(const Sample &sample) {
+    if (!has_previous) {
+        previous = sample;
+        has_previous = true;
+        return;
+    }
+    double seconds = (sample.time_ns - previous.time_ns) / 1e9;
+    if (seconds <= 0) {
+        return;
+    }
+    Rate rate;
+    rate.time_ns = sample.time_ns;
+    rate.values[METRIC_CPU_PERCENT] = (sample.cpu_ns - previous.cpu_ns) / 1e7 / seconds;
+    rate.values[METRIC_MINOR_FAULTS] = (sample.minor_faults - previous.minor_faults) / seconds;
+    rate.values[METRIC_MAJOR_FAULTS] = (sample.major_faults - previous.major_faults) / seconds;
+    rate.values[METRIC_CONTEXT_SWITCHES] = (sample.switches - previous.switches) / seconds;
+    // Compared with the rates before it, then part of the baseline of the next ones
+    add_rate(ring, rate);
+    if (rate.anomalies != 0) {
+        LOGW("CPU sampler anomaly 0x%x: cpu %.1f%%, minor faults %.0f/s, major faults %.0f/s, switches %.0f/s",
+             rate.anomalies, rate.values[METRIC_CPU_PERCENT], rate.values[METRIC_MINOR_FAULTS],
+             rate.values[METRIC_MAJOR_FAULTS], rate.values[METRIC_CONTEXT_SWITCHES]);
+    }
+    previous = sample;
+}
+
+static void run_sampler(unsigned generation, long long interval_ns) {
+    std::unique_lock<std::mutex> lock(sampler_mutex);
+    while (generation == sampler_generation) {
+        lock.unlock();
+        Sample sample;
+        bool sampled = take_sample(sample);
+        lock.lock();
+        if (sampled && generation == sampler_generation) {
+            record(sample);
+        }
+        sampler_stopped.wait_for(lock, std::chrono::nanoseconds(interval_ns),
+                                 [generation]() { return generation != sampler_generation; });
+    }
+}
+
+bool start_cpu_sampler(long long interval_ns) {
+    std::lock_guard<std::mutex> lock(sampler_mutex);
+    if (sampler_thread != NULL) {
+        return true;
+    }
+    if (stat_fd < 0) {
+        stat_fd = open("/proc/self/stat", O_RDONLY | O_CLOEXEC);
+        if (stat_fd < 0) {
+            LOGW("CPU sampler unavailable: cannot open /proc/self/stat");
+            return false;
+        }
+        // Missing when the kernel has no scheduler statistics, and then the switches stay at zero
+        schedstat_fd = open("/proc/self/schedstat", O_RDONLY | O_CLOEXEC);
+        long ticks_per_second = sysconf(_SC_CLK_TCK);
+        if (ticks_per_second > 0) {
+            ns_per_tick = 1000000000LL / ticks_per_second;
+        }
+    }
+    // Rates across a stop would span the pause
+    has_previous = false;
+    for (uint32_t metric = 0; metric < METRIC_COUNT; metric++) {
+        ring.spike_runs[metric] = 0;
+    }
+    sampler_thread = new std::thread(run_sampler, ++sampler_generation, interval_ns);
+    return true;
+}
+
+void stop_cpu_sampler() {
+    std::thread *thread;
+    {
+        std::lock_guard<std::mutex> lock(sampler_mutex);
+        thread = sampler_thread;
+        sampler_thread = NULL;
+        sampler_generation++;
+    }
+    sampler_stopped.notify_all();
+    if (thread != NULL) {
+        thread->join();
+        delete thread;
+    }
+}
+
+bool read_cpu_rates(CpuRates &result, long long window_ns) {
+    std::lock_guard<std::mutex> lock(sampler_mutex);
+    if (ring.count == 0) {
+        return false;
+    }
+    const Rate &latest = ring.rates[(ring.head + RING_CAPACITY - 1) % RING_CAPACITY];
+    memcpy(result.values, latest.values, sizeof(result.values));
+    result.anomalies = 0;
+    result.count = ring.count;
+    long long since = now_ns() - window_ns;
+    for (int i = 0; i < ring.count; i++) {
+        if (ring.rates[i].time_ns >= since) {
+            result.anomalies |= ring.rates[i].anomalies;
+        }
+    }
+    return true;
+}
+
+}  // namespace rasp
@@ -0,0 +1,41 @@
+﻿#pragma once
+
+#include <stdint.h>
+
+// Rolling sampler of the CPU time, page faults and context switches of the process.
+//
+// A background thread reads /proc/self/stat and /proc/self/schedstat with one pread each per
+// interval, through descriptors kept open, into a fixed ring of samples. The rates between
+// consecutive samples are compared with the mean and deviation of the earlier rates of the ring,
+// so that a spike, such as the faults of an injected agent or the switches of single-stepping,
+// stands out from what this process usually does rather than from fixed thresholds.
+
+namespace rasp {
+
+enum CpuMetric : uint32_t {
+    METRIC_CPU_PERCENT = 0,         // CPU time of the process over wall time, in percent
+    METRIC_MINOR_FAULTS,            // minor page faults of the process per second
+    METRIC_MAJOR_FAULTS,            // major page faults of the process per second
+    METRIC_CONTEXT_SWITCHES,        // times the main thread was scheduled per second, from schedstat
+    METRIC_COUNT
+};
+
+#define METRIC_BIT(metric) (1u << (metric))
+
+struct CpuRates {
+    double values[METRIC_COUNT];
+    // METRIC_BIT of each metric found anomalous within the window asked for
+    uint32_t anomalies;
+    // Rates in the ring, the baseline included
+    int count;
+};
+
+// Start sampling every interval_ns, if not started already. Returns false if /proc/self/stat cannot be read.
+bool start_cpu_sampler(long long interval_ns);
+
+void stop_cpu_sampler();
+
+// Latest rates, and the metrics found anomalous over the last window_ns. Returns false before two samples.
+bool read_cpu_rates(CpuRates &rates, long long window_ns);
+
+}  // namespace rasp
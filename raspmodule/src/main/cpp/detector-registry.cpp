@@ -0,0 +1,453 @@
+﻿#include "detector-registry.h"
+
+#include <android/log.h>
+#include <dirent.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ptrace.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#ifdef __ANDROID__
+#include <sys/system_properties.h>
+#endif
+
+#define LOG_TAG "RASPNative"
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
+
+namespace rasp {
+
+// Frida's default listening ports, 27042 to 27045
+#define FRIDA_PORT_FIRST 27042
+#define FRIDA_PORT_LAST 27045
+#define TCP_STATE_LISTEN 0x0A
+#define WRITABLE_EXECUTABLE_LIMIT 5
+
+static const char *const snapshot_names[SNAPSHOT_COUNT] = {
+    "maps", "status", "net_tcp", "processes", "properties"
+};
+
+static const char *const hook_libraries[] = {
+    "frida", "xposed", "substrate", "cydia", "libhook", NULL
+};
+
+static const char *const frida_libraries[] = {
+    "frida-gadget", "frida-agent", "frida-core", "libfrida", NULL
+};
+
+static const char *const frida_processes[] = {
+    "frida-server", "frida-helper", "frida-inject", "gum-js-loop", NULL
+};
+
+static const char *const security_properties[] = {
+    "ro.debuggable", "ro.secure", "ro.build.type", "ro.build.tags", "service.adb.root", "ro.kernel.qemu", NULL
+};
+
+static long long now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// --- Snapshots ---
+
+// Whole content of a file, which for procfs cannot be sized beforehand
+static bool read_file(const char *path, std::string &content) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    char buffer[4096];
+    ssize_t length;
+    while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+        content.append(buffer, length);
+    }
+    close(fd);
+    return length == 0;
+}
+
+// First argument of the command line of each process that can be seen
+static bool read_processes(std::string &content) {
+    DIR *proc = opendir("/proc");
+    if (proc == NULL) {
+        return false;
+    }
+    struct dirent *entry;
+    // Room for any name of a directory, as the compiler cannot tell that a pid is short
+    char path[PATH_MAX];
+    char command[256];
+    while ((entry = readdir(proc)) != NULL) {
+        if (entry->d_name[0] < '1' || entry->d_name[0] > '9') {
+            continue;
+        }
+        snprintf(path, sizeof(path), "/proc/%s/cmdline", entry->d_name);
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+        ssize_t length = read(fd, command, sizeof(command) - 1);
+        close(fd);
+        if (length <= 0) {
+            continue;
+        }
+        command[length] = '\0';
+        content.append(command);
+        content.push_back('\n');
+    }
+    closedir(proc);
+    return true;
+}
+
+static bool read_properties(std::string &content) {
+#ifdef __ANDROID__
+    char value[PROP_VALUE_MAX];
+    for (int i = 0; security_properties[i] != NULL; i++) {
+        if (__system_property_get(security_properties[i], value) > 0) {
+            content.append(security_properties[i]).append("=").append(value).push_back('\n');
+        }
+    }
+    return true;
+#else
+    (void)content;
+    return false;
+#endif
+}
+
+static bool materialize(uint32_t snapshot, std::string &content) {
+    switch (snapshot) {
+        case SNAPSHOT_MAPS:
+            return read_file("/proc/self/maps", content);
+        case SNAPSHOT_STATUS:
+            return read_file("/proc/self/status", content);
+        case SNAPSHOT_NET_TCP: {
+            // Either is enough: tcp6 also lists the IPv4 sockets bound to any address
+            bool tcp = read_file("/proc/net/tcp", content);
+            bool tcp6 = read_file("/proc/net/tcp6", content);
+            return tcp || tcp6;
+        }
+        case SNAPSHOT_PROCESSES:
+            return read_processes(content);
+        case SNAPSHOT_PROPERTIES:
+            return read_properties(content);
+        default:
+            return false;
+    }
+}
+
+// --- Built-in detectors ---
+
+static const char *find_any(const std::string &data, const char *const *needles) {
+    for (int i = 0; needles[i] != NULL; i++) {
+        if (data.find(needles[i]) != std::string::npos) {
+            return needles[i];
+        }
+    }
+    return NULL;
+}
+
+static bool has_property(const std::string &properties, const char *line) {
+    size_t length = strlen(line);
+    size_t position = 0;
+    while ((position = properties.find(line, position)) != std::string::npos) {
+        if ((position == 0 || properties[position - 1] == '\n') &&
+            (position + length == properties.size() || properties[position + length] == '\n')) {
+            return true;
+        }
+        position += length;
+    }
+    return false;
+}
+
+static bool detect_tracer(const Snapshots &snapshots) {
+    const std::string &status = snapshots.data[SNAPSHOT_STATUS];
+    size_t line = status.find("TracerPid:");
+    return line != std::string::npos && atoi(status.c_str() + line + 10) != 0;
+}
+
+static bool detect_hook_libraries(const Snapshots &snapshots) {
+    const char *library = find_any(snapshots.data[SNAPSHOT_MAPS], hook_libraries);
+    if (library != NULL) {
+        LOGW("Suspicious library detected in memory: %s", library);
+    }
+    return library != NULL;
+}
+
+static bool detect_frida_libraries(const Snapshots &snapshots) {
+    const char *library = find_any(snapshots.data[SNAPSHOT_MAPS], frida_libraries);
+    if (library != NULL) {
+        LOGW("Frida indicator detected: %s", library);
+    }
+    return library != NULL;
+}
+
+static bool detect_writable_executable(const Snapshots &snapshots) {
+    const std::string &maps = snapshots.data[SNAPSHOT_MAPS];
+    int count = 0;
+    for (size_t position = 0; (position = maps.find(" rwxp ", position)) != std::string::npos; position += 6) {
+        count++;
+    }
+    return count > WRITABLE_EXECUTABLE_LIMIT;
+}
+
+static bool detect_frida_port(const Snapshots &snapshots) {
+    const char *line = snapshots.data[SNAPSHOT_NET_TCP].c_str();
+    while (line != NULL && *line != '\0') {
+        unsigned int port;
+        unsigned int state;
+        // "  sl  local_address rem_address   st ...", the header line does not match
+        if (sscanf(line, " %*d: %*[0-9A-Fa-f]:%x %*[0-9A-Fa-f]:%*x %x", &port, &state) == 2 &&
+            state == TCP_STATE_LISTEN && port >= FRIDA_PORT_FIRST && port <= FRIDA_PORT_LAST) {
+            LOGW("Frida port listening: %u", port);
+            return true;
+        }
+        line = strchr(line, '\n');
+        if (line != NULL) {
+            line++;
+        }
+    }
+    return false;
+}
+
+static bool detect_frida_processes(const Snapshots &snapshots) {
+    const char *process = find_any(snapshots.data[SNAPSHOT_PROCESSES], frida_processes);
+    if (process != NULL) {
+        LOGW("Frida process detected: %s", process);
+    }
+    return process != NULL;
+}
+
+static bool detect_insecure_properties(const Snapshots &snapshots) {
+    const std::string &properties = snapshots.data[SNAPSHOT_PROPERTIES];
+    return has_property(properties, "ro.debuggable=1") || has_property(properties, "ro.secure=0") ||
+           has_property(properties, "service.adb.root=1") || has_property(properties, "ro.build.tags=test-keys");
+}
+
+// Trampolines written by inline hooking frameworks over the start of libc functions that anti-debugging relies on
+static bool detect_libc_trampolines(const Snapshots &snapshots) {
+    (void)snapshots;
+    const void *functions[] = {(const void *)&ptrace, (const void *)&kill, (const void *)&getpid};
+    for (const void *function : functions) {
+#if defined(__aarch64__)
+        // LDR X16/X17, #8 then BR X16/X17
+        uint32_t instructions[2];
+        memcpy(instructions, function, sizeof(instructions));
+        if ((instructions[0] == 0x58000050 && instructions[1] == 0xD61F0200) ||
+            (instructions[0] == 0x58000051 && instructions[1] == 0xD61F0220)) {
+            LOGW("Inline hook trampoline detected in libc");
+            return true;
+        }
+#elif defined(__x86_64__) || defined(__i386__)
+        // JMP rel32, or JMP [RIP+0]
+        const unsigned char *bytes = (const unsigned char *)function;
+        if (bytes[0] == 0xE9 || (bytes[0] == 0xFF && bytes[1] == 0x25)) {
+            LOGW("Inline hook trampoline detected in libc");
+            return true;
+        }
+#else
+        (void)function;
+#endif
+    }
+    return false;
+}
+
+// --- Registry ---
+
+static std::mutex registry_mutex;
+static std::vector<Detector> registry = {
+    {"tracer_pid", SNAPSHOT_BIT(SNAPSHOT_STATUS), COST_CHEAP, ISA_ANY, detect_tracer},
+    {"hook_libraries", SNAPSHOT_BIT(SNAPSHOT_MAPS), COST_CHEAP, ISA_ANY, detect_hook_libraries},
+    {"frida_libraries", SNAPSHOT_BIT(SNAPSHOT_MAPS), COST_CHEAP, ISA_ANY, detect_frida_libraries},
+    {"writable_executable", SNAPSHOT_BIT(SNAPSHOT_MAPS), COST_CHEAP, ISA_ANY, detect_writable_executable},
+    {"insecure_properties", SNAPSHOT_BIT(SNAPSHOT_PROPERTIES), COST_CHEAP, ISA_ANY, detect_insecure_properties},
+    {"libc_trampolines", 0, COST_CHEAP, ISA_ARM64 | ISA_X86 | ISA_X86_64, detect_libc_trampolines},
+    {"frida_port", SNAPSHOT_BIT(SNAPSHOT_NET_TCP), COST_MODERATE, ISA_ANY, detect_frida_port},
+    {"frida_processes", SNAPSHOT_BIT(SNAPSHOT_PROCESSES), COST_EXPENSIVE, ISA_ANY, detect_frida_processes},
+};
+// Kept for describe_graph
+static Tick last_tick;
+static bool has_last_tick = false;
+
+void register_detector(const Detector &detector) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    registry.push_back(detector);
+}
+
+uint32_t current_isa() {
+#if defined(__aarch64__)
+    return ISA_ARM64;
+#elif defined(__arm__)
+    return ISA_ARM;
+#elif defined(__x86_64__)
+    return ISA_X86_64;
+#elif defined(__i386__)
+    return ISA_X86;
+#else
+    return 0;
+#endif
+}
+
+const char *snapshot_name(uint32_t snapshot) {
+    return snapshot < SNAPSHOT_COUNT ? snapshot_names[snapshot] : "unknown";
+}
+
+// --- Executor ---
+
+Tick run_tick(CostClass max_cost, int worker_count) {
+    std::vector<Detector> detectors;
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        for (const Detector &detector : registry) {
+            if (detector.cost <= max_cost && (detector.isa & current_isa()) != 0) {
+                detectors.push_back(detector);
+            }
+        }
+    }
+
+    Tick tick;
+    tick.start_ns = now_ns();
+    tick.results.resize(detectors.size());
+    memset(tick.snapshots, 0, sizeof(tick.snapshots));
+    Snapshots snapshots;
+    memset(snapshots.available, 0, sizeof(snapshots.available));
+
+    // Tasks 0 to SNAPSHOT_COUNT - 1 materialize a snapshot, and task SNAPSHOT_COUNT + i runs detector i
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<int> ready;
+    std::vector<int> missing_inputs(detectors.size());
+    int remaining = (int)detectors.size();
+
+    uint32_t needed = 0;
+    for (const Detector &detector : detectors) {
+        needed |= detector.inputs;
+    }
+    for (uint32_t snapshot = 0; snapshot < SNAPSHOT_COUNT; snapshot++) {
+        if (needed & SNAPSHOT_BIT(snapshot)) {
+            ready.push_back((int)snapshot);
+            remaining++;
+        }
+    }
+    for (size_t i = 0; i < detectors.size(); i++) {
+        missing_inputs[i] = __builtin_popcount(detectors[i].inputs);
+        if (missing_inputs[i] == 0) {
+            ready.push_back(SNAPSHOT_COUNT + (int)i);
+        }
+    }
+
+    auto work = [&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            changed.wait(lock, [&]() { return !ready.empty() || remaining == 0; });
+            if (ready.empty()) {
+                return;
+            }
+            int task = ready.front();
+            ready.pop_front();
+            lock.unlock();
+
+            // Each task writes only its own slot, which the others read after taking the lock
+            long long start = now_ns();
+            if (task < (int)SNAPSHOT_COUNT) {
+                SnapshotTiming &timing = tick.snapshots[task];
+                snapshots.available[task] = materialize((uint32_t)task, snapshots.data[task]);
+                timing.materialized = true;
+                timing.available = snapshots.available[task];
+                timing.size = snapshots.data[task].size();
+                timing.start_ns = start - tick.start_ns;
+                timing.end_ns = now_ns() - tick.start_ns;
+            } else {
+                const Detector &detector = detectors[task - SNAPSHOT_COUNT];
+                DetectorResult &result = tick.results[task - SNAPSHOT_COUNT];
+                // A detector only reports on what it could read
+                bool readable = true;
+                for (uint32_t snapshot = 0; snapshot < SNAPSHOT_COUNT; snapshot++) {
+                    if ((detector.inputs & SNAPSHOT_BIT(snapshot)) && !snapshots.available[snapshot]) {
+                        readable = false;
+                    }
+                }
+                result.name = detector.name;
+                result.detected = readable && detector.detect(snapshots);
+                result.start_ns = start - tick.start_ns;
+                result.end_ns = now_ns() - tick.start_ns;
+            }
+
+            lock.lock();
+            remaining--;
+            if (task < (int)SNAPSHOT_COUNT) {
+                for (size_t i = 0; i < detectors.size(); i++) {
+                    if ((detectors[i].inputs & SNAPSHOT_BIT(task)) && --missing_inputs[i] == 0) {
+                        ready.push_back(SNAPSHOT_COUNT + (int)i);
+                    }
+                }
+            }
+            changed.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 1; i < worker_count; i++) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    tick.end_ns = now_ns() - tick.start_ns;
+    tick.start_ns = 0;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    last_tick = tick;
+    has_last_tick = true;
+    return tick;
+}
+
+std::string describe_graph() {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    std::string graph = "digraph detectors {\n";
+    char line[256];
+    for (uint32_t snapshot = 0; snapshot < SNAPSHOT_COUNT; snapshot++) {
+        const SnapshotTiming &timing = last_tick.snapshots[snapshot];
+        if (has_last_tick && timing.materialized) {
+            snprintf(line, sizeof(line), "  \"%s\" [shape=box, label=\"%s\\n%zu bytes%s\\n%lld-%lld us\"];\n",
+                     snapshot_names[snapshot], snapshot_names[snapshot], timing.size,
+                     timing.available ? "" : ", unavailable", timing.start_ns / 1000, timing.end_ns / 1000);
+        } else {
+            snprintf(line, sizeof(line), "  \"%s\" [shape=box];\n", snapshot_names[snapshot]);
+        }
+        graph += line;
+    }
+    for (const Detector &detector : registry) {
+        const DetectorResult *result = NULL;
+        for (const DetectorResult &candidate : last_tick.results) {
+            if (has_last_tick && strcmp(candidate.name, detector.name) == 0) {
+                result = &candidate;
+            }
+        }
+        if (result != NULL) {
+            snprintf(line, sizeof(line), "  \"%s\" [label=\"%s\\ncost %d%s\\n%lld-%lld us\"];\n",
+                     detector.name, detector.name, (int)detector.cost, result->detected ? ", detected" : "",
+                     result->start_ns / 1000, result->end_ns / 1000);
+        } else {
+            snprintf(line, sizeof(line), "  \"%s\" [label=\"%s\\ncost %d\", style=dashed];\n",
+                     detector.name, detector.name, (int)detector.cost);
+        }
+        graph += line;
+        for (uint32_t snapshot = 0; snapshot < SNAPSHOT_COUNT; snapshot++) {
+            if (detector.inputs & SNAPSHOT_BIT(snapshot)) {
+                snprintf(line, sizeof(line), "  \"%s\" -> \"%s\";\n", snapshot_names[snapshot], detector.name);
+                graph += line;
+            }
+        }
+    }
+    graph += "}\n";
+    return graph;
+}
+
+}  // namespace rasp
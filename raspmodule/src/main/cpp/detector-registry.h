@@ -0,0 +1,94 @@
+﻿#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Registry of the native detectors, and executor running them on shared snapshots.
+//
+// A detector declares the snapshots of the process and system state it reads, its cost class and
+// the instruction sets it applies to. A tick materializes each snapshot needed by the selected
+// detectors once, on a few worker threads, and runs each detector as soon as its snapshots are
+// ready, so that detectors reading the same procfs file no longer read it each.
+
+namespace rasp {
+
+enum Snapshot : uint32_t {
+    SNAPSHOT_MAPS = 0,        // /proc/self/maps
+    SNAPSHOT_STATUS,          // /proc/self/status
+    SNAPSHOT_NET_TCP,         // /proc/net/tcp and /proc/net/tcp6
+    SNAPSHOT_PROCESSES,       // command line of every visible process, one per line
+    SNAPSHOT_PROPERTIES,      // security-relevant system properties, one name=value per line
+    SNAPSHOT_COUNT
+};
+
+#define SNAPSHOT_BIT(snapshot) (1u << (snapshot))
+
+enum CostClass : int {
+    COST_CHEAP = 0,
+    COST_MODERATE = 1,
+    COST_EXPENSIVE = 2
+};
+
+enum Isa : uint32_t {
+    ISA_ARM = 0x1,
+    ISA_ARM64 = 0x2,
+    ISA_X86 = 0x4,
+    ISA_X86_64 = 0x8,
+    ISA_ANY = 0xF
+};
+
+struct Snapshots {
+    std::string data[SNAPSHOT_COUNT];
+    // False when the snapshot could not be read, such as /proc/net/tcp on recent Android versions
+    bool available[SNAPSHOT_COUNT];
+};
+
+struct Detector {
+    const char *name;
+    // SNAPSHOT_BIT of each snapshot read
+    uint32_t inputs;
+    CostClass cost;
+    // Isa values the detector applies to
+    uint32_t isa;
+    bool (*detect)(const Snapshots &snapshots);
+};
+
+struct DetectorResult {
+    const char *name;
+    bool detected;
+    long long start_ns;
+    long long end_ns;
+};
+
+struct SnapshotTiming {
+    bool materialized;
+    bool available;
+    size_t size;
+    long long start_ns;
+    long long end_ns;
+};
+
+struct Tick {
+    std::vector<DetectorResult> results;
+    SnapshotTiming snapshots[SNAPSHOT_COUNT];
+    long long start_ns;
+    long long end_ns;
+};
+
+// Add a detector to the registry, which holds the built-in ones from the start
+void register_detector(const Detector &detector);
+
+// Isa value of the running code
+uint32_t current_isa();
+
+const char *snapshot_name(uint32_t snapshot);
+
+// Run the detectors of the current instruction set of at most max_cost on worker_count threads
+Tick run_tick(CostClass max_cost, int worker_count);
+
+// DOT graph of the snapshots and the detectors reading them, with the timings of the last tick
+std::string describe_graph();
+
+}  // namespace rasp
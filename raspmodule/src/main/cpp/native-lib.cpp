@@ -6,11 +6,20 @@
 #include <signal.h>
 #include <errno.h>
 #include <android/log.h>
-#include <sys/mman.h>
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <time.h>
 #include <stdlib.h>
+#include <stddef.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <link.h>
+#include <atomic>
+#include <vector>
+#include "cpu-sampler.h"
+#include "detector-registry.h"
+#include "protected-regions.h"
 
 #define LOG_TAG "RASPNative"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
@@ -44,6 +53,141 @@ long long get_time_ns() {
     return ts.tv_sec * 1000000000LL + ts.tv_nsec;
 }
 
+// Flags of the startup fast verdict, as read by RASP.performStartupCheck
+#define FAST_DEBUGGER 0x1
+#define FAST_ROOT 0x2
+#define FAST_HOOKS 0x4
+#define FAST_DEADLINE_EXCEEDED 0x100
+#define FAST_ROOT_UNKNOWN 0x200
+
+#define BOOT_ID_LENGTH 36
+#define WARM_UP_BUDGET_NS 50000000LL
+#define MAX_DETECTOR_WORKERS 4
+
+static const char *const suspicious_modules[] = {
+    "frida", "xposed", "substrate", "cydia", "libhook", NULL
+};
+
+// Hook verdict of the loaded modules: (dlpi_adds << 1) | hooked, 0 before the first scan.
+// It stays valid until a module is loaded again, which is what changes dlpi_adds.
+static std::atomic<unsigned long long> module_verdict(0);
+static std::atomic<bool> signal_handlers_installed(false);
+
+struct ModuleScan {
+    unsigned long long adds;
+    bool has_adds;
+    bool hooked;
+    bool stop_after_first;
+    long long deadline;
+    bool deadline_exceeded;
+};
+
+// TracerPid of /proc/self/status, read without stdio: it is within the first few lines
+static int read_tracer_pid() {
+    int fd = open("/proc/self/status", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return 0;
+    }
+    char buffer[512];
+    ssize_t length = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if (length <= 0) {
+        return 0;
+    }
+    buffer[length] = '\0';
+    const char *line = strstr(buffer, "TracerPid:");
+    return line != NULL ? atoi(line + 10) : 0;
+}
+
+// Boot id of the kernel, which changes on every boot
+static bool read_boot_id(char *boot_id) {
+    int fd = open("/proc/sys/kernel/random/boot_id", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    ssize_t length = read(fd, boot_id, BOOT_ID_LENGTH);
+    close(fd);
+    boot_id[length > 0 ? length : 0] = '\0';
+    return length == BOOT_ID_LENGTH;
+}
+
+// Flags stored for this boot in the boot facts file, -1 if they were stored for another boot
+static int read_boot_facts(const char *path) {
+    char boot_id[BOOT_ID_LENGTH + 1];
+    if (!read_boot_id(boot_id)) {
+        return -1;
+    }
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    char buffer[64];
+    ssize_t length = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if (length <= BOOT_ID_LENGTH) {
+        return -1;
+    }
+    buffer[length] = '\0';
+    if (strncmp(buffer, boot_id, BOOT_ID_LENGTH) != 0 || buffer[BOOT_ID_LENGTH] != ' ') {
+        return -1;
+    }
+    return atoi(buffer + BOOT_ID_LENGTH + 1);
+}
+
+static int scan_module(struct dl_phdr_info *info, size_t size, void *data) {
+    ModuleScan *scan = (ModuleScan *)data;
+    // dlpi_adds is only there in the newer versions of the structure
+    if (size >= offsetof(struct dl_phdr_info, dlpi_adds) + sizeof(info->dlpi_adds)) {
+        scan->adds = info->dlpi_adds;
+        scan->has_adds = true;
+    }
+    if (scan->stop_after_first) {
+        return 1;
+    }
+    if (info->dlpi_name != NULL) {
+        for (int i = 0; suspicious_modules[i] != NULL; i++) {
+            if (strstr(info->dlpi_name, suspicious_modules[i])) {
+                LOGW("Suspicious module loaded: %s", info->dlpi_name);
+                scan->hooked = true;
+                return 1;
+            }
+        }
+    }
+    if (get_time_ns() > scan->deadline) {
+        scan->deadline_exceeded = true;
+        return 1;
+    }
+    return 0;
+}
+
+// Install the handlers counting the signals a debugger delivers, once
+static void install_signal_handlers() {
+    if (!signal_handlers_installed.exchange(true)) {
+        signal(SIGTRAP, sigtrap_handler);
+        signal(SIGCONT, sigstop_handler);
+    }
+}
+
+// Whether a hooking framework is among the loaded modules, from the cache while none was loaded
+static int check_loaded_modules(long long deadline) {
+    ModuleScan scan = {0, false, false, true, deadline, false};
+    dl_iterate_phdr(scan_module, &scan);
+    unsigned long long cached = module_verdict.load(std::memory_order_acquire);
+    if (scan.has_adds && cached != 0 && (cached >> 1) == scan.adds) {
+        return (cached & 1) ? FAST_HOOKS : 0;
+    }
+
+    scan.stop_after_first = false;
+    dl_iterate_phdr(scan_module, &scan);
+    if (scan.deadline_exceeded) {
+        return FAST_DEADLINE_EXCEEDED;
+    }
+    if (scan.has_adds) {
+        module_verdict.store((scan.adds << 1) | (scan.hooked ? 1 : 0), std::memory_order_release);
+    }
+    return scan.hooked ? FAST_HOOKS : 0;
+}
+
 extern "C" {
 
 // DebuggerDetection native methods
@@ -414,21 +558,78 @@ Java_com.example.raspsdk_RASP_nativeHardenSystem(JNIEnv *env, jclass clazz) {
     return JNI_TRUE;
 }
 
-// Memory protection utilities
+// Protected regions: page-aligned memory for secrets, with tracked and batched access changes
+JNIEXPORT jint JNICALL
+Java_com_example_raspsdk_ProtectedMemory_nativeCreate(JNIEnv *env, jclass clazz, jint size) {
+    (void)env;    // Suppress unused parameter warning
+    (void)clazz;  // Suppress unused parameter warning
+
+    return size < 0 ? -1 : rasp::region_create((size_t)size);
+}
+
 JNIEXPORT jboolean JNICALL
-Java_com.example.raspsdk_RASP_nativeProtectMemory(JNIEnv *env, jclass clazz, jlong addr, jint size) {
+Java_com_example_raspsdk_ProtectedMemory_nativeRelease(JNIEnv *env, jclass clazz, jint id) {
     (void)env;    // Suppress unused parameter warning
     (void)clazz;  // Suppress unused parameter warning
-    
-    // Make memory region read-only
-    void *memory_addr = (void*)addr;
-    
-    if (mprotect(memory_addr, size, PROT_READ) == -1) {
-        LOGE("Failed to protect memory region: %s", strerror(errno));
+
+    return rasp::region_release(id) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_raspsdk_ProtectedMemory_nativeSetAccess(JNIEnv *env, jclass clazz, jintArray ids, jint access) {
+    (void)clazz;  // Suppress unused parameter warning
+
+    if (access < rasp::REGION_NO_ACCESS || access > rasp::REGION_READ_WRITE) {
         return JNI_FALSE;
     }
-    
-    return JNI_TRUE;
+    jsize count = env->GetArrayLength(ids);
+    std::vector<jint> values(count);
+    env->GetIntArrayRegion(ids, 0, count, values.data());
+    std::vector<int> regions(values.begin(), values.end());
+    return rasp::region_set_access(regions.data(), count, (rasp::RegionAccess)access) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_raspsdk_ProtectedMemory_nativeWrite(JNIEnv *env, jclass clazz, jint id, jint offset, jbyteArray data) {
+    (void)clazz;  // Suppress unused parameter warning
+
+    jsize length = env->GetArrayLength(data);
+    if (offset < 0 || (size_t)length > rasp::region_size(id)) {
+        return JNI_FALSE;
+    }
+    // Copied into a buffer on the heap, and wiped there, rather than pinning the array
+    std::vector<jbyte> bytes(length);
+    env->GetByteArrayRegion(data, 0, length, bytes.data());
+    bool written = rasp::region_write(id, (size_t)offset, bytes.data(), (size_t)length);
+    memset(bytes.data(), 0, bytes.size());
+    return written ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jbyteArray JNICALL
+Java_com_example_raspsdk_ProtectedMemory_nativeRead(JNIEnv *env, jclass clazz, jint id, jint offset, jint length) {
+    (void)clazz;  // Suppress unused parameter warning
+
+    if (offset < 0 || length < 0 || (size_t)length > rasp::region_size(id)) {
+        return NULL;
+    }
+    std::vector<jbyte> bytes(length);
+    if (!rasp::region_read(id, (size_t)offset, bytes.data(), (size_t)length)) {
+        return NULL;
+    }
+    jbyteArray result = env->NewByteArray(length);
+    if (result != NULL) {
+        env->SetByteArrayRegion(result, 0, length, bytes.data());
+    }
+    memset(bytes.data(), 0, bytes.size());
+    return result;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_example_raspsdk_ProtectedMemory_nativeUsesProtectionKeys(JNIEnv *env, jclass clazz) {
+    (void)env;    // Suppress unused parameter warning
+    (void)clazz;  // Suppress unused parameter warning
+
+    return rasp::regions_use_protection_keys() ? JNI_TRUE : JNI_FALSE;
 }
 
 // Random delay for timing obfuscation
@@ -463,5 +664,237 @@ Java_com.example.raspsdk_RASP_nativeAntiFork(JNIEnv *env, jclass clazz) {
     }
 }
 
+// Load generation of the modules: dlpi_adds, which grows when a module is loaded, -1 if unknown
+JNIEXPORT jlong JNICALL
+Java_com_example_raspsdk_ClassProbe_nativeModuleGeneration(JNIEnv *env, jclass clazz) {
+    (void)env;    // Suppress unused parameter warning
+    (void)clazz;  // Suppress unused parameter warning
+
+    ModuleScan scan = {0, false, false, true, 0, false};
+    dl_iterate_phdr(scan_module, &scan);
+    return scan.has_adds ? (jlong)scan.adds : -1;
+}
+
+// Index of the first of the class names present, -1 if none: each name is looked up among the
+// classes already loaded by each loader, which fails without an exception, then by FindClass,
+// whose exception is cleared at once
+JNIEXPORT jint JNICALL
+Java_com_example_raspsdk_ClassProbe_nativeProbeClasses(JNIEnv *env, jclass clazz, jobjectArray names, jobjectArray loaders) {
+    (void)clazz;  // Suppress unused parameter warning
+
+    jclass loader_class = env->FindClass("java/lang/ClassLoader");
+    if (loader_class == NULL) {
+        env->ExceptionClear();
+        return -1;
+    }
+    // Protected, which JNI does not check
+    jmethodID find_loaded_class = env->GetMethodID(loader_class, "findLoadedClass", "(Ljava/lang/String;)Ljava/lang/Class;");
+    env->DeleteLocalRef(loader_class);
+    if (find_loaded_class == NULL) {
+        env->ExceptionClear();
+    }
+
+    jsize name_count = env->GetArrayLength(names);
+    jsize loader_count = env->GetArrayLength(loaders);
+    char descriptor[256];
+    for (jsize i = 0; i < name_count; i++) {
+        jstring name = (jstring)env->GetObjectArrayElement(names, i);
+        bool found = false;
+        for (jsize j = 0; !found && find_loaded_class != NULL && j < loader_count; j++) {
+            jobject loader = env->GetObjectArrayElement(loaders, j);
+            jobject loaded = env->CallObjectMethod(loader, find_loaded_class, name);
+            if (env->ExceptionCheck()) {
+                env->ExceptionClear();
+            }
+            found = loaded != NULL;
+            if (loaded != NULL) {
+                env->DeleteLocalRef(loaded);
+            }
+            env->DeleteLocalRef(loader);
+        }
+
+        if (!found) {
+            // FindClass takes the internal name, with slashes
+            const char *chars = env->GetStringUTFChars(name, NULL);
+            if (chars != NULL && strlen(chars) < sizeof(descriptor)) {
+                size_t k = 0;
+                for (; chars[k] != '\0'; k++) {
+                    descriptor[k] = chars[k] == '.' ? '/' : chars[k];
+                }
+                descriptor[k] = '\0';
+                jclass probed = env->FindClass(descriptor);
+                if (probed != NULL) {
+                    found = true;
+                    env->DeleteLocalRef(probed);
+                } else {
+                    env->ExceptionClear();
+                }
+            }
+            if (chars != NULL) {
+                env->ReleaseStringUTFChars(name, chars);
+            }
+        }
+        env->DeleteLocalRef(name);
+        if (found) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Warm-up of a preloaded library, off the main thread: install the signal handlers and fill the
+// cache of the loaded modules, so that the first fast verdict only has to read them
+JNIEXPORT void JNICALL
+Java_com_example_raspsdk_NativeLoader_nativeWarmUp(JNIEnv *env, jclass clazz) {
+    (void)env;    // Suppress unused parameter warning
+    (void)clazz;  // Suppress unused parameter warning
+
+    install_signal_handlers();
+    check_loaded_modules(get_time_ns() + WARM_UP_BUDGET_NS);
+}
+
+// Startup fast verdict: the cheapest high-signal checks, by increasing cost, within a budget
+JNIEXPORT jint JNICALL
+Java_com_example_raspsdk_RASP_nativeFastVerdict(JNIEnv *env, jclass clazz, jstring boot_facts_path, jlong budget_ns) {
+    (void)clazz;  // Suppress unused parameter warning
+
+    long long deadline = get_time_ns() + budget_ns;
+    int flags = 0;
+
+    // Signals a debugger delivers, counted since the handlers were first installed
+    install_signal_handlers();
+    if (debugger_detected || read_tracer_pid() != 0) {
+        flags |= FAST_DEBUGGER;
+    }
+
+    // Root as found by the last full check of this boot
+    const char *path = env->GetStringUTFChars(boot_facts_path, NULL);
+    int boot_facts = path != NULL ? read_boot_facts(path) : -1;
+    if (path != NULL) {
+        env->ReleaseStringUTFChars(boot_facts_path, path);
+    }
+    if (boot_facts < 0) {
+        flags |= FAST_ROOT_UNKNOWN;
+    } else if (boot_facts & FAST_ROOT) {
+        flags |= FAST_ROOT;
+    }
+
+    if (get_time_ns() > deadline) {
+        return flags | FAST_DEADLINE_EXCEEDED;
+    }
+    return flags | check_loaded_modules(deadline);
+}
+
+// Store the facts found by a full check for the next fast verdicts of this boot
+JNIEXPORT jboolean JNICALL
+Java_com_example_raspsdk_RASP_nativeStoreBootFacts(JNIEnv *env, jclass clazz, jstring boot_facts_path, jint facts) {
+    (void)clazz;  // Suppress unused parameter warning
+
+    char boot_id[BOOT_ID_LENGTH + 1];
+    if (!read_boot_id(boot_id)) {
+        return JNI_FALSE;
+    }
+    const char *path = env->GetStringUTFChars(boot_facts_path, NULL);
+    if (path == NULL) {
+        return JNI_FALSE;
+    }
+    // Written aside then renamed, so that a fast verdict never reads half a file
+    char temporary_path[PATH_MAX];
+    snprintf(temporary_path, sizeof(temporary_path), "%s.tmp", path);
+    char content[64];
+    int length = snprintf(content, sizeof(content), "%s %d\n", boot_id, (int)facts);
+    bool stored = false;
+    int fd = open(temporary_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd >= 0) {
+        stored = write(fd, content, length) == length;
+        close(fd);
+        stored = stored && rename(temporary_path, path) == 0;
+    }
+    if (!stored) {
+        LOGW("Failed to store boot facts: %s", strerror(errno));
+    }
+    env->ReleaseStringUTFChars(boot_facts_path, path);
+    return stored ? JNI_TRUE : JNI_FALSE;
+}
+
+// Run the registered detectors of at most max_cost, and return the names of those that detected a threat;
+// null if they cannot be returned
+JNIEXPORT jobjectArray JNICALL
+Java_com_example_raspsdk_RASP_nativeRunDetectors(JNIEnv *env, jclass clazz, jint max_cost) {
+    (void)clazz;  // Suppress unused parameter warning
+
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    int workers = processors < 1 ? 1 : processors > MAX_DETECTOR_WORKERS ? MAX_DETECTOR_WORKERS : (int)processors;
+    rasp::Tick tick = rasp::run_tick((rasp::CostClass)max_cost, workers);
+
+    std::vector<const char *> detected;
+    for (const rasp::DetectorResult &result : tick.results) {
+        if (result.detected) {
+            LOGW("Native detector %s detected a threat", result.name);
+            detected.push_back(result.name);
+        }
+    }
+    jobjectArray names = env->NewObjectArray((jsize)detected.size(), env->FindClass("java/lang/String"), NULL);
+    if (names == NULL) {
+        return NULL;
+    }
+    for (size_t i = 0; i < detected.size(); i++) {
+        jstring name = env->NewStringUTF(detected[i]);
+        if (name == NULL) {
+            return NULL;
+        }
+        env->SetObjectArrayElement(names, (jsize)i, name);
+        env->DeleteLocalRef(name);
+    }
+    return names;
+}
+
+// DOT graph of the detectors and the snapshots they read, for tracing
+JNIEXPORT jstring JNICALL
+Java_com_example_raspsdk_RASP_nativeDetectorGraph(JNIEnv *env, jclass clazz) {
+    (void)clazz;  // Suppress unused parameter warning
+
+    return env->NewStringUTF(rasp::describe_graph().c_str());
+}
+
+// CpuSampler native methods
+JNIEXPORT jboolean JNICALL
+Java_com_example_raspsdk_CpuSampler_nativeStart(JNIEnv *env, jclass clazz, jlong interval_ns) {
+    (void)env;    // Suppress unused parameter warning
+    (void)clazz;  // Suppress unused parameter warning
+
+    return rasp::start_cpu_sampler(interval_ns) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL
+Java_com_example_raspsdk_CpuSampler_nativeStop(JNIEnv *env, jclass clazz) {
+    (void)env;    // Suppress unused parameter warning
+    (void)clazz;  // Suppress unused parameter warning
+
+    rasp::stop_cpu_sampler();
+}
+
+// Latest rates by CpuMetric, then the anomalous metrics over the window and the rate count; null before two samples
+JNIEXPORT jdoubleArray JNICALL
+Java_com_example_raspsdk_CpuSampler_nativeReadRates(JNIEnv *env, jclass clazz, jlong window_ns) {
+    (void)clazz;  // Suppress unused parameter warning
+
+    rasp::CpuRates rates;
+    if (!rasp::read_cpu_rates(rates, window_ns)) {
+        return NULL;
+    }
+    jdouble values[rasp::METRIC_COUNT + 2];
+    for (uint32_t metric = 0; metric < rasp::METRIC_COUNT; metric++) {
+        values[metric] = rates.values[metric];
+    }
+    values[rasp::METRIC_COUNT] = rates.anomalies;
+    values[rasp::METRIC_COUNT + 1] = rates.count;
+    jdoubleArray result = env->NewDoubleArray(rasp::METRIC_COUNT + 2);
+    if (result != NULL) {
+        env->SetDoubleArrayRegion(result, 0, rasp::METRIC_COUNT + 2, values);
+    }
+    return result;
+}
+
 } // extern "C"
 
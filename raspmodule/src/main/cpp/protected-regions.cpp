@@ -0,0 +1,293 @@
+﻿#include "protected-regions.h"
+
+#include <android/log.h>
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+#define LOG_TAG "RASPNative"
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(SYS_pkey_alloc) && defined(SYS_pkey_mprotect)
+#define HAS_PROTECTION_KEYS 1
+#else
+#define HAS_PROTECTION_KEYS 0
+#endif
+
+#ifndef PKEY_DISABLE_ACCESS
+#define PKEY_DISABLE_ACCESS 0x1
+#endif
+
+namespace rasp {
+
+struct Region {
+    char *address;
+    size_t size;
+    RegionAccess access;
+    // Protection key guarding the region, -1 when its page protections do
+    int pkey;
+    bool used;
+    // Incremented when the slot is released, so that the ids of former regions no longer match it
+    int generation;
+};
+
+// An id is the slot of its region in the low bits and the generation of the slot above them
+#define REGION_SLOT_BITS 16
+#define REGION_MAX_SLOTS (1 << REGION_SLOT_BITS)
+#define REGION_GENERATION_MASK 0x7fff
+
+static std::mutex regions_mutex;
+static std::vector<Region> regions;
+// Cleared once allocating a key failed for lack of support, rather than of free keys
+static bool protection_keys_supported = HAS_PROTECTION_KEYS;
+
+#if HAS_PROTECTION_KEYS
+// Access disabled and write disabled bits of a key in PKRU
+#define PKRU_ACCESS_DISABLED(pkey) (1u << (2 * (pkey)))
+#define PKRU_WRITE_DISABLED(pkey) (1u << (2 * (pkey) + 1))
+
+// RDPKRU and WRPKRU, spelled as bytes for assemblers that do not know them
+static inline uint32_t read_pkru() {
+    uint32_t eax;
+    uint32_t edx;
+    __asm__ volatile(".byte 0x0f, 0x01, 0xee" : "=a"(eax), "=d"(edx) : "c"(0));
+    return eax;
+}
+
+static inline void write_pkru(uint32_t pkru) {
+    __asm__ volatile(".byte 0x0f, 0x01, 0xef" : : "a"(pkru), "c"(0), "d"(0) : "memory");
+}
+
+static int allocate_pkey() {
+    if (!protection_keys_supported) {
+        return -1;
+    }
+    int pkey = (int)syscall(SYS_pkey_alloc, 0, PKEY_DISABLE_ACCESS);
+    // ENOSPC only means that every key is taken: the next regions may still get one
+    if (pkey < 0 && errno != ENOSPC) {
+        protection_keys_supported = false;
+    }
+    return pkey;
+}
+
+// Open a region to the calling thread for one copy, returning the PKRU value to restore
+static uint32_t open_pkey(int pkey, bool write) {
+    uint32_t pkru = read_pkru();
+    uint32_t opened = pkru & ~PKRU_ACCESS_DISABLED(pkey);
+    opened = write ? opened & ~PKRU_WRITE_DISABLED(pkey) : opened | PKRU_WRITE_DISABLED(pkey);
+    write_pkru(opened);
+    return pkru;
+}
+#endif
+
+static int page_protection(RegionAccess access) {
+    switch (access) {
+        case REGION_READ_ONLY:
+            return PROT_READ;
+        case REGION_READ_WRITE:
+            return PROT_READ | PROT_WRITE;
+        default:
+            return PROT_NONE;
+    }
+}
+
+static Region *find_region(int id) {
+    if (id < 0) {
+        return NULL;
+    }
+    size_t slot = (size_t)(id & (REGION_MAX_SLOTS - 1));
+    if (slot >= regions.size() || !regions[slot].used || regions[slot].generation != id >> REGION_SLOT_BITS) {
+        return NULL;
+    }
+    return &regions[slot];
+}
+
+static int region_id(size_t slot) {
+    return (int)slot | (regions[slot].generation << REGION_SLOT_BITS);
+}
+
+// Copy between a region and memory outside it, with the access opened for the copy if a key guards it
+static void copy(const Region &region, bool write, size_t offset, void *data, size_t length) {
+#if HAS_PROTECTION_KEYS
+    if (region.pkey >= 0) {
+        uint32_t pkru = open_pkey(region.pkey, write);
+        if (write) {
+            memcpy(region.address + offset, data, length);
+        } else {
+            memcpy(data, region.address + offset, length);
+        }
+        write_pkru(pkru);
+        return;
+    }
+#endif
+    if (write) {
+        memcpy(region.address + offset, data, length);
+    } else {
+        memcpy(data, region.address + offset, length);
+    }
+}
+
+// Through a volatile pointer, so that zeroing memory about to be unmapped is not optimized out
+static void wipe(char *address, size_t size) {
+    volatile char *bytes = address;
+    for (size_t i = 0; i < size; i++) {
+        bytes[i] = 0;
+    }
+}
+
+int region_create(size_t size) {
+    long page_size = sysconf(_SC_PAGESIZE);
+    size_t rounded = (size + page_size - 1) / page_size * page_size;
+    if (rounded == 0) {
+        rounded = page_size;
+    }
+    std::lock_guard<std::mutex> lock(regions_mutex);
+    size_t slot = 0;
+    while (slot < regions.size() && regions[slot].used) {
+        slot++;
+    }
+    if (slot == REGION_MAX_SLOTS) {
+        LOGW("Too many protected regions");
+        return -1;
+    }
+    void *address = mmap(NULL, rounded, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (address == MAP_FAILED) {
+        LOGW("Failed to map a protected region: %s", strerror(errno));
+        return -1;
+    }
+    // Kept out of core dumps, which would write the secrets it holds to disk
+    madvise(address, rounded, MADV_DONTDUMP);
+
+    int pkey = -1;
+#if HAS_PROTECTION_KEYS
+    pkey = allocate_pkey();
+    // Pages readable and writable: the key alone denies the access
+    if (pkey >= 0 && syscall(SYS_pkey_mprotect, address, rounded, PROT_READ | PROT_WRITE, pkey) != 0) {
+        syscall(SYS_pkey_free, pkey);
+        pkey = -1;
+    }
+#endif
+
+    // A reused slot keeps its generation, already moved past the ids of its former regions
+    int generation = slot < regions.size() ? regions[slot].generation : 0;
+    Region region = {(char *)address, rounded, REGION_NO_ACCESS, pkey, true, generation};
+    if (slot < regions.size()) {
+        regions[slot] = region;
+    } else {
+        regions.push_back(region);
+    }
+    return region_id(slot);
+}
+
+bool region_release(int id) {
+    std::lock_guard<std::mutex> lock(regions_mutex);
+    Region *region = find_region(id);
+    if (region == NULL) {
+        return false;
+    }
+    if (region->pkey >= 0) {
+#if HAS_PROTECTION_KEYS
+        uint32_t pkru = open_pkey(region->pkey, true);
+        wipe(region->address, region->size);
+        write_pkru(pkru);
+#endif
+    } else if (mprotect(region->address, region->size, PROT_READ | PROT_WRITE) == 0) {
+        wipe(region->address, region->size);
+    }
+    munmap(region->address, region->size);
+#if HAS_PROTECTION_KEYS
+    // Freed once the pages are gone, as the key may be allocated again at once
+    if (region->pkey >= 0) {
+        syscall(SYS_pkey_free, region->pkey);
+    }
+#endif
+    region->used = false;
+    region->generation = (region->generation + 1) & REGION_GENERATION_MASK;
+    return true;
+}
+
+bool region_set_access(const int *ids, int count, RegionAccess access) {
+    std::lock_guard<std::mutex> lock(regions_mutex);
+    // Regions guarded by page protections whose access changes, by address
+    std::vector<Region *> changed;
+    for (int i = 0; i < count; i++) {
+        if (find_region(ids[i]) == NULL) {
+            return false;
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        Region *region = find_region(ids[i]);
+        if (region->pkey >= 0) {
+            // A key keeps the pages closed between copies whatever their access
+            region->access = access;
+        } else if (region->access != access) {
+            changed.push_back(region);
+        }
+    }
+    std::sort(changed.begin(), changed.end(),
+              [](const Region *a, const Region *b) { return a->address < b->address; });
+
+    // One mprotect per run of adjacent regions
+    bool protected_all = true;
+    size_t start = 0;
+    while (start < changed.size()) {
+        size_t end = start + 1;
+        size_t length = changed[start]->size;
+        while (end < changed.size() && changed[end]->address == changed[start]->address + length) {
+            length += changed[end]->size;
+            end++;
+        }
+        if (mprotect(changed[start]->address, length, page_protection(access)) == 0) {
+            for (size_t i = start; i < end; i++) {
+                changed[i]->access = access;
+            }
+        } else {
+            // The regions keep the access their pages still have
+            LOGW("Failed to change the access of protected regions: %s", strerror(errno));
+            protected_all = false;
+        }
+        start = end;
+    }
+    return protected_all;
+}
+
+bool region_write(int id, size_t offset, const void *data, size_t length) {
+    std::lock_guard<std::mutex> lock(regions_mutex);
+    Region *region = find_region(id);
+    if (region == NULL || region->access != REGION_READ_WRITE || offset > region->size ||
+        length > region->size - offset) {
+        return false;
+    }
+    copy(*region, true, offset, (void *)data, length);
+    return true;
+}
+
+bool region_read(int id, size_t offset, void *data, size_t length) {
+    std::lock_guard<std::mutex> lock(regions_mutex);
+    Region *region = find_region(id);
+    if (region == NULL || region->access == REGION_NO_ACCESS || offset > region->size ||
+        length > region->size - offset) {
+        return false;
+    }
+    copy(*region, false, offset, data, length);
+    return true;
+}
+
+size_t region_size(int id) {
+    std::lock_guard<std::mutex> lock(regions_mutex);
+    Region *region = find_region(id);
+    return region != NULL ? region->size : 0;
+}
+
+bool regions_use_protection_keys() {
+    std::lock_guard<std::mutex> lock(regions_mutex);
+    return protection_keys_supported;
+}
+
+}  // namespace rasp
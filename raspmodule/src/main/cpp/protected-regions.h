@@ -0,0 +1,41 @@
+﻿#pragma once
+
+#include <stddef.h>
+
+// Manager of the page-aligned memory regions holding secrets, and of their access.
+//
+// Each region tracks its access, so that changing it to what it already is costs nothing, and
+// the access of many regions is changed in one call, with one mprotect per run of adjacent pages.
+// Where the CPU and the kernel support memory protection keys, a region gets a key of its own:
+// its pages stay inaccessible to every thread, and region_read and region_write open them to the
+// calling thread for the copy only, by writing the PKRU register instead of calling the kernel.
+
+namespace rasp {
+
+enum RegionAccess : int {
+    REGION_NO_ACCESS = 0,
+    REGION_READ_ONLY = 1,
+    REGION_READ_WRITE = 2
+};
+
+// Id of a new zeroed region of at least size bytes, with no access; -1 if it cannot be mapped
+int region_create(size_t size);
+
+// Zero and unmap a region. Its id is not given to the regions created after it for the next
+// 32767 reuses of its slot, so an id kept after the release fails instead of reaching another region
+bool region_release(int id);
+
+// Set the access of count regions, failing without change if one of them does not exist
+bool region_set_access(const int *ids, int count, RegionAccess access);
+
+// Copy into a region with read-write access, or out of a region with read access
+bool region_write(int id, size_t offset, const void *data, size_t length);
+bool region_read(int id, size_t offset, void *data, size_t length);
+
+// Size of a region rounded up to pages, 0 if it does not exist
+size_t region_size(int id);
+
+// Whether regions created now are guarded by protection keys rather than page protections
+bool regions_use_protection_keys();
+
+}  // namespace rasp
@@ -0,0 +1,65 @@
+﻿package com.example.raspsdk
+
+import java.util.concurrent.TimeUnit
+
+/**
+ * AbsentNames - Remembers the class names a probe found absent, so that they are not probed again
+ * 
+ * The names are forgotten when a module is loaded into the process or the chain of class loaders
+ * changes, and in any case [ttlNanos] after they were found absent: dex loaded into a class loader
+ * already in the chain neither loads a module nor changes the chain.
+ */
+internal class AbsentNames(
+    private val ttlNanos: Long = DEFAULT_TTL_NANOS,
+    private val clock: () -> Long = System::nanoTime
+) {
+    
+    companion object {
+        val DEFAULT_TTL_NANOS = TimeUnit.SECONDS.toNanos(10)
+    }
+    
+    private val lock = Any()
+    // Time each name was found absent at, for the generation and the class loaders below
+    private val absentSince = HashMap<String, Long>()
+    private var generation = -1L
+    private var loaders: List<ClassLoader> = emptyList()
+    
+    /**
+     * The first of [names] present according to [probe], which is given the names not known to be
+     * absent and returns the index of the first one present, or -1 if none is.
+     * 
+     * @param generation generation of the modules loaded into the process, negative if unknown
+     */
+    fun firstPresent(
+        names: Array<String>,
+        generation: Long,
+        loaders: List<ClassLoader>,
+        probe: (List<String>) -> Int
+    ): String? {
+        val candidates = synchronized(lock) {
+            if (generation < 0 || generation != this.generation || loaders != this.loaders) {
+                absentSince.clear()
+                this.generation = generation
+                this.loaders = loaders
+            }
+            val now = clock()
+            names.filter { name ->
+                val since = absentSince[name]
+                since == null || now - since >= ttlNanos
+            }
+        }
+        if (candidates.isEmpty()) return null
+        
+        val index = probe(candidates)
+        synchronized(lock) {
+            // Without a generation, nothing tells when the absent names may appear
+            if (generation >= 0 && generation == this.generation && loaders == this.loaders) {
+                val now = clock()
+                for (name in if (index < 0) candidates else candidates.subList(0, index)) {
+                    absentSince[name] = now
+                }
+            }
+        }
+        return if (index >= 0) candidates[index] else null
+    }
+}
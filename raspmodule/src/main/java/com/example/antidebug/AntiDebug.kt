@@ -1,7 +1,10 @@
 ﻿package com.example.raspsdk
 
 import android.content.Context
+import android.os.Debug
 import kotlinx.coroutines.*
+import java.io.File
+import java.util.concurrent.ConcurrentHashMap
 
 /**
  * RASPSDK - Main entry point for the security SDK
@@ -34,14 +37,43 @@ object RASP {
     private lateinit var responseHandler: ResponseHandler
     private lateinit var dataProtection: DataProtection
     
-    // Native library loading
+    // Statistics exported by the host application, by name
+    private val statsProviders = ConcurrentHashMap<String, () -> Map<String, Any>>()
+    
+    // Facts of the full checks kept for the fast verdicts until the device reboots
+    private const val BOOT_FACTS_FILE = "rasp_boot_facts"
+    private lateinit var bootFactsPath: String
+    
+    // Flags of nativeFastVerdict
+    private const val FAST_DEBUGGER = 0x1
+    private const val FAST_ROOT = 0x2
+    private const val FAST_HOOKS = 0x4
+    private const val FAST_DEADLINE_EXCEEDED = 0x100
+    private const val FAST_ROOT_UNKNOWN = 0x200
+    
+    /** Time the startup verdict of [performStartupCheck] is given by default */
+    const val STARTUP_DEADLINE_NANOS = 5_000_000L
+    
+    @JvmStatic
+    private external fun nativeFastVerdict(bootFactsPath: String, budgetNanos: Long): Int
+    
+    @JvmStatic
+    private external fun nativeStoreBootFacts(bootFactsPath: String, facts: Int): Boolean
+    
+    /** Cost classes of the native detectors run by [runNativeDetectors] */
+    const val DETECTOR_COST_CHEAP = 0
+    const val DETECTOR_COST_MODERATE = 1
+    const val DETECTOR_COST_EXPENSIVE = 2
+    
+    @JvmStatic
+    private external fun nativeRunDetectors(maxCost: Int): Array<String>?
+    
+    @JvmStatic
+    private external fun nativeDetectorGraph(): String?
+    
+    // Native library loading, or waiting for its preload
     init {
-        try {
-            System.loadLibrary("rasp-native")
-        } catch (e: UnsatisfiedLinkError) {
-            // Log error but continue - some features will be limited
-            android.util.Log.e("RASP", "Failed to load native library: ${e.message}")
-        }
+        NativeLoader.awaitLoaded()
     }
     
     /**
@@ -77,6 +109,7 @@ object RASP {
         )
         val allFingerprints = debugFingerprints + releaseFingerprints
         TamperDetection.initializeFingerprints(allFingerprints)
+        bootFactsPath = File(this.context.noBackupFilesDir, BOOT_FACTS_FILE).path
         
         initialized = true
         
@@ -172,6 +205,63 @@ object RASP {
         )
     }
     
+    /**
+     * Perform the startup security check: a preliminary verdict from the cheapest high-signal
+     * checks, returned within [deadlineNanos], and the full report, computed in background
+     * 
+     * The preliminary verdict reads TracerPid, the debugger signals received, the loaded
+     * modules and the root verdict of the last full check since the device booted. The full
+     * report is delivered to [listener] from a background thread.
+     * 
+     * @param listener Receives the full report
+     * @param deadlineNanos Time the checks of the preliminary verdict may take
+     * @return Preliminary verdict
+     */
+    @JvmStatic
+    @JvmOverloads
+    fun performStartupCheck(listener: SecurityReportListener, deadlineNanos: Long = STARTUP_DEADLINE_NANOS): StartupVerdict {
+        ensureInitialized()
+        val verdict = fastVerdict(deadlineNanos)
+        
+        scope.launch {
+            val report = try {
+                performSecurityCheck()
+            } catch (e: Exception) {
+                android.util.Log.e("RASP", "Full security check failed", e)
+                listener.onSecurityCheckFailed(e)
+                return@launch
+            }
+            storeBootFacts(report)
+            listener.onSecurityReport(report)
+        }
+        return verdict
+    }
+    
+    private fun fastVerdict(deadlineNanos: Long): StartupVerdict {
+        val start = System.nanoTime()
+        val flags = try {
+            nativeFastVerdict(bootFactsPath, deadlineNanos)
+        } catch (e: UnsatisfiedLinkError) {
+            // Without the native library, nothing but the debugger API is cheap enough
+            FAST_ROOT_UNKNOWN or FAST_DEADLINE_EXCEEDED
+        }
+        return StartupVerdict(
+            debuggerDetected = flags and FAST_DEBUGGER != 0 || Debug.isDebuggerConnected(),
+            rootDetected = if (flags and FAST_ROOT_UNKNOWN != 0) null else flags and FAST_ROOT != 0,
+            hooksDetected = flags and FAST_HOOKS != 0,
+            isComplete = flags and FAST_DEADLINE_EXCEEDED == 0,
+            elapsedNanos = System.nanoTime() - start
+        )
+    }
+    
+    private fun storeBootFacts(report: SecurityReport) {
+        try {
+            nativeStoreBootFacts(bootFactsPath, if (report.rootDetected) FAST_ROOT else 0)
+        } catch (e: UnsatisfiedLinkError) {
+            // The fast verdicts cannot read them either
+        }
+    }
+    
     /**
      * Get data protection instance for secure storage
      * 
@@ -205,6 +295,75 @@ object RASP {
         responseHandler.handleThreat(threatType)
     }
     
+    /**
+     * Run the native detectors of at most a cost class, reading each snapshot of the process
+     * they share (memory maps, status, sockets, processes, properties) once for all of them
+     * 
+     * Blocking: call it off the main thread.
+     * 
+     * @param maxCost Most expensive [DETECTOR_COST_CHEAP] to [DETECTOR_COST_EXPENSIVE] class to run
+     * @return Names of the detectors that found a threat
+     */
+    @JvmStatic
+    @JvmOverloads
+    fun runNativeDetectors(maxCost: Int = DETECTOR_COST_MODERATE): List<String> {
+        return nativeRunDetectors(maxCost)?.toList() ?: emptyList()
+    }
+    
+    /**
+     * Get the graph of the native detectors and the snapshots they read, for tracing
+     * 
+     * @return DOT graph, with the timings of the last [runNativeDetectors] call
+     */
+    @JvmStatic
+    fun getNativeDetectorGraph(): String {
+        return nativeDetectorGraph() ?: ""
+    }
+    
+    /**
+     * Register statistics to export with the SDK ones, replacing any provider with the same name
+     * 
+     * Providers may be registered before [init]. They are called on every [getStats] call, from
+     * the calling thread, and must be cheap and thread-safe.
+     * 
+     * @param name Key of the statistics in [getStats]
+     * @param provider Returns the current statistics
+     */
+    @JvmStatic
+    fun registerStatsProvider(name: String, provider: () -> Map<String, Any>) {
+        statsProviders[name] = provider
+    }
+    
+    /**
+     * Remove statistics registered with [registerStatsProvider]
+     * 
+     * @param name Name the provider was registered with
+     */
+    @JvmStatic
+    fun unregisterStatsProvider(name: String) {
+        statsProviders.remove(name)
+    }
+    
+    /**
+     * Get the SDK state and the statistics of every registered provider
+     * 
+     * @return Statistics by name; a failing provider is reported by its error
+     */
+    @JvmStatic
+    fun getStats(): Map<String, Any> {
+        val stats = LinkedHashMap<String, Any>()
+        stats["initialized"] = initialized
+        stats["native"] = NativeLoader.getStats()
+        for ((name, provider) in statsProviders.entries.sortedBy { it.key }) {
+            stats[name] = try {
+                provider()
+            } catch (e: Exception) {
+                mapOf("error" to (e.message ?: e.javaClass.simpleName))
+            }
+        }
+        return stats
+    }
+    
     /**
      * Start continuous monitoring in background
      */
@@ -288,6 +447,34 @@ data class SecurityReport(
     }
 }
 
+/**
+ * Preliminary verdict of the startup check, from the cheapest checks only
+ * 
+ * @property rootDetected Root verdict of the last full check since the device booted, null if
+ * there was none
+ * @property isComplete Whether all the checks ran before the deadline
+ */
+data class StartupVerdict(
+    val debuggerDetected: Boolean,
+    val rootDetected: Boolean?,
+    val hooksDetected: Boolean,
+    val isComplete: Boolean,
+    val elapsedNanos: Long
+) {
+    fun hasThreats(): Boolean {
+        return debuggerDetected || rootDetected == true || hooksDetected
+    }
+}
+
+/**
+ * Receives the full report of [RASP.performStartupCheck], from a background thread
+ */
+interface SecurityReportListener {
+    fun onSecurityReport(report: SecurityReport)
+    
+    fun onSecurityCheckFailed(error: Exception) {}
+}
+
 /**
  * Types of security threats that can be detected
  */
@@ -30,6 +30,8 @@ class BehavioralDetection(private val context: Context) {
         
         // Process monitoring intervals
         private const val MONITORING_INTERVAL = 5000L // 5 seconds
+        // Longest time between two continuous checks, over which a CPU anomaly is still reported
+        private const val CPU_ANOMALY_WINDOW_MILLIS = 15000L
         
         // Suspicious ports to check
         private val SUSPICIOUS_PORTS = arrayOf(
@@ -46,6 +48,11 @@ class BehavioralDetection(private val context: Context) {
     private val processCheckCount = AtomicLong(0)
     private var lastProcessCheck = 0L
     
+    init {
+        // The rates need a baseline of samples before the first check
+        CpuSampler.start()
+    }
+    
     /**
      * Main method to check for suspicious behavioral patterns
      */
@@ -294,32 +301,17 @@ class BehavioralDetection(private val context: Context) {
     }
     
     /**
-     * Monitor CPU usage patterns
+     * Monitor CPU usage patterns: rates of CPU time, page faults and context switches that
+     * spike above their rolling baseline since the previous checks
      */
     private fun monitorCpuUsage(): Boolean {
-        return try {
-            val statFile = File("/proc/self/stat")
-            if (!statFile.exists()) return false
-            
-            val statContent = statFile.readText().split(" ")
-            
-            if (statContent.size > 15) {
-                val utime = statContent[13].toLongOrNull() ?: 0
-                val stime = statContent[14].toLongOrNull() ?: 0
-                val totalTime = utime + stime
-                
-                // Check for unusually high CPU usage (indicating debugging/analysis)
-                if (totalTime > 1000) { // Arbitrary threshold
-                    Log.d(TAG, "High CPU usage detected - utime: $utime, stime: $stime")
-                    return true
-                }
-            }
-            
-            false
-        } catch (e: Exception) {
-            Log.w(TAG, "CPU usage monitoring failed: ${e.message}")
-            false
+        val rates = CpuSampler.readRates(CPU_ANOMALY_WINDOW_MILLIS) ?: return false
+        if (rates.anomalies != 0) {
+            Log.d(TAG, "CPU usage anomaly - cpu: ${rates.cpuPercent}%, minor faults/s: ${rates.minorFaultsPerSecond}, " +
+                "major faults/s: ${rates.majorFaultsPerSecond}, context switches/s: ${rates.contextSwitchesPerSecond}")
+            return true
         }
+        return false
     }
     
     /**
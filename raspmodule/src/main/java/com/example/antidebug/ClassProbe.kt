@@ -0,0 +1,50 @@
+﻿package com.example.raspsdk
+
+/**
+ * ClassProbe - Checks whether classes are present without a ClassNotFoundException per miss
+ * 
+ * A whole list of names is probed in one native call, among the classes loaded by each class
+ * loader of a chain, then with FindClass, whose pending exception is cleared at once. The names
+ * found absent are remembered by [AbsentNames], so that the next checks only probe the names not
+ * known to be absent.
+ */
+internal object ClassProbe {
+    
+    private val absent = AbsentNames()
+    
+    @JvmStatic
+    private external fun nativeModuleGeneration(): Long
+    
+    @JvmStatic
+    private external fun nativeProbeClasses(names: Array<String>, loaders: Array<ClassLoader>): Int
+    
+    /**
+     * The first of [names] present in [loader] or its parents, null if none is
+     */
+    fun firstPresent(names: Array<String>, loader: ClassLoader?): String? {
+        val loaders = generateSequence(loader) { it.parent }.toList()
+        if (!NativeLoader.awaitLoaded()) return firstPresentByName(names, loader)
+        
+        val generation = try {
+            nativeModuleGeneration()
+        } catch (e: UnsatisfiedLinkError) {
+            return firstPresentByName(names, loader)
+        }
+        return absent.firstPresent(names, generation, loaders) { candidates ->
+            nativeProbeClasses(candidates.toTypedArray(), loaders.toTypedArray())
+        }
+    }
+    
+    // One Class.forName per name, when the native probe is unavailable
+    private fun firstPresentByName(names: Array<String>, loader: ClassLoader?): String? {
+        for (name in names) {
+            try {
+                Class.forName(name, false, loader)
+                return name
+            } catch (e: ClassNotFoundException) {
+                // Class not found, continue
+            }
+        }
+        return null
+    }
+}
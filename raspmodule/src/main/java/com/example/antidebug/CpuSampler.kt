@@ -0,0 +1,80 @@
+﻿package com.example.raspsdk
+
+/**
+ * CpuSampler - Rates of CPU time, page faults and context switches against a rolling baseline
+ * 
+ * The sampling runs in native code on a background thread, with one pread of /proc/self/stat and
+ * one of /proc/self/schedstat per interval into a fixed ring. A rate is anomalous when it rises
+ * well above the mean and deviation of the rates before it in the ring, several intervals in a
+ * row, so that the usual load of a long session and the short bursts of its work are not flagged,
+ * while the sustained load of an injected agent or of single-stepping is.
+ */
+internal object CpuSampler {
+    
+    const val DEFAULT_INTERVAL_MILLIS = 1_000L
+    
+    /** Flags of [Rates.anomalies], one per rate */
+    const val ANOMALY_CPU = 0x1
+    const val ANOMALY_MINOR_FAULTS = 0x2
+    const val ANOMALY_MAJOR_FAULTS = 0x4
+    const val ANOMALY_CONTEXT_SWITCHES = 0x8
+    
+    data class Rates(
+        val cpuPercent: Double,
+        val minorFaultsPerSecond: Double,
+        val majorFaultsPerSecond: Double,
+        // Of the main thread, which is the one schedstat reports
+        val contextSwitchesPerSecond: Double,
+        // ANOMALY_* flags of the rates found anomalous over the window read
+        val anomalies: Int,
+        // Rates in the ring, the baseline included
+        val count: Int
+    )
+    
+    @JvmStatic
+    private external fun nativeStart(intervalNanos: Long): Boolean
+    
+    @JvmStatic
+    private external fun nativeStop()
+    
+    @JvmStatic
+    private external fun nativeReadRates(windowNanos: Long): DoubleArray?
+    
+    /**
+     * Start sampling every [intervalMillis], if not started already
+     * 
+     * @return false if the sampler is unavailable
+     */
+    fun start(intervalMillis: Long = DEFAULT_INTERVAL_MILLIS): Boolean {
+        if (!NativeLoader.awaitLoaded()) return false
+        return try {
+            nativeStart(intervalMillis * 1_000_000)
+        } catch (e: UnsatisfiedLinkError) {
+            false
+        }
+    }
+    
+    fun stop() {
+        if (!NativeLoader.awaitLoaded()) return
+        try {
+            nativeStop()
+        } catch (e: UnsatisfiedLinkError) {
+            // Nothing was started either
+        }
+    }
+    
+    /**
+     * The latest rates, with the anomalies found over the last [windowMillis]
+     * 
+     * @return null before two samples are taken, or if the sampler is unavailable
+     */
+    fun readRates(windowMillis: Long): Rates? {
+        if (!NativeLoader.awaitLoaded()) return null
+        val values = try {
+            nativeReadRates(windowMillis * 1_000_000)
+        } catch (e: UnsatisfiedLinkError) {
+            null
+        } ?: return null
+        return Rates(values[0], values[1], values[2], values[3], values[4].toInt(), values[5].toInt())
+    }
+}
@@ -154,27 +154,18 @@ class HookDetection(private val context: Context) {
      */
     private fun checkXposedFramework(): Boolean {
         return try {
-            // Check for Xposed classes in runtime
-            for (className in XPOSED_CLASSES) {
-                try {
-                    Class.forName(className)
-                    Log.d(TAG, "Xposed class detected: $className")
-                    return true
-                } catch (e: ClassNotFoundException) {
-                    // Class not found, continue
-                }
+            // Check for Xposed classes in runtime, all in one probe
+            val xposedClass = ClassProbe.firstPresent(XPOSED_CLASSES, HookDetection::class.java.classLoader)
+            if (xposedClass != null) {
+                Log.d(TAG, "Xposed class detected: $xposedClass")
+                return true
             }
             
             // Check for Xposed packages
-            val packageManager = context.packageManager
-            for (packageName in XPOSED_PACKAGES) {
-                try {
-                    packageManager.getPackageInfo(packageName, 0)
-                    Log.d(TAG, "Xposed package detected: $packageName")
-                    return true
-                } catch (e: Exception) {
-                    // Package not found, continue
-                }
+            val xposedPackage = PackageIndex.get(context).firstInstalled(XPOSED_PACKAGES)
+            if (xposedPackage != null) {
+                Log.d(TAG, "Xposed package detected: $xposedPackage")
+                return true
             }
             
             // Check for Xposed environment variables
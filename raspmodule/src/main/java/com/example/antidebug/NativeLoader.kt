@@ -0,0 +1,101 @@
+﻿package com.example.raspsdk
+
+import android.util.Log
+import java.util.concurrent.CountDownLatch
+import java.util.concurrent.atomic.AtomicBoolean
+
+/**
+ * NativeLoader - Loads the rasp-native library once for the whole SDK
+ * 
+ * Loading the library maps and relocates it and runs its static initializers. Called from
+ * [android.app.Application.attachBaseContext], [preload] does it on a background thread while the
+ * application starts, then warms the native caches the first checks read. The SDK classes using
+ * native methods call [awaitLoaded] first: it returns at once when the preload is done, waits for
+ * it while it runs, and loads the library on the calling thread when nothing preloaded it.
+ */
+object NativeLoader {
+    
+    private const val TAG = "NativeLoader"
+    private const val LIBRARY = "rasp-native"
+    
+    private val started = AtomicBoolean(false)
+    private val done = CountDownLatch(1)
+    
+    @Volatile
+    private var available = false
+    @Volatile
+    private var loadNanos = 0L
+    @Volatile
+    private var warmUpNanos = 0L
+    @Volatile
+    private var preloaded = false
+    
+    @JvmStatic
+    private external fun nativeWarmUp()
+    
+    /**
+     * Start loading the library on a background thread, if it is not loaded or loading already
+     */
+    @JvmStatic
+    fun preload() {
+        if (!started.compareAndSet(false, true)) return
+        preloaded = true
+        Thread({ load(warmUp = true) }, "rasp-preload").apply {
+            isDaemon = true
+            start()
+        }
+    }
+    
+    /**
+     * Wait until the library is loaded, loading it on the calling thread if nothing did
+     * 
+     * @return true if the library is available
+     */
+    @JvmStatic
+    fun awaitLoaded(): Boolean {
+        if (started.compareAndSet(false, true)) {
+            load(warmUp = false)
+        } else {
+            done.await()
+        }
+        return available
+    }
+    
+    /**
+     * Load times, for [RASP.getStats]
+     */
+    @JvmStatic
+    fun getStats(): Map<String, Any> {
+        return mapOf(
+            "available" to available,
+            "preloaded" to preloaded,
+            "load_us" to loadNanos / 1000,
+            "warm_up_us" to warmUpNanos / 1000
+        )
+    }
+    
+    private fun load(warmUp: Boolean) {
+        val start = System.nanoTime()
+        try {
+            System.loadLibrary(LIBRARY)
+            available = true
+        } catch (e: UnsatisfiedLinkError) {
+            // Log error but continue - some features will be limited
+            Log.e(TAG, "Failed to load native library: ${e.message}")
+        } finally {
+            loadNanos = System.nanoTime() - start
+            // Callers waiting for the library do not wait for the warm-up
+            done.countDown()
+        }
+        
+        if (available && warmUp) {
+            val warmUpStart = System.nanoTime()
+            try {
+                nativeWarmUp()
+            } catch (e: UnsatisfiedLinkError) {
+                Log.w(TAG, "Native warm-up unavailable: ${e.message}")
+            }
+            warmUpNanos = System.nanoTime() - warmUpStart
+        }
+    }
+}
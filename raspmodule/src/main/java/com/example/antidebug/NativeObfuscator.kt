@@ -33,14 +33,10 @@ object ReflectionIndirection {
 class NativeObfuscator {
     
     companion object {
-        // Load native library with obfuscated control flow
+        // Load native library with obfuscated control flow, or wait for its preload
         init {
             ControlFlowObfuscator.executeWithObfuscation {
-                try {
-                    System.loadLibrary("rasp-native")
-                } catch (e: UnsatisfiedLinkError) {
-                    // Fail silently to avoid revealing library structure
-                }
+                NativeLoader.awaitLoaded()
             }
         }
         
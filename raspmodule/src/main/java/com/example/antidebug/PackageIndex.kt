@@ -0,0 +1,91 @@
+﻿package com.example.raspsdk
+
+import android.content.BroadcastReceiver
+import android.content.Context
+import android.content.Intent
+import android.content.IntentFilter
+import android.util.Log
+import androidx.core.content.ContextCompat
+
+/**
+ * PackageIndex - Names of the packages visible to the application, for indicator lookups
+ * 
+ * The visible packages are listed by a single query to the package manager, instead of one
+ * getPackageInfo call, and one exception on each miss, per indicator package. The names are kept
+ * in a hash set until a package is added or removed, which starts a new epoch: the next lookup
+ * queries the package manager again.
+ */
+internal class PackageIndex private constructor(private val context: Context) {
+    
+    companion object {
+        private const val TAG = "PackageIndex"
+        
+        @Volatile
+        private var instance: PackageIndex? = null
+        
+        @JvmStatic
+        fun get(context: Context): PackageIndex {
+            instance?.let { return it }
+            synchronized(this) {
+                return instance ?: PackageIndex(context.applicationContext).also {
+                    it.registerReceiver()
+                    instance = it
+                }
+            }
+        }
+    }
+    
+    private val lock = Any()
+    // Incremented by every package change
+    private var epoch = 0L
+    // Packages of the current epoch, null until they are queried
+    private var packages: Set<String>? = null
+    
+    private val receiver = object : BroadcastReceiver() {
+        override fun onReceive(context: Context, intent: Intent) {
+            synchronized(lock) {
+                epoch++
+                packages = null
+            }
+        }
+    }
+    
+    /**
+     * The first of [indicators] that is installed and visible, null if none is
+     */
+    fun firstInstalled(indicators: Array<String>): String? {
+        val installed = packages()
+        return indicators.firstOrNull { it in installed }
+    }
+    
+    private fun packages(): Set<String> {
+        val queriedEpoch = synchronized(lock) {
+            packages?.let { return it }
+            epoch
+        }
+        val installed = try {
+            @Suppress("DEPRECATION")
+            context.packageManager.getInstalledPackages(0).mapTo(HashSet()) { it.packageName }
+        } catch (e: Exception) {
+            // Too many packages for a single transaction, or the package manager died
+            Log.w(TAG, "Failed to list the installed packages: ${e.message}")
+            return emptySet()
+        }
+        synchronized(lock) {
+            // A package changed while it was being queried: the next lookup queries again
+            if (epoch == queriedEpoch) packages = installed
+        }
+        return installed
+    }
+    
+    private fun registerReceiver() {
+        val filter = IntentFilter().apply {
+            addAction(Intent.ACTION_PACKAGE_ADDED)
+            addAction(Intent.ACTION_PACKAGE_REMOVED)
+            addAction(Intent.ACTION_PACKAGE_REPLACED)
+            addDataScheme("package")
+        }
+        // Package broadcasts come from the system, which a receiver that is not exported still receives
+        ContextCompat.registerReceiver(context, receiver, filter, ContextCompat.RECEIVER_NOT_EXPORTED)
+    }
+}
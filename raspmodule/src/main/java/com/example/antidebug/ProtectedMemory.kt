@@ -0,0 +1,111 @@
+﻿package com.example.raspsdk
+
+/**
+ * ProtectedMemory - Native memory regions for secrets, outside the Java heap
+ * 
+ * Each region is made of whole pages mapped for it alone and kept out of core dumps, and is
+ * zeroed when released. Its access is tracked: [setAccess] changes many regions at once, skipping
+ * those already in the access asked for and merging adjacent pages into one system call.
+ * 
+ * Where the device supports memory protection keys, each region gets a key of its own. Its
+ * pages then stay inaccessible to every thread whatever the access of the region, and [read] and
+ * [write] open them to the calling thread for the copy only, in nanoseconds rather than system
+ * calls. Elsewhere the access is that of the pages, changed with mprotect.
+ */
+object ProtectedMemory {
+    
+    enum class Access {
+        NO_ACCESS,
+        READ_ONLY,
+        READ_WRITE
+    }
+    
+    class Region internal constructor(internal val id: Int, val size: Int)
+    
+    @JvmStatic
+    private external fun nativeCreate(size: Int): Int
+    
+    @JvmStatic
+    private external fun nativeRelease(id: Int): Boolean
+    
+    @JvmStatic
+    private external fun nativeSetAccess(ids: IntArray, access: Int): Boolean
+    
+    @JvmStatic
+    private external fun nativeWrite(id: Int, offset: Int, data: ByteArray): Boolean
+    
+    @JvmStatic
+    private external fun nativeRead(id: Int, offset: Int, length: Int): ByteArray?
+    
+    @JvmStatic
+    private external fun nativeUsesProtectionKeys(): Boolean
+    
+    // Native library loading, or waiting for its preload
+    init {
+        NativeLoader.awaitLoaded()
+    }
+    
+    /**
+     * Allocate a zeroed region of at least [size] bytes, with no access
+     * 
+     * @return null if the region cannot be mapped
+     */
+    @JvmStatic
+    fun allocate(size: Int): Region? {
+        val id = nativeCreate(size)
+        return if (id >= 0) Region(id, size) else null
+    }
+    
+    /**
+     * Zero and unmap a region, after which every operation on it fails
+     */
+    @JvmStatic
+    fun release(region: Region): Boolean {
+        return nativeRelease(region.id)
+    }
+    
+    /**
+     * Set the access of several regions in one batch
+     * 
+     * @return false if a region was released or an access could not be changed
+     */
+    @JvmStatic
+    fun setAccess(regions: List<Region>, access: Access): Boolean {
+        return nativeSetAccess(IntArray(regions.size) { regions[it].id }, access.ordinal)
+    }
+    
+    @JvmStatic
+    fun setAccess(region: Region, access: Access): Boolean {
+        return nativeSetAccess(intArrayOf(region.id), access.ordinal)
+    }
+    
+    /**
+     * Copy [data] into a region with [Access.READ_WRITE] access, at [offset]
+     * 
+     * @return false if the region has another access or [data] does not fit
+     */
+    @JvmStatic
+    @JvmOverloads
+    fun write(region: Region, data: ByteArray, offset: Int = 0): Boolean {
+        return nativeWrite(region.id, offset, data)
+    }
+    
+    /**
+     * Copy [length] bytes out of a region with [Access.READ_ONLY] or [Access.READ_WRITE] access
+     * 
+     * @return null if the region has no access or the bytes are out of it
+     */
+    @JvmStatic
+    @JvmOverloads
+    fun read(region: Region, length: Int = region.size, offset: Int = 0): ByteArray? {
+        return nativeRead(region.id, offset, length)
+    }
+    
+    /**
+     * Whether the regions allocated now are guarded by memory protection keys
+     */
+    @JvmStatic
+    fun usesProtectionKeys(): Boolean {
+        return nativeUsesProtectionKeys()
+    }
+}
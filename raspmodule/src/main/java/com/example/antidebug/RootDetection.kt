@@ -1,7 +1,6 @@
 ﻿package com.example.raspsdk
 
 import android.content.Context
-import android.content.pm.PackageManager
 import android.os.Build
 import android.util.Log
 import java.io.BufferedReader
@@ -127,20 +126,9 @@ class RootDetection(private val context: Context) {
      * Check for installed root management packages
      */
     private fun checkRootPackages(): Boolean {
-        val packageManager = context.packageManager
-        
-        for (packageName in ROOT_PACKAGES) {
-            try {
-                packageManager.getPackageInfo(packageName, 0)
-                Log.d(TAG, "Root package found: $packageName")
-                return true
-            } catch (e: PackageManager.NameNotFoundException) {
-                // Package not found, continue
-            } catch (e: Exception) {
-                Log.w(TAG, "Error checking package: $packageName", e)
-            }
-        }
-        return false
+        val packageName = PackageIndex.get(context).firstInstalled(ROOT_PACKAGES) ?: return false
+        Log.d(TAG, "Root package found: $packageName")
+        return true
     }
     
     /**
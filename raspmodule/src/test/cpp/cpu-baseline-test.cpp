@@ -0,0 +1,67 @@
+﻿#include "cpu-baseline.h"
+
+#include <stdio.h>
+
+using namespace rasp;
+
+static int failures = 0;
+
+#define CHECK(condition)                                                  \
+    do {                                                                  \
+        if (!(condition)) {                                               \
+            fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            failures++;                                                   \
+        }                                                                 \
+    } while (0)
+
+// Add count rates of an idle or busy process, returning the anomalies of each one
+static uint32_t add_rates(RateRing &ring, int count, double cpu_percent, double minor_faults) {
+    uint32_t anomalies = 0;
+    for (int i = 0; i < count; i++) {
+        Rate rate = {};
+        rate.values[METRIC_CPU_PERCENT] = cpu_percent;
+        rate.values[METRIC_MINOR_FAULTS] = minor_faults;
+        rate.values[METRIC_MAJOR_FAULTS] = 0;
+        rate.values[METRIC_CONTEXT_SWITCHES] = 10;
+        add_rate(ring, rate);
+        anomalies |= rate.anomalies;
+    }
+    return anomalies;
+}
+
+static void given_an_idle_process_when_a_burst_of_work_ends_early_then_nothing_is_anomalous() {
+    RateRing ring = {};
+    CHECK(add_rates(ring, 20, 1.0, 50) == 0);
+
+    // A parallel recomputation on every core, then a screen opening
+    CHECK(add_rates(ring, ANOMALY_SUSTAINED_RATES - 1, 700.0, 8000) == 0);
+    CHECK(add_rates(ring, 5, 1.0, 50) == 0);
+    CHECK(add_rates(ring, 2, 40.0, 900) == 0);
+}
+
+static void given_an_idle_process_when_a_moderate_load_lasts_then_it_is_not_anomalous() {
+    RateRing ring = {};
+    add_rates(ring, 20, 1.0, 50);
+
+    CHECK(add_rates(ring, 30, 150.0, 2000) == 0);
+}
+
+static void given_an_idle_process_when_a_spike_lasts_then_it_is_anomalous_once_sustained() {
+    RateRing ring = {};
+    add_rates(ring, 20, 1.0, 50);
+
+    CHECK(add_rates(ring, ANOMALY_SUSTAINED_RATES - 1, 400.0, 20000) == 0);
+    uint32_t anomalies = add_rates(ring, 1, 400.0, 20000);
+
+    CHECK(anomalies == (METRIC_BIT(METRIC_CPU_PERCENT) | METRIC_BIT(METRIC_MINOR_FAULTS)));
+}
+
+int main() {
+    given_an_idle_process_when_a_burst_of_work_ends_early_then_nothing_is_anomalous();
+    given_an_idle_process_when_a_moderate_load_lasts_then_it_is_not_anomalous();
+    given_an_idle_process_when_a_spike_lasts_then_it_is_anomalous_once_sustained();
+    if (failures == 0) {
+        printf("cpu-baseline-test passed\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,55 @@
+﻿package com.example.raspsdk
+
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertNull
+import org.junit.Test
+
+class AbsentNamesTest {
+    
+    private val names = arrayOf("de.robv.android.xposed.XposedBridge", "org.lsposed.lspd.core.Main")
+    private val loaders = listOf(AbsentNamesTest::class.java.classLoader!!)
+    
+    @Test
+    fun `given classes injected into a loader already probed when the ttl expires then they are detected`() {
+        // Given
+        var now = 0L
+        val absent = AbsentNames(ttlNanos = 1_000, clock = { now })
+        val present = HashSet<String>()
+        val probed = ArrayList<List<String>>()
+        val probe = { candidates: List<String> ->
+            probed.add(candidates)
+            candidates.indexOfFirst { it in present }
+        }
+        assertNull(absent.firstPresent(names, 1, loaders, probe))
+        
+        // When
+        present.add(names[1])
+        now = 500
+        val beforeExpiry = absent.firstPresent(names, 1, loaders, probe)
+        now = 1_000
+        val afterExpiry = absent.firstPresent(names, 1, loaders, probe)
+        
+        // Then
+        assertNull(beforeExpiry)
+        assertEquals(names[1], afterExpiry)
+        assertEquals(listOf(names.toList(), names.toList()), probed)
+    }
+    
+    @Test
+    fun `given a new module generation when probing then the absent names are probed again`() {
+        // Given
+        val absent = AbsentNames(clock = { 0L })
+        val present = HashSet<String>()
+        val probe = { candidates: List<String> -> candidates.indexOfFirst { it in present } }
+        assertNull(absent.firstPresent(names, 1, loaders, probe))
+        
+        // When
+        present.add(names[0])
+        val sameGeneration = absent.firstPresent(names, 1, loaders, probe)
+        val nextGeneration = absent.firstPresent(names, 2, loaders, probe)
+        
+        // Then
+        assertNull(sameGeneration)
+        assertEquals(names[0], nextGeneration)
+    }
+}